@@ -203,7 +203,13 @@ class uLCD_4DGL : public Stream
 
 public :
 
-    uLCD_4DGL(PinName tx, PinName rx, PinName rst);
+    /** Create the display driver
+    * @param tx, rx Serial pins
+    * @param rst Reset pin
+    * @param blockingReset true: reset and wait for the screen to boot (3 s) before returning;
+    *                      false: only start the reset, then poll resetDone() before drawing
+    */
+    uLCD_4DGL(PinName tx, PinName rx, PinName rst, bool blockingReset = true);
 
 // General Commands *******************************************************************************
 
@@ -213,6 +219,16 @@ public :
     /** Reset screen */
     void reset();
 
+    /** Start a screen reset without waiting for the screen to boot */
+    void startReset();
+
+    /** Check whether a reset started by startReset() has completed
+    * On the first call after the boot time has elapsed the screen is cleared
+    * and the default font is set; no other command may be sent before that.
+    * @return true once the screen accepts commands
+    */
+    bool resetDone();
+
 
     /** Set serial Baud rate (both sides : screen and mbed)
     * @param Speed Correct BAUD value (see uLCD_4DGL.h)
@@ -314,6 +330,8 @@ protected :
 
     mbed::BufferedSerial _cmd;
     DigitalOut _rst;
+    Timer _resetTimer;          // Time since startReset()
+    bool _resetPending;         // startReset() called, resetDone() not yet true
     //used by printf
     virtual int _putc(int c) {
         putc(c);
@@ -26,8 +26,8 @@
 
 
 //******************************************************************************************************
-uLCD_4DGL :: uLCD_4DGL(PinName tx, PinName rx, PinName rst) : _cmd(tx, rx),
-    _rst(rst)
+uLCD_4DGL :: uLCD_4DGL(PinName tx, PinName rx, PinName rst, bool blockingReset) : _cmd(tx, rx),
+    _rst(rst), _resetPending(false)
 #if DEBUGMODE
     ,pc(USBTX, USBRX)
 #endif // DEBUGMODE
@@ -44,15 +44,19 @@ uLCD_4DGL :: uLCD_4DGL(PinName tx, PinName rx, PinName rst) : _cmd(tx, rx),
 #endif
 
     _rst = 1;    // put RESET pin to high to start TFT screen
-    reset();
-    cls();       // clear screen
     current_col         = 0;            // initial cursor col
     current_row         = 0;            // initial cursor row
     current_color       = WHITE;        // initial text color
     current_orientation = IS_PORTRAIT;  // initial screen orientation
     current_hf = 1;
     current_wf = 1;
-    set_font(FONT_7X8);                 // initial font
+    if (blockingReset) {
+        reset();
+        cls();       // clear screen
+        set_font(FONT_7X8);             // initial font
+    } else {
+        startReset();                   // caller polls resetDone()
+    }
 //   text_mode(OPAQUE);                  // initial texr mode
 }
 
@@ -136,6 +140,31 @@ void uLCD_4DGL :: reset()    // Reset Screen
 
     freeBUFFER();           // clean buffer from possible garbage
 }
+
+//**************************************************************************
+void uLCD_4DGL :: startReset()    // Reset Screen, return while it boots
+{
+    _rst = 0;               // put RESET pin to low
+    wait_us(5000);         // wait a few milliseconds for command reception
+    _rst = 1;               // put RESET back to high
+    _resetTimer.reset();
+    _resetTimer.start();
+    _resetPending = true;
+}
+
+//**************************************************************************
+bool uLCD_4DGL :: resetDone()    // Finish a startReset() once the screen has booted
+{
+    if (!_resetPending) return true;
+    if (_resetTimer.elapsed_time() < std::chrono::seconds(3)) return false;   // same boot time as reset()
+
+    _resetTimer.stop();
+    _resetPending = false;
+    freeBUFFER();           // clean buffer from possible garbage
+    cls();                  // clear screen
+    set_font(FONT_7X8);     // initial font
+    return true;
+}
 //******************************************************************************************************
 int uLCD_4DGL :: writeCOMMANDnull(char *command, int number)   // send several BYTES making a command and return an answer
 {
@@ -0,0 +1,91 @@
+#include "Annunciator.h"
+
+// Constructor - buzzer silent, LED off
+Annunciator::Annunciator(PinName buzzerPin, PinName redPin, PinName greenPin, PinName bluePin, TimerWheel& timers) :
+    _buzzer(buzzerPin),
+    _red(redPin),
+    _green(greenPin),
+    _blue(bluePin),
+    _timers(timers),
+    _steps(nullptr),
+    _count(0),
+    _index(0),
+    _repeat(false),
+    _baseRed(0.0f),
+    _baseGreen(0.0f),
+    _baseBlue(0.0f)
+{
+    memset(&_single, 0, sizeof(_single));
+    restoreBase();
+}
+
+// Set the resting LED color
+void Annunciator::setColor(float red, float green, float blue) {
+    _baseRed = red;
+    _baseGreen = green;
+    _baseBlue = blue;
+    if(!busy()) restoreBase();
+}
+
+// Play one tone
+void Annunciator::beep(float frequency, uint32_t durationMs) {
+    _single.frequency = (uint16_t)frequency;
+    _single.durationMs = (uint16_t)durationMs;
+    _single.red = _single.green = _single.blue = LED_KEEP;
+    play(&_single, 1);
+}
+
+// Start a pattern
+void Annunciator::play(const ToneStep* steps, int count, bool repeat) {
+    if(count <= 0) return;
+    _steps = steps;
+    _count = count;
+    _index = 0;
+    _repeat = repeat;
+    startStep();
+}
+
+// Stop playing
+void Annunciator::stop() {
+    _timers.cancel(_stepTimer);
+    _steps = nullptr;
+    restoreBase();
+}
+
+// Apply the current step's tone and LED levels
+void Annunciator::startStep() {
+    const ToneStep& step = _steps[_index];
+
+    if(step.frequency) {
+        _buzzer.period(1.0f / step.frequency);  // Set tone frequency
+        _buzzer = 0.5f;                         // 50% duty cycle
+    } else {
+        _buzzer = 0.0f;                         // Silent step
+    }
+    if(step.red != LED_KEEP)   _red = step.red / 100.0f;
+    if(step.green != LED_KEEP) _green = step.green / 100.0f;
+    if(step.blue != LED_KEEP)  _blue = step.blue / 100.0f;
+
+    _timers.start(_stepTimer, step.durationMs, callback(this, &Annunciator::onStepDone));
+}
+
+// Advance to the next step, loop or finish
+void Annunciator::onStepDone() {
+    if(!_steps) return;
+    if(++_index >= _count) {
+        if(!_repeat) {
+            stop();
+            return;
+        }
+        _index = 0;
+    }
+    startStep();
+}
+
+// Silence and show the resting color
+void Annunciator::restoreBase() {
+    _buzzer = 0.0f;
+    _red = _baseRed;
+    _green = _baseGreen;
+    _blue = _baseBlue;
+}
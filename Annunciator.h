@@ -0,0 +1,73 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "TimerWheel.h"    // Step timing for tone/LED patterns
+
+// One step of a buzzer/LED pattern
+// LED levels are percent (0-100); LED_KEEP leaves a channel unchanged
+struct ToneStep {
+    uint16_t frequency;     // Buzzer frequency in Hz, 0 = silent
+    uint16_t durationMs;    // Step length
+    int8_t red;             // Red LED level
+    int8_t green;           // Green LED level
+    int8_t blue;            // Blue LED level
+};
+
+// Non-blocking buzzer and RGB status LED driver
+// Patterns are stepped from TimerWheel callbacks, so playing a tone never
+// holds up the caller. When a pattern ends the LED returns to its base color.
+class Annunciator {
+public:
+    static const int8_t LED_KEEP = -1;     // Leave LED channel unchanged in a step
+
+    // Constructor
+    // Parameters:
+    //   buzzerPin: PWM pin driving the piezo buzzer
+    //   redPin, greenPin, bluePin: PWM pins of the RGB LED
+    //   timers:    Timer wheel used to step patterns
+    Annunciator(PinName buzzerPin, PinName redPin, PinName greenPin, PinName bluePin, TimerWheel& timers);
+
+    // Sets the resting LED color shown when no pattern is playing
+    // Parameters: red, green, blue levels 0.0-1.0
+    void setColor(float red, float green, float blue);
+
+    // Plays a single tone without blocking
+    // Parameters:
+    //   frequency:  Tone frequency in Hz
+    //   durationMs: Tone length in milliseconds
+    void beep(float frequency, uint32_t durationMs);
+
+    // Starts a pattern, replacing whatever is playing
+    // Parameters:
+    //   steps:  Pattern steps (must stay valid while playing - use static tables)
+    //   count:  Number of steps
+    //   repeat: Loop until stop() is called
+    void play(const ToneStep* steps, int count, bool repeat = false);
+
+    // Stops any pattern, silences the buzzer and restores the base color
+    void stop();
+
+    // Returns: true while a pattern or tone is playing
+    bool busy() const { return _steps != nullptr; }
+
+private:
+    PwmOut _buzzer;             // Piezo buzzer
+    PwmOut _red;                // RGB LED channels
+    PwmOut _green;
+    PwmOut _blue;
+    TimerWheel& _timers;        // Shared timer service
+    WheelTimer _stepTimer;      // Fires at the end of each step
+
+    const ToneStep* _steps;     // Active pattern, nullptr when idle
+    int _count;                 // Steps in the active pattern
+    int _index;                 // Step currently playing
+    bool _repeat;               // Loop the active pattern
+    ToneStep _single;           // Storage for beep()
+    float _baseRed, _baseGreen, _baseBlue;  // Resting LED color
+
+    void startStep();           // Applies the current step and schedules the next
+    void onStepDone();          // Step timer expiry
+    void restoreBase();         // Silences buzzer and shows base color
+};
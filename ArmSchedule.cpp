@@ -0,0 +1,83 @@
+#include "ArmSchedule.h"
+#include "Checksum.h"      // CRC-32 of the stored table
+
+static const char SCHEDULE_FILE[] = "schedule.dat";   // Table on the SD card
+
+// Constructor - empty table until load() runs
+ArmSchedule::ArmSchedule() {
+    clear();
+}
+
+// Read the table from the SD card
+bool ArmSchedule::load(SDCard& sd) {
+    int got = sd.readFile(SCHEDULE_FILE, &_image, sizeof(_image));
+
+    if(got == (int)sizeof(_image) &&
+       _image.magic == MAGIC &&
+       _image.crc == crc32(_image.entries, sizeof(_image.entries))) {
+        bool ok = true;
+        for(int i = 0; i < MAX_ENTRIES; i++) {
+            ok = ok && valid(_image.entries[i]);
+        }
+        if(ok) return true;
+    }
+
+    // Missing or damaged - no unattended transitions rather than guessed ones
+    if(got != SDCard::FILE_MISSING) printf("Schedule invalid (%d bytes), schedule off\n", got);
+    clear();
+    return false;
+}
+
+// Write the table to the SD card
+bool ArmSchedule::save(SDCard& sd) {
+    _image.crc = crc32(_image.entries, sizeof(_image.entries));
+    return sd.writeFile(SCHEDULE_FILE, &_image, sizeof(_image));
+}
+
+// Pick the entry with the shortest wait, counting minutes through the week
+// An entry at the current minute counts as a full week away - it has just run
+bool ArmSchedule::next(uint8_t day, uint8_t hour, uint8_t minute, ScheduleEntry& out) const {
+    int now = (day - 1) * MINUTES_PER_DAY + hour * 60 + minute;
+    int best = MINUTES_PER_WEEK + 1;
+
+    for(int i = 0; i < MAX_ENTRIES; i++) {
+        const ScheduleEntry& e = _image.entries[i];
+        if(e.action == SCHEDULE_NONE) continue;
+
+        // Daily entries are tried on every day of the week
+        int firstDay = e.day ? e.day : 1;
+        int lastDay = e.day ? e.day : 7;
+        for(int d = firstDay; d <= lastDay; d++) {
+            int at = (d - 1) * MINUTES_PER_DAY + e.hour * 60 + e.minute;
+            int wait = (at - now + MINUTES_PER_WEEK) % MINUTES_PER_WEEK;
+            if(wait == 0) wait = MINUTES_PER_WEEK;
+            if(wait < best) {
+                best = wait;
+                out = e;
+                out.day = d;
+            }
+        }
+    }
+    return best <= MINUTES_PER_WEEK;
+}
+
+// Count entries in use
+int ArmSchedule::entryCount() const {
+    int count = 0;
+    for(int i = 0; i < MAX_ENTRIES; i++) {
+        if(_image.entries[i].action != SCHEDULE_NONE) count++;
+    }
+    return count;
+}
+
+// No entries in use
+void ArmSchedule::clear() {
+    memset(&_image, 0, sizeof(_image));
+    _image.magic = MAGIC;
+}
+
+// Reject entries a damaged or hand-edited file could contain
+bool ArmSchedule::valid(const ScheduleEntry& entry) const {
+    return entry.day <= 7 && entry.hour < 24 && entry.minute < 60 &&
+           entry.action <= SCHEDULE_DISARM;
+}
@@ -0,0 +1,72 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SDCard.h"        // Persistence of the schedule table
+
+// Scheduled panel transitions
+enum ScheduleAction : uint8_t {
+    SCHEDULE_NONE,          // Unused entry
+    SCHEDULE_ARM_HOME,      // Arm home if disarmed
+    SCHEDULE_ARM_AWAY,      // Arm away (through the exit delay) if disarmed
+    SCHEDULE_DISARM         // End an arm home that the schedule itself set
+};
+
+// One weekly schedule entry
+struct ScheduleEntry {
+    uint8_t day;            // Day of week 1-7 (RTC numbering), 0 = every day
+    uint8_t hour;           // 0-23
+    uint8_t minute;         // 0-59
+    uint8_t action;         // ScheduleAction
+};
+
+// Weekly auto-arm/disarm table
+// The table lives in schedule.dat on the SD card; without a card, or with a
+// missing or damaged file, the table is empty and the panel never arms or
+// disarms on its own. A damaged file is left on the card as it is.
+// next() turns the table into the single upcoming transition, which the
+// panel programs into the DS3231 alarm instead of polling the clock.
+class ArmSchedule {
+public:
+    static const int MAX_ENTRIES = 16;     // Table capacity
+
+    ArmSchedule();
+
+    // Loads the table from the SD card
+    // Parameters:
+    //   sd: Mounted SD card (may be unmounted - the table stays empty)
+    // Returns: true if the table was read from the card
+    bool load(SDCard& sd);
+
+    // Writes the table back to the SD card
+    // Returns: true if successful
+    bool save(SDCard& sd);
+
+    // Finds the first transition strictly after the given time
+    // Parameters:
+    //   day, hour, minute: Current day of week (1-7) and time
+    //   out: Receives the entry with a concrete day filled in
+    // Returns: false if the table is empty
+    bool next(uint8_t day, uint8_t hour, uint8_t minute, ScheduleEntry& out) const;
+
+    // Returns: number of entries in use
+    int entryCount() const;
+
+private:
+    static const uint32_t MAGIC = 0x31484353;  // "SCH1"
+    static const int MINUTES_PER_DAY = 24 * 60;
+    static const int MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+
+    // Persistent image - written to the card as one block
+    struct Image {
+        uint32_t magic;                         // MAGIC
+        uint32_t crc;                           // CRC-32 of the entries
+        ScheduleEntry entries[MAX_ENTRIES];     // SCHEDULE_NONE marks unused entries
+    };
+
+    Image _image;                   // RAM copy of the table
+
+    void clear();                   // Empty table - no scheduled transitions
+    bool valid(const ScheduleEntry& entry) const;  // Range check of a loaded entry
+};
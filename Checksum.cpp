@@ -0,0 +1,38 @@
+#include "Checksum.h"
+
+// Nibble-wide lookup table - 64 bytes of flash instead of 1KB for the byte table
+static const uint32_t CRC32_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+// Compute CRC-32 over a buffer, continuing from a previous value
+uint32_t crc32(const void* data, size_t length, uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    while(length--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 0x0F];    // Low nibble
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 0x0F];    // High nibble
+    }
+    return ~crc;
+}
+
+// Nibble-wide table for the CCITT polynomial
+static const uint16_t CRC16_NIBBLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// Compute CRC-16 over a buffer, continuing from a previous value
+uint16_t crc16(const void* data, size_t length, uint16_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while(length--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        crc = (uint16_t)(crc << 4) ^ CRC16_NIBBLE[crc >> 12];    // High nibble
+        crc = (uint16_t)(crc << 4) ^ CRC16_NIBBLE[crc >> 12];    // Low nibble
+    }
+    return crc;
+}
@@ -0,0 +1,22 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+#include <cstddef>         // size_t
+
+// CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320) used to protect records
+// persisted on the SD card and in battery-backed registers
+// Parameters:
+//   data:   Pointer to the bytes to checksum
+//   length: Number of bytes
+//   crc:    Running value from a previous call, 0 to start
+// Returns: updated CRC value
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+// CRC-16/CCITT-FALSE (poly 0x1021, MSB first) used to check serial console frames
+// Parameters:
+//   data:   Pointer to the bytes to checksum
+//   length: Number of bytes
+//   crc:    Running value from a previous call, 0xFFFF to start
+// Returns: updated CRC value
+uint16_t crc16(const void* data, size_t length, uint16_t crc = 0xFFFF);
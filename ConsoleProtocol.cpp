@@ -0,0 +1,78 @@
+#include "ConsoleProtocol.h"
+#include "Checksum.h"      // CRC-16 of each frame
+#include <cstring>         // memcpy
+
+// Constructor - waiting for a SYNC byte
+FrameParser::FrameParser() :
+    _state(HUNT),
+    _frame(),
+    _received(0),
+    _crc(0),
+    _badFrames(0)
+{
+}
+
+// The frame is collected in the parser and copied out only once its CRC
+// checks, so the caller's frame may differ from call to call
+bool FrameParser::feed(uint8_t byte, ConsoleFrame& frame) {
+    switch(_state) {
+        case HUNT:
+            if(byte == CONSOLE_SYNC) _state = LENGTH;
+            return false;
+
+        case LENGTH:
+            if(byte > CONSOLE_MAX_PAYLOAD) {
+                _badFrames++;
+                _state = byte == CONSOLE_SYNC ? LENGTH : HUNT;
+                return false;
+            }
+            _frame.length = byte;
+            _state = COMMAND;
+            return false;
+
+        case COMMAND:
+            _frame.command = byte;
+            _received = 0;
+            _state = _frame.length ? PAYLOAD : CRC_LO;
+            return false;
+
+        case PAYLOAD:
+            _frame.payload[_received++] = byte;
+            if(_received == _frame.length) _state = CRC_LO;
+            return false;
+
+        case CRC_LO:
+            _crc = byte;
+            _state = CRC_HI;
+            return false;
+
+        case CRC_HI: {
+            _crc |= (uint16_t)byte << 8;
+            _state = HUNT;
+            uint8_t header[2] = { _frame.length, _frame.command };
+            uint16_t crc = crc16(header, 2);
+            crc = crc16(_frame.payload, _frame.length, crc);
+            if(crc != _crc) {
+                _badFrames++;
+                return false;
+            }
+            frame.command = _frame.command;
+            frame.length = _frame.length;
+            memcpy(frame.payload, _frame.payload, _frame.length);
+            return true;
+        }
+    }
+    return false;
+}
+
+// SYNC, header, payload, CRC
+int encodeFrame(uint8_t command, const uint8_t* payload, uint8_t length, uint8_t* out) {
+    out[0] = CONSOLE_SYNC;
+    out[1] = length;
+    out[2] = command;
+    if(length) memcpy(out + 3, payload, length);
+    uint16_t crc = crc16(out + 1, length + 2);
+    out[3 + length] = (uint8_t)crc;
+    out[4 + length] = (uint8_t)(crc >> 8);
+    return length + CONSOLE_OVERHEAD;
+}
@@ -0,0 +1,165 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+
+// Serial console wire format, shared by the firmware and the host tools
+// in tools/ - nothing here depends on mbed.
+//
+// Frame: SYNC  LEN  CMD  PAYLOAD[LEN]  CRC_LO  CRC_HI
+//   SYNC:    0xA5 - never part of the ASCII debug text on the same port
+//   LEN:     Payload bytes, 0 to CONSOLE_MAX_PAYLOAD
+//   CMD:     ConsoleCommand; responses set CONSOLE_RESPONSE
+//   CRC:     CRC-16/CCITT-FALSE over LEN, CMD and the payload, little-endian
+// Multi-byte payload fields are little-endian. Every response payload
+// starts with a ConsoleResult byte; pushed frames (TelemetryProtocol.h) do not.
+
+static const uint8_t CONSOLE_SYNC = 0xA5;           // Start of frame
+static const uint8_t CONSOLE_MAX_PAYLOAD = 128;     // Largest payload in either direction
+static const uint8_t CONSOLE_OVERHEAD = 5;          // SYNC, LEN, CMD and CRC bytes
+static const uint8_t CONSOLE_RESPONSE = 0x80;       // Set in CMD of panel replies
+static const uint8_t CONSOLE_PUSH = 0x40;           // Also set in CMD of unsolicited panel frames (no result byte)
+static const uint8_t CONSOLE_CODE_LENGTH = 4;       // ASCII digits in an arm/disarm request
+static const uint8_t USER_REQUEST_LENGTH = 10;      // CMD_SET_USER payload
+
+// Commands
+enum ConsoleCommand : uint8_t {
+    CMD_STATUS = 0x01,      // -> state, mode, countdown, epoch, flags
+    CMD_ARM_HOME = 0x02,    // code[4] -> result
+    CMD_ARM_AWAY = 0x03,    // code[4] -> result (exit delay starts)
+    CMD_DISARM = 0x04,      // code[4] -> result
+    CMD_EXPORT = 0x05,      // file, flags, from u32, to u32 -> stream, see CMD_EXPORT below
+    CMD_STATS = 0x06,       // -> counters, see ConsoleStats
+    CMD_TELEMETRY = 0x07,   // [period_s u16, 0 = off] -> result; next push is a keyframe
+    CMD_SET_USER = 0x08     // master code[4], slot u8, perms u8, code[4] -> result; perms 0 removes
+};
+
+// First payload byte of every response
+enum ConsoleResult : uint8_t {
+    RESULT_OK,              // Done
+    RESULT_BAD_CODE,        // Unknown code or missing permission
+    RESULT_LOCKED_OUT,      // Too many wrong codes on this port - try later
+    RESULT_REFUSED,         // Not possible in the current state
+    RESULT_BAD_REQUEST,     // Payload has the wrong length
+    RESULT_UNKNOWN_COMMAND, // CMD not recognised
+    RESULT_NO_CARD          // Export without a mounted SD card
+};
+
+// CMD_STATUS response payload after the result byte
+static const uint8_t STATUS_FLAG_SD = 0x01;         // SD card mounted
+static const uint8_t STATUS_LENGTH = 9;             // result, state, mode, countdown, epoch u32, flags
+
+// CMD_STATS response payload after the result byte, all u32 (drift is signed)
+enum ConsoleStats : uint8_t {
+    STAT_UPTIME_S,          // Seconds since boot
+    STAT_KEYS_DROPPED,      // Key events lost to a full key FIFO
+    STAT_EVENTS_DROPPED,    // Bus events lost to full consumer queues
+    STAT_BAD_FRAMES,        // Console frames rejected (CRC or length)
+    STAT_TX_DROPPED,        // Console output bytes dropped for lack of buffer
+    STAT_CLOCK_DRIFT_PPB,   // Kernel tick drift against the DS3231
+    STAT_CLOCK_ERROR_MS,    // Clock error bound
+    STAT_COUNT
+};
+
+// CMD_EXPORT - streams a log file in blocks read straight from the card
+// Request: file u8, flags u8, from u32, to u32
+//   Byte range:  from and to are file offsets, to = 0 means the end of the file
+//   By time:     from and to are Unix seconds, matched against the timestamp
+//                that starts every line; to = 0 means the end of the file
+// Replies: result u8, kind u8, offset u32, size u16, data
+//   START:  offset = first byte sent; data = end offset u32 (EXPORT_OPEN_END
+//           if the transfer runs to the end of the file)
+//   DATA:   one part of a block; offset = block's first file byte, size =
+//           block bytes before encoding. The parts of a block, concatenated,
+//           are its bytes - LZSS-compressed if EXPORT_PART_LZSS is set.
+//   END:    offset = end of the transfer
+// Blocks end on file sector boundaries and are encoded independently, so a
+// broken transfer resumes with a byte-range request from the last complete
+// block. A failed request is answered with the result byte alone.
+static const uint8_t EXPORT_FILE_EVENTS = 0;        // events.txt
+static const uint8_t EXPORT_LZSS = 0x01;            // Request flag: compress blocks
+static const uint8_t EXPORT_BY_TIME = 0x02;         // Request flag: from/to are Unix seconds
+static const uint8_t EXPORT_REQUEST_LENGTH = 10;    // file, flags, from, to
+
+static const uint8_t EXPORT_START = 0x01;           // Reply kind: range resolved
+static const uint8_t EXPORT_DATA = 0x02;            // Reply kind: block part
+static const uint8_t EXPORT_END = 0x04;             // Reply kind: transfer complete
+static const uint8_t EXPORT_PART_LAST = 0x10;       // DATA modifier: final part of the block
+static const uint8_t EXPORT_PART_LZSS = 0x20;       // DATA modifier: block is compressed
+
+static const uint8_t EXPORT_HEADER = 8;             // result, kind, offset, size
+static const uint8_t EXPORT_CHUNK = CONSOLE_MAX_PAYLOAD - EXPORT_HEADER;   // Data bytes per part
+static const uint32_t EXPORT_BLOCK = 512;           // File bytes per block - one card sector
+static const uint32_t EXPORT_OPEN_END = 0xFFFFFFFF; // START end offset: up to end of file
+
+// One decoded frame
+struct ConsoleFrame {
+    uint8_t command;                            // ConsoleCommand, possibly with CONSOLE_RESPONSE
+    uint8_t length;                             // Payload bytes
+    uint8_t payload[CONSOLE_MAX_PAYLOAD];       // Payload
+};
+
+// Byte-at-a-time frame decoder
+// Bytes before a SYNC are skipped, so ASCII text on the same stream is
+// ignored. A bad length or CRC drops the frame and hunts for the next SYNC.
+// A partly received frame is kept in the parser, so a frame may arrive
+// over any number of feed() calls with different destinations.
+class FrameParser {
+public:
+    FrameParser();
+
+    // Consumes one received byte
+    // Parameters:
+    //   byte:  Next byte from the stream
+    //   frame: Receives the frame when one completes (untouched otherwise)
+    // Returns: true if frame holds a new, CRC-checked frame
+    bool feed(uint8_t byte, ConsoleFrame& frame);
+
+    // Abandons a partly received frame
+    void reset() { _state = HUNT; }
+
+    // Returns: frames rejected for bad length or CRC
+    uint32_t badFrames() const { return _badFrames; }
+
+private:
+    // Position within a frame
+    enum State : uint8_t { HUNT, LENGTH, COMMAND, PAYLOAD, CRC_LO, CRC_HI };
+
+    State _state;               // What the next byte is
+    ConsoleFrame _frame;        // Frame being received
+    uint8_t _received;          // Payload bytes so far
+    uint16_t _crc;              // CRC received (low byte first)
+    uint32_t _badFrames;        // Rejected frame count
+};
+
+// Builds a frame
+// Parameters:
+//   command: CMD byte
+//   payload: Payload bytes (may be nullptr if length is 0)
+//   length:  Payload length, at most CONSOLE_MAX_PAYLOAD
+//   out:     Destination, at least length + CONSOLE_OVERHEAD bytes
+// Returns: frame length in bytes
+int encodeFrame(uint8_t command, const uint8_t* payload, uint8_t length, uint8_t* out);
+
+// Little-endian field helpers - return the position after the field
+inline uint8_t* putU32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+inline uint8_t* putU16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
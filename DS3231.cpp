@@ -0,0 +1,119 @@
+#include "DS3231.h"
+#include "FastFormat.h"     // Branch-free BCD conversion
+
+// Constructor
+DS3231::DS3231(I2C& i2c) :
+    _i2c(i2c)
+{
+}
+
+// Read the 7 time registers in one burst
+bool DS3231::readTime(RtcTime& time) {
+    uint8_t data[7];
+    if(!readRegisters(REG_TIME, data, 7)) return false;
+
+    // Convert BCD values to decimal
+    time.sec = bcdToDec(data[0] & 0x7F);
+    time.min = bcdToDec(data[1] & 0x7F);
+    time.hour = bcdToDec(data[2] & 0x3F);
+    time.day = bcdToDec(data[3] & 0x07);
+    time.date = bcdToDec(data[4] & 0x3F);
+    time.month = bcdToDec(data[5] & 0x1F);
+    time.year = bcdToDec(data[6]);
+    return true;
+}
+
+// Write the 7 time registers in one burst
+bool DS3231::writeTime(const RtcTime& time) {
+    uint8_t data[7];
+    data[0] = decToBcd(time.sec) & 0x7F;     // Seconds
+    data[1] = decToBcd(time.min) & 0x7F;     // Minutes
+    data[2] = decToBcd(time.hour) & 0x3F;    // Hours (24hr mode)
+    data[3] = decToBcd(time.day) & 0x07;     // Day of week (1-7)
+    data[4] = decToBcd(time.date) & 0x3F;    // Date (1-31)
+    data[5] = decToBcd(time.month) & 0x1F;   // Month (1-12)
+    data[6] = decToBcd(time.year);           // Year (00-99)
+    return writeRegisters(REG_TIME, data, 7);
+}
+
+// Day of week only - the other time registers keep counting
+bool DS3231::writeDay(uint8_t day) {
+    uint8_t data = decToBcd(day) & 0x07;
+    return writeRegisters(REG_DAY, &data, 1);
+}
+
+// Alarm 1 with every mask bit clear matches day of week, hours, minutes and seconds
+bool DS3231::setAlarm1Weekly(uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+    uint8_t data[4];
+    data[0] = decToBcd(sec) & 0x7F;
+    data[1] = decToBcd(min) & 0x7F;
+    data[2] = decToBcd(hour) & 0x3F;
+    data[3] = ALARM_DY | (day & 0x07);
+    return writeRegisters(REG_ALARM1, data, 4);
+}
+
+// Alarm 2 with minutes, hours and day masked matches every time seconds reach 00
+bool DS3231::setAlarm2EveryMinute() {
+    uint8_t data[3] = { ALARM_MASK, ALARM_MASK, ALARM_MASK };
+    return writeRegisters(REG_ALARM2, data, 3);
+}
+
+// Switch INT/SQW to alarm output and set the interrupt enables
+// Flags are not touched: clearing here could lose an alarm that matched
+// before the caller got to service it
+bool DS3231::enableAlarms(uint8_t alarms) {
+    uint8_t control = CONTROL_INTCN | (alarms & (ALARM_1 | ALARM_2));
+    return writeRegisters(REG_CONTROL, &control, 1);
+}
+
+// Clear only the flags that were read as set. Writing 1 leaves an alarm
+// flag as it is, so one that sets between the read and the write survives
+uint8_t DS3231::takeAlarmFlags() {
+    uint8_t status;
+    if(!readRegisters(REG_STATUS, &status, 1)) return 0;
+    uint8_t fired = status & (ALARM_1 | ALARM_2);
+    if(fired) {
+        status = (status | ALARM_1 | ALARM_2) & ~fired;
+        writeRegisters(REG_STATUS, &status, 1);
+    }
+    return fired;
+}
+
+// Read-modify-write of the status register; the other alarm flag is
+// written as 1 so that it is left as it is
+bool DS3231::clearAlarmFlags(uint8_t alarms) {
+    uint8_t status;
+    if(!readRegisters(REG_STATUS, &status, 1)) return false;
+    if(!(status & alarms)) return true;
+    status = (status | ALARM_1 | ALARM_2) & ~(alarms & (ALARM_1 | ALARM_2));
+    return writeRegisters(REG_STATUS, &status, 1);
+}
+
+// Register address followed by the data, one transaction
+bool DS3231::writeRegisters(uint8_t reg, const uint8_t* data, int count) {
+    char buf[8];
+    if(count > (int)sizeof(buf) - 1) return false;
+    buf[0] = reg;
+    memcpy(buf + 1, data, count);
+    return _i2c.write(ADDRESS, buf, count + 1) == 0;
+}
+
+// Set the register pointer, then read with a repeated start
+bool DS3231::readRegisters(uint8_t reg, uint8_t* data, int count) {
+    char addr = reg;
+    _i2c.lock();                                   // Keep other threads off the bus until the read ends
+    bool ok = _i2c.write(ADDRESS, &addr, 1, true) == 0 &&
+              _i2c.read(ADDRESS, (char*)data, count) == 0;
+    _i2c.unlock();
+    return ok;
+}
+
+// Converts Binary Coded Decimal (BCD) to standard decimal
+uint8_t DS3231::bcdToDec(uint8_t val) {
+    return bcdToBin(val);
+}
+
+// Converts standard decimal to Binary Coded Decimal (BCD)
+uint8_t DS3231::decToBcd(uint8_t val) {
+    return binToBcd(val);
+}
@@ -0,0 +1,99 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+
+// Calendar time as held in the DS3231 registers (decimal, 24-hour)
+struct RtcTime {
+    uint8_t sec;            // 0-59
+    uint8_t min;            // 0-59
+    uint8_t hour;           // 0-23
+    uint8_t day;            // Day of week 1-7
+    uint8_t date;           // Day of month 1-31
+    uint8_t month;          // 1-12
+    uint8_t year;           // 0-99 (2000-2099)
+};
+
+// DS3231 real-time clock driver
+// Time and alarm registers are moved in single I2C bursts. The INT/SQW pin
+// is used as an alarm interrupt output (INTCN set): it goes low when an
+// enabled alarm matches and stays low until takeAlarmFlags() clears it.
+class DS3231 {
+public:
+    // Alarm bits for enableAlarms() and takeAlarmFlags()
+    enum Alarm : uint8_t {
+        ALARM_1 = 0x01,     // Seconds resolution
+        ALARM_2 = 0x02      // Minutes resolution
+    };
+
+    // Constructor
+    // Parameters:
+    //   i2c: I2C bus the DS3231 is on (address 0x68)
+    DS3231(I2C& i2c);
+
+    // Reads the current time
+    // Returns: true if the read was acknowledged
+    bool readTime(RtcTime& time);
+
+    // Sets the current time
+    // Returns: true if the write was acknowledged
+    bool writeTime(const RtcTime& time);
+
+    // Rewrites the day of week register alone
+    // Alarm 1 matches this register, so it must follow RtcTime's numbering
+    // Parameters:
+    //   day: Day of week 1-7
+    // Returns: true if the write was acknowledged
+    bool writeDay(uint8_t day);
+
+    // Programs Alarm 1 to fire once a week
+    // Parameters:
+    //   day:  Day of week 1-7 (same numbering as RtcTime::day)
+    //   hour, min, sec: Time of day
+    // Returns: true if the write was acknowledged
+    bool setAlarm1Weekly(uint8_t day, uint8_t hour, uint8_t min, uint8_t sec);
+
+    // Programs Alarm 2 to fire at the start of every minute
+    // The falling edge marks seconds rolling over to 00, exact to the 32 kHz
+    // oscillator, which is finer than any whole-second time read
+    // Returns: true if the write was acknowledged
+    bool setAlarm2EveryMinute();
+
+    // Selects alarm interrupt output and enables the given alarms
+    // Pending flags are left alone - clear them with takeAlarmFlags()
+    // Parameters:
+    //   alarms: Alarm bits to enable, others are disabled
+    // Returns: true if the write was acknowledged
+    bool enableAlarms(uint8_t alarms);
+
+    // Reads and clears the alarm flags, releasing INT/SQW
+    // Returns: Alarm bits that had fired
+    uint8_t takeAlarmFlags();
+
+    // Clears the given alarm flags only
+    // A flag sets on every match, enabled or not; clear it before enabling
+    // the alarm or INT/SQW asserts at once
+    // Returns: true if the registers were accessed
+    bool clearAlarmFlags(uint8_t alarms);
+
+    static uint8_t bcdToDec(uint8_t val);  // Converts BCD to decimal
+    static uint8_t decToBcd(uint8_t val);  // Converts decimal to BCD
+
+private:
+    static const int ADDRESS = 0x68 << 1;      // 8-bit I2C address
+    static const uint8_t REG_TIME = 0x00;      // Seconds, first of 7 time registers
+    static const uint8_t REG_DAY = 0x03;       // Day of week
+    static const uint8_t REG_ALARM1 = 0x07;    // Alarm 1 seconds, first of 4
+    static const uint8_t REG_ALARM2 = 0x0B;    // Alarm 2 minutes, first of 3
+    static const uint8_t REG_CONTROL = 0x0E;   // EOSC BBSQW CONV RS2 RS1 INTCN A2IE A1IE
+    static const uint8_t REG_STATUS = 0x0F;    // OSF 0 0 0 EN32kHz BSY A2F A1F
+    static const uint8_t CONTROL_INTCN = 0x04; // INT/SQW follows the alarm flags
+    static const uint8_t ALARM_DY = 0x40;      // Alarm day register holds day of week
+    static const uint8_t ALARM_MASK = 0x80;    // AxMy - field ignored by the match
+
+    I2C& _i2c;                  // Shared I2C bus
+
+    bool writeRegisters(uint8_t reg, const uint8_t* data, int count);  // One write burst
+    bool readRegisters(uint8_t reg, uint8_t* data, int count);         // Repeated-start read burst
+};
@@ -0,0 +1,44 @@
+#include "EventBus.h"
+
+// Constructor - empty queues
+EventBus::EventBus() {
+    memset(_dropped, 0, sizeof(_dropped));
+}
+
+// Copy an event to every subscriber's queue
+bool EventBus::publish(const PanelEvent& event) {
+    uint8_t subscribers = EVENT_SUBSCRIBERS[event.type];
+    bool delivered = true;
+
+    for(int c = 0; c < CONSUMER_COUNT; c++) {
+        if(subscribers & (1u << c)) {
+            if(!_queues[c].push(event)) {
+                _dropped[c]++;
+                delivered = false;
+            }
+        }
+    }
+#if MBED_CONF_RTOS_PRESENT
+    _ready.set(subscribers);    // Flag bits match the subscriber mask
+#endif
+    return delivered;
+}
+
+#if MBED_CONF_RTOS_PRESENT
+// Block until a consumer's flag is set or the timeout expires
+void EventBus::wait(EventConsumer consumer, uint32_t timeoutMs) {
+    if(!_queues[consumer].empty()) return;
+    _ready.wait_any_for(1u << consumer, std::chrono::milliseconds(timeoutMs));
+}
+#endif
+
+// Hand queued events to a consumer
+int EventBus::drain(EventConsumer consumer, int budget, mbed::Callback<void(const PanelEvent&)> handler) {
+    int handled = 0;
+    PanelEvent event;
+    while(handled < budget && _queues[consumer].pop(event)) {
+        handler(event);
+        handled++;
+    }
+    return handled;
+}
@@ -0,0 +1,131 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SpscQueue.h"     // Per-consumer lock-free queues
+
+// Panel Event Types
+// Producers publish one of these once; the subscriber table decides who hears it
+enum PanelEventType : uint8_t {
+    EVT_SYSTEM_STARTED,     // Boot complete
+    EVT_ARMED,              // Armed home or away (state field tells which)
+    EVT_DISARMED,           // Disarmed from any state
+    EVT_ALARM_CAUSE,        // What started an alarm - text names the sensor or key
+    EVT_ALARM,              // Alarm started
+    EVT_DOOR_OPENED,        // Door opened while not armed away
+    EVT_PROXIMITY,          // Ultrasonic proximity warning in home mode
+    EVT_ENTRY_COUNTDOWN,    // Entry delay second elapsed - arg holds seconds left
+    EVT_WRONG_CODE,         // Invalid code entered
+    EVT_LOCKOUT,            // Keypad locked out after repeated wrong codes
+    EVT_DURESS,             // Duress code used
+    EVT_SCREEN,             // Display-only redraw request - arg holds the screen to draw
+    EVT_EXIT_COUNTDOWN,     // Exit delay second elapsed - arg holds seconds left
+    EVT_SCHEDULE,           // Scheduled arm/disarm about to run
+    EVT_REMOTE,             // Serial console command about to run
+    EVT_COUNT
+};
+
+// Event Consumers
+enum EventConsumer : uint8_t {
+    CONSUMER_LOGGER,        // SD card event log - slowest
+    CONSUMER_DISPLAY,       // uLCD status screen
+    CONSUMER_ANNUNCIATOR,   // Buzzer and RGB LED - fastest
+    CONSUMER_COUNT
+};
+
+// Event record copied into each subscriber's queue
+struct PanelEvent {
+    PanelEventType type;    // What happened
+    uint8_t state;          // SystemState at publish time
+    uint16_t arg;           // Type-specific value
+    uint32_t timestamp;     // Unix seconds at publish time
+    uint32_t keyUs;         // us_ticker detection time of the key that caused it, 0 = none
+    const char* text;       // Static message (string literal), nullptr = not logged
+};
+
+#define SUB_LOG  (1u << CONSUMER_LOGGER)
+#define SUB_LCD  (1u << CONSUMER_DISPLAY)
+#define SUB_ANN  (1u << CONSUMER_ANNUNCIATOR)
+
+// Compile-time subscriber lists, indexed by PanelEventType
+constexpr uint8_t EVENT_SUBSCRIBERS[EVT_COUNT] = {
+    SUB_LOG,                        // EVT_SYSTEM_STARTED
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_ARMED
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_DISARMED
+    SUB_LOG | SUB_LCD,              // EVT_ALARM_CAUSE
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_ALARM
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_DOOR_OPENED
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_PROXIMITY
+    SUB_LCD,                        // EVT_ENTRY_COUNTDOWN
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_WRONG_CODE
+    SUB_LOG | SUB_LCD,              // EVT_LOCKOUT
+    SUB_LOG,                        // EVT_DURESS
+    SUB_LCD,                        // EVT_SCREEN
+    SUB_LOG | SUB_LCD | SUB_ANN,    // EVT_EXIT_COUNTDOWN - only the first one carries text
+    SUB_LOG,                        // EVT_SCHEDULE
+    SUB_LOG,                        // EVT_REMOTE
+};
+
+#undef SUB_LOG
+#undef SUB_LCD
+#undef SUB_ANN
+
+// Every event must reach at least one consumer
+constexpr bool eventSubscribersValid() {
+    for(int i = 0; i < EVT_COUNT; i++) {
+        if(EVENT_SUBSCRIBERS[i] == 0 || EVENT_SUBSCRIBERS[i] >= (1u << CONSUMER_COUNT)) return false;
+    }
+    return true;
+}
+static_assert(sizeof(EVENT_SUBSCRIBERS) == EVT_COUNT, "Subscriber table must cover every event type");
+static_assert(eventSubscribersValid(), "Event with no subscribers or an unknown consumer");
+
+// Intra-firmware publish/subscribe bus
+// publish() copies the event into the queue of every subscriber; each
+// consumer drains its own queue at its own pace, so a slow SD write never
+// delays the buzzer or the display. Publish from one context only.
+// In the RTOS profile each consumer thread blocks in wait() until its queue
+// has work.
+class EventBus {
+public:
+    static const uint32_t QUEUE_DEPTH = 16;    // Events buffered per consumer
+
+    EventBus();
+
+    // Delivers an event to all of its subscribers
+    // Returns: false if any subscriber queue was full and dropped it
+    bool publish(const PanelEvent& event);
+
+    // Handles up to 'budget' queued events for one consumer
+    // Parameters:
+    //   consumer: Whose queue to drain
+    //   budget:   Maximum events to handle in this call
+    //   handler:  Called once per event
+    // Returns: number of events handled
+    int drain(EventConsumer consumer, int budget, mbed::Callback<void(const PanelEvent&)> handler);
+
+#if MBED_CONF_RTOS_PRESENT
+    // Blocks the calling thread until a consumer's queue may have events
+    // Parameters:
+    //   consumer: Queue to wait on
+    //   timeoutMs: Longest wait
+    void wait(EventConsumer consumer, uint32_t timeoutMs);
+
+    // Releases a consumer thread from wait() for work outside its queue
+    void wake(EventConsumer consumer) { _ready.set(1u << consumer); }
+#endif
+
+    // Returns: events waiting for a consumer
+    uint32_t pending(EventConsumer consumer) const { return _queues[consumer].size(); }
+
+    // Returns: events dropped because a consumer's queue was full
+    uint32_t dropped(EventConsumer consumer) const { return _dropped[consumer]; }
+
+private:
+    SpscQueue<PanelEvent, QUEUE_DEPTH> _queues[CONSUMER_COUNT];    // One queue per consumer
+    uint32_t _dropped[CONSUMER_COUNT];                              // Overflow counters
+#if MBED_CONF_RTOS_PRESENT
+    rtos::EventFlags _ready;                                        // One flag per consumer with new events
+#endif
+};
@@ -0,0 +1,101 @@
+#include "EventStats.h"
+#include "Checksum.h"      // CRC-32 of the stored counters
+
+static const char STATS_FILE[] = "stats.dat";   // Counters on the SD card
+
+// Constructor - empty counters until load() runs
+EventStats::EventStats() :
+    _dirty(false),
+    _savedMs(0)
+{
+    reset();
+}
+
+// Read the counters from the SD card
+bool EventStats::load(SDCard& sd) {
+    int got = sd.readFile(STATS_FILE, &_image, sizeof(_image));
+
+    if(got == (int)sizeof(_image) && _image.magic == MAGIC && _image.crc == imageCrc()) {
+        return true;
+    }
+
+    // Missing, damaged or from a firmware with other event types
+    printf("Stats invalid (%d bytes), starting from zero\n", got);
+    reset();
+    return false;
+}
+
+// Write the counters to the SD card - record() runs in the same context,
+// so the image cannot change during the write
+bool EventStats::save(SDCard& sd) {
+    _image.crc = imageCrc();
+    _dirty = false;
+    _savedMs = Kernel::get_ms_count();
+    return sd.writeFile(STATS_FILE, &_image, sizeof(_image));
+}
+
+// A handful of increments; counters saturate instead of wrapping, and an
+// hour-of-day row is halved when one of its cells fills so its shape is kept
+void EventStats::record(PanelEventType type, uint32_t epoch) {
+    if(type >= EVT_COUNT) return;
+    uint32_t day = epoch / SECONDS_PER_DAY;
+    uint8_t hour = (uint8_t)(epoch % SECONDS_PER_DAY / 3600);
+
+    core_util_critical_section_enter();
+    if(day > _image.day) advance(day);    // A clock set backwards counts into the newest day
+
+    _image.total[type]++;
+    uint16_t& bucket = _image.daily[_image.day % DAYS][type];
+    if(bucket < 0xFFFF) bucket++;
+
+    uint16_t* hours = _image.hourly[type];
+    if(hours[hour] == 0xFFFF) {
+        for(int h = 0; h < 24; h++) hours[h] >>= 1;
+    }
+    hours[hour]++;
+    core_util_critical_section_exit();
+
+    _dirty = true;
+}
+
+// Buckets older than the window are not cleared until their slot is reused,
+// so only those within DAYS of both now and the newest bucket are summed
+void EventStats::view(uint32_t now, EventStatsView& out) const {
+    uint32_t today = now / SECONDS_PER_DAY;
+    core_util_critical_section_enter();
+    for(int t = 0; t < EVT_COUNT; t++) {
+        out.week[t] = 0;
+        out.total[t] = _image.total[t];
+    }
+    for(uint32_t back = 0; back < DAYS && back <= today; back++) {
+        uint32_t day = today - back;
+        if(day > _image.day || _image.day - day >= DAYS) continue;
+        for(int t = 0; t < EVT_COUNT; t++) {
+            out.week[t] += _image.daily[day % DAYS][t];
+        }
+    }
+    memcpy(out.alarmsByHour, _image.hourly[EVT_ALARM], sizeof(out.alarmsByHour));
+    core_util_critical_section_exit();
+}
+
+// Zero everything
+void EventStats::reset() {
+    memset(&_image, 0, sizeof(_image));
+    _image.magic = MAGIC;
+}
+
+// At most DAYS buckets are cleared, however long the panel was off
+void EventStats::advance(uint32_t day) {
+    uint32_t skipped = day - _image.day;
+    if(skipped > DAYS) skipped = DAYS;
+    for(uint32_t i = 1; i <= skipped; i++) {
+        memset(_image.daily[(_image.day + i) % DAYS], 0, sizeof(_image.daily[0]));
+    }
+    _image.day = day;
+}
+
+// Everything after the crc field
+uint32_t EventStats::imageCrc() const {
+    const uint8_t* start = (const uint8_t*)&_image.day;
+    return crc32(start, sizeof(_image) - (start - (const uint8_t*)&_image));
+}
@@ -0,0 +1,78 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SDCard.h"        // Checkpoint file
+#include "EventBus.h"      // PanelEventType
+
+// Summary handed to the stats screen
+struct EventStatsView {
+    uint32_t week[EVT_COUNT];       // Events per type over the last 7 days
+    uint32_t total[EVT_COUNT];      // Events per type since the counters were created
+    uint16_t alarmsByHour[24];      // Alarms per hour of day (scaled down together on overflow)
+};
+
+// Rolling event counters
+// The logger consumer records every event it handles: a lifetime total per
+// event type, one bucket per type for each of the last seven days and an
+// hour-of-day histogram per type. Each record() is a few increments, so
+// "how many alarms this week" never needs a log scan. The counters are
+// written to stats.dat every few minutes while they change and read back at
+// boot; a reset loses at most the events since the last save.
+class EventStats {
+public:
+    static const int DAYS = 7;                          // Days in the rolling window
+    static const uint32_t SAVE_INTERVAL_MS = 300000;    // Shortest time between checkpoints (5 min)
+
+    EventStats();
+
+    // Loads the counters saved on the SD card
+    // Parameters:
+    //   sd: Mounted SD card (may be unmounted - counting starts from zero)
+    // Returns: true if the counters were read from the card
+    bool load(SDCard& sd);
+
+    // Writes the counters to the SD card and clears the dirty flag
+    // Call from the context that calls record()
+    // Returns: true if successful
+    bool save(SDCard& sd);
+
+    // Counts one event
+    // Parameters:
+    //   type:  Event type
+    //   epoch: Unix seconds the event happened
+    void record(PanelEventType type, uint32_t epoch);
+
+    // Returns: true if counters changed and the last save is long enough ago
+    bool saveDue(uint32_t nowMs) const { return _dirty && nowMs - _savedMs >= SAVE_INTERVAL_MS; }
+
+    // Fills in the screen summary
+    // Safe to call from another thread than record()
+    // Parameters:
+    //   now: Unix seconds, ends the 7-day window
+    //   out: Receives the counts
+    void view(uint32_t now, EventStatsView& out) const;
+
+private:
+    static const uint32_t MAGIC = 0x31545453;  // "STT1"
+    static const uint32_t SECONDS_PER_DAY = 86400;
+
+    // Persistent image - written to the card as one block
+    struct Image {
+        uint32_t magic;                         // MAGIC
+        uint32_t crc;                           // CRC-32 of everything after it
+        uint32_t day;                           // Day number (Unix days) of the newest bucket
+        uint32_t total[EVT_COUNT];              // Lifetime count per type
+        uint16_t daily[DAYS][EVT_COUNT];        // Count per type, bucket day % DAYS
+        uint16_t hourly[EVT_COUNT][24];         // Count per type and hour of day
+    };
+
+    Image _image;                   // RAM copy of the counters
+    bool _dirty;                    // Changed since the last save
+    uint32_t _savedMs;              // Kernel time of the last save
+
+    void reset();                   // All counters zero
+    void advance(uint32_t day);     // Clears buckets of the days skipped up to day
+    uint32_t imageCrc() const;      // CRC-32 of the counters
+};
@@ -0,0 +1,135 @@
+#include "FastFormat.h"
+#include "mbed.h"
+
+const char DIGIT_PAIRS[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+// Digits are produced two at a time from the low end into a scratch
+// buffer, then copied forward
+char* fmtUint(char* p, uint32_t value) {
+    char digits[10];
+    char* d = digits + sizeof(digits);
+    while(value >= 100) {
+        d -= 2;
+        fmtTwoDigits(d, value % 100);
+        value /= 100;
+    }
+    if(value >= 10) {
+        d -= 2;
+        fmtTwoDigits(d, value);
+    } else {
+        *--d = '0' + value;
+    }
+    while(d < digits + sizeof(digits)) *p++ = *d++;
+    return p;
+}
+
+// Pad first, then the digits - the digit count is known from the value
+char* fmtUintPadded(char* p, uint32_t value, int width) {
+    int count = 1;
+    for(uint32_t v = value; v >= 10; v /= 10) count++;
+    while(width-- > count) *p++ = ' ';
+    return fmtUint(p, value);
+}
+
+// Bounded copy
+char* fmtText(char* p, const char* end, const char* text) {
+    while(*text && p < end) *p++ = *text++;
+    return p;
+}
+
+// Fields split with one division each, written by table
+char* fmtTimeOfDay(char* p, uint32_t secondOfDay) {
+    uint32_t minutes = secondOfDay / 60;
+    p = fmtTwoDigits(p, minutes / 60);
+    *p++ = ':';
+    p = fmtTwoDigits(p, minutes % 60);
+    *p++ = ':';
+    return fmtTwoDigits(p, secondOfDay - minutes * 60);
+}
+
+// Calendar fields are already broken down - pure table writes
+char* fmtIsoDateTime(char* p, const RtcTime& time) {
+    p = fmtTwoDigits(p, 20);
+    p = fmtTwoDigits(p, time.year);
+    *p++ = '-';
+    p = fmtTwoDigits(p, time.month);
+    *p++ = '-';
+    p = fmtTwoDigits(p, time.date);
+    *p++ = ' ';
+    p = fmtTwoDigits(p, time.hour);
+    *p++ = ':';
+    p = fmtTwoDigits(p, time.min);
+    *p++ = ':';
+    return fmtTwoDigits(p, time.sec);
+}
+
+#if MBED_CONF_APP_FAST_FORMAT_BENCHMARK
+
+static const int BENCH_ROUNDS = 2000;   // Calls per measurement
+
+static volatile uint8_t benchSink;      // Keeps results live through the optimiser
+
+// Time one loop body; returns nanoseconds per call
+template<typename F>
+static uint32_t timeRounds(F body) {
+    Timer timer;
+    timer.start();
+    for(int i = 0; i < BENCH_ROUNDS; i++) body(i);
+    timer.stop();
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(timer.elapsed_time()).count() / BENCH_ROUNDS);
+}
+
+// Same inputs through both paths, the old one first
+void fastFormatBenchmark() {
+    char buf[32];
+    RtcTime time = { 0, 0, 0, 1, 1, 1, 24 };
+
+    uint32_t bcdDiv = timeRounds([&](int i) {
+        uint8_t v = (uint8_t)(i & 0x7F);
+        benchSink = (v / 16 * 10) + (v % 16);
+    });
+    uint32_t bcdFast = timeRounds([&](int i) {
+        benchSink = bcdToBin((uint8_t)(i & 0x7F));
+    });
+
+    uint32_t timeSprintf = timeRounds([&](int i) {
+        uint32_t s = (uint32_t)i * 43;
+        sprintf(buf, "%02lu:%02lu:%02lu", (unsigned long)(s / 3600), (unsigned long)(s / 60 % 60),
+                (unsigned long)(s % 60));
+        benchSink = buf[7];
+    });
+    uint32_t timeFast = timeRounds([&](int i) {
+        *fmtTimeOfDay(buf, (uint32_t)i * 43) = '\0';
+        benchSink = buf[7];
+    });
+
+    uint32_t stampSprintf = timeRounds([&](int i) {
+        time.sec = i % 60;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d", 2000 + time.year, time.month,
+                 time.date, time.hour, time.min, time.sec);
+        benchSink = buf[18];
+    });
+    uint32_t stampFast = timeRounds([&](int i) {
+        time.sec = i % 60;
+        *fmtIsoDateTime(buf, time) = '\0';
+        benchSink = buf[18];
+    });
+
+    printf("Format ns/call (old/new): bcd %lu/%lu, time %lu/%lu, timestamp %lu/%lu\n",
+           (unsigned long)bcdDiv, (unsigned long)bcdFast,
+           (unsigned long)timeSprintf, (unsigned long)timeFast,
+           (unsigned long)stampSprintf, (unsigned long)stampFast);
+}
+
+#endif
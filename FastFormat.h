@@ -0,0 +1,68 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+#include "DS3231.h"        // RtcTime
+
+// Boot-time comparison of these writers against the snprintf path
+#ifndef MBED_CONF_APP_FAST_FORMAT_BENCHMARK
+#define MBED_CONF_APP_FAST_FORMAT_BENCHMARK 0
+#endif
+
+// Small formatting kernels for timestamps and status lines
+// Every writer stores bytes straight into the destination and returns the
+// position after the last one written, so calls chain without strlen or a
+// temporary buffer. Nothing is NUL-terminated unless the function says so.
+// Two-digit fields come from a 200-byte pair table: one load and two stores
+// instead of a division, a modulo and the printf format parser.
+
+// "00" "01" ... "99"
+extern const char DIGIT_PAIRS[200];
+
+// Packed BCD to binary without a division: tens * 10 = tens * 16 - tens * 6
+inline uint8_t bcdToBin(uint8_t bcd) {
+    return bcd - 6 * (bcd >> 4);
+}
+
+// Binary (0-99) to packed BCD; (v * 205) >> 11 is v / 10 for v < 1029
+inline uint8_t binToBcd(uint8_t bin) {
+    return bin + 6 * ((bin * 205) >> 11);
+}
+
+// Writes a value 0-99 as two digits
+inline char* fmtTwoDigits(char* p, uint32_t value) {
+    const char* pair = &DIGIT_PAIRS[value * 2];
+    p[0] = pair[0];
+    p[1] = pair[1];
+    return p + 2;
+}
+
+// Writes an unsigned value with no leading zeros (printf "%u")
+// Returns: position after the last digit
+char* fmtUint(char* p, uint32_t value);
+
+// Writes an unsigned value right-aligned in at least width characters
+// (printf "%2u"), padded with spaces
+char* fmtUintPadded(char* p, uint32_t value, int width);
+
+// Copies a string, stopping at its end or at the limit
+// Parameters:
+//   p:     Destination
+//   end:   One past the last byte that may be written
+//   text:  NUL-terminated source
+// Returns: position after the last byte copied
+char* fmtText(char* p, const char* end, const char* text);
+
+// Writes "HH:MM:SS" (8 bytes)
+// Parameters:
+//   secondOfDay: 0-86399
+char* fmtTimeOfDay(char* p, uint32_t secondOfDay);
+
+// Writes "YYYY-MM-DD HH:MM:SS" (19 bytes)
+char* fmtIsoDateTime(char* p, const RtcTime& time);
+
+#if MBED_CONF_APP_FAST_FORMAT_BENCHMARK
+// Times the writers against snprintf and division-based BCD and prints
+// the cost per call on the debug serial port
+void fastFormatBenchmark();
+#endif
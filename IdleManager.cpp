@@ -0,0 +1,100 @@
+#include "IdleManager.h"
+#include "hal/us_ticker_api.h"  // Microsecond timestamps usable from interrupts
+
+// Constructor
+IdleManager::IdleManager() :
+    _pending(0),
+    _signalUs(0)
+{
+    resetStats();
+}
+
+// Flag a wake source - timestamp only the first one so latency covers the
+// oldest unserviced interrupt
+void IdleManager::signal(WakeSource source) {
+    uint32_t stamp = us_ticker_read();
+    if(core_util_atomic_fetch_or_u32(&_pending, 1u << source) == 0) {
+        _signalUs = stamp;
+    }
+#if MBED_CONF_RTOS_PRESENT
+    _flags.set(1u << source);
+#endif
+}
+
+#if !MBED_CONF_RTOS_PRESENT
+// Timed sleep expired
+void IdleManager::onWakeup() {
+    signal(WAKE_TIMER);
+}
+#endif
+
+// Sleep until signalled or timed out
+uint32_t IdleManager::sleep(uint32_t maxMs) {
+    if(maxMs > 0 && core_util_atomic_load_u32(&_pending) == 0) {
+#if MBED_CONF_RTOS_PRESENT
+        // Flags set after the check above are still seen by the wait
+        uint32_t startUs = us_ticker_read();
+        uint32_t result = _flags.wait_any_for((1u << WAKE_COUNT) - 1, std::chrono::milliseconds(maxMs));
+        _asleepUs += us_ticker_read() - startUs;
+        if(result & osFlagsError) {
+            core_util_atomic_fetch_or_u32(&_pending, 1u << WAKE_TIMER);    // Timed out
+        }
+#else
+        _wakeup.attach(callback(this, &IdleManager::onWakeup), std::chrono::milliseconds(maxMs));
+
+        // Interrupts stay masked between the check and the WFI, so a signal
+        // arriving in that gap still ends the sleep instead of being missed
+        uint32_t startUs = us_ticker_read();
+        core_util_critical_section_enter();
+        if(core_util_atomic_load_u32(&_pending) == 0) {
+            ::sleep();
+        }
+        core_util_critical_section_exit();
+        _asleepUs += us_ticker_read() - startUs;
+
+        _wakeup.detach();
+#endif
+    }
+
+    uint32_t now = us_ticker_read();
+    uint32_t woke = core_util_atomic_exchange_u32(&_pending, 0);
+    if(woke == 0) return 0;
+
+    for(int i = 0; i < WAKE_COUNT; i++) {
+        if(woke & (1u << i)) _wakes[i]++;
+    }
+
+    // Timer wakes are scheduled, only interrupts count towards response latency
+    if(woke & ~(1u << WAKE_TIMER)) {
+        uint32_t latency = now - _signalUs;
+        _latencySumUs += latency;
+        _latencyCount++;
+        if(latency > _latencyMaxUs) _latencyMaxUs = latency;
+    }
+    return woke;
+}
+
+// Format and reset the statistics
+void IdleManager::report(char* buf, size_t size) {
+    uint32_t windowUs = us_ticker_read() - _windowStartUs;
+    uint32_t residency = windowUs ? (uint32_t)(_asleepUs * 1000 / windowUs) : 0;    // Tenths of a percent
+    uint32_t avgUs = _latencyCount ? _latencySumUs / _latencyCount : 0;
+
+    snprintf(buf, size, "Idle %lu.%lu%%, wakes T%lu S%lu K%lu R%lu C%lu, latency avg %luus max %luus",
+             (unsigned long)(residency / 10), (unsigned long)(residency % 10),
+             (unsigned long)_wakes[WAKE_TIMER], (unsigned long)_wakes[WAKE_SENSOR],
+             (unsigned long)_wakes[WAKE_KEYPAD], (unsigned long)_wakes[WAKE_RTC],
+             (unsigned long)_wakes[WAKE_SERIAL],
+             (unsigned long)avgUs, (unsigned long)_latencyMaxUs);
+    resetStats();
+}
+
+// Start a new reporting window
+void IdleManager::resetStats() {
+    _windowStartUs = us_ticker_read();
+    _asleepUs = 0;
+    memset(_wakes, 0, sizeof(_wakes));
+    _latencySumUs = 0;
+    _latencyMaxUs = 0;
+    _latencyCount = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+
+// Reasons the panel left idle
+enum WakeSource : uint8_t {
+    WAKE_TIMER,         // Next TimerWheel expiry reached
+    WAKE_SENSOR,        // PIR or door contact edge
+    WAKE_KEYPAD,        // MCP23S17 interrupt - keypad column changed
+    WAKE_RTC,           // DS3231 alarm interrupt
+    WAKE_SERIAL,        // Serial console bytes received
+    WAKE_COUNT
+};
+
+// Low-power idle for the main loop
+// Interrupt handlers call signal(); the main loop calls sleep() with the time
+// until its next timer. The CPU waits in sleep() - the sleep manager picks
+// deep sleep when no active peripheral holds it off - until a signal or the
+// timeout arrives. Timed sleeps use the low power ticker where the target
+// has one. On a target without it, such as the LPC1768, the wake-up timeout
+// and the TimerWheel clock hold the deep sleep lock and idle is plain sleep.
+// Residency and signal-to-loop wake latency are tracked.
+// In the RTOS profile the calling thread blocks on event flags instead and
+// the kernel's idle thread does the actual sleeping.
+class IdleManager {
+public:
+    IdleManager();
+
+    // Flags a wake source; safe to call from interrupt context
+    void signal(WakeSource source);
+
+    // Sleeps until a wake source is signalled or the timeout expires
+    // Parameters:
+    //   maxMs: Longest time to sleep, 0 = only collect pending signals
+    // Returns: bit mask of the WakeSource values signalled (1 << source)
+    uint32_t sleep(uint32_t maxMs);
+
+    // Formats the statistics gathered since the last report and resets them
+    // Parameters:
+    //   buf:  Output buffer
+    //   size: Buffer size
+    void report(char* buf, size_t size);
+
+private:
+    volatile uint32_t _pending;     // Signalled sources, not yet returned by sleep()
+    volatile uint32_t _signalUs;    // us_ticker time of the first pending signal
+#if MBED_CONF_RTOS_PRESENT
+    rtos::EventFlags _flags;        // Wakes the blocked thread
+#else
+#if DEVICE_LPTICKER
+    LowPowerTimeout _wakeup;        // Ends a timed sleep without holding off deep sleep
+#else
+    Timeout _wakeup;                // Ends a timed sleep
+#endif
+#endif
+
+    // Statistics since the last report
+    uint32_t _windowStartUs;        // Start of the reporting window
+    uint64_t _asleepUs;             // Time spent inside sleep()
+    uint32_t _wakes[WAKE_COUNT];    // Wake count per source
+    uint32_t _latencySumUs;         // Sum of interrupt-to-loop latencies
+    uint32_t _latencyMaxUs;         // Worst interrupt-to-loop latency
+    uint32_t _latencyCount;         // Latency samples
+
+#if !MBED_CONF_RTOS_PRESENT
+    void onWakeup();                // Timeout ISR
+#endif
+    void resetStats();              // Starts a new reporting window
+};
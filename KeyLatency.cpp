@@ -0,0 +1,76 @@
+#include "KeyLatency.h"
+#include "hal/us_ticker_api.h"  // Same time base as the keypad scanner
+
+// Constructor - empty histograms
+KeyLatency::KeyLatency() {
+    memset((void*)_buckets, 0, sizeof(_buckets));
+    memset((void*)_count, 0, sizeof(_count));
+    memset((void*)_maxUs, 0, sizeof(_maxUs));
+}
+
+// Add one sample to a stage's histogram
+void KeyLatency::record(LatencyStage stage, uint32_t detectedUs) {
+    uint32_t us = us_ticker_read() - detectedUs;    // Wraps cleanly
+    core_util_atomic_incr_u32(&_buckets[stage][bucketOf(us)], 1);
+    core_util_atomic_incr_u32(&_count[stage], 1);
+    if(us > _maxUs[stage]) _maxUs[stage] = us;
+}
+
+// Walk the cumulative counts up to the requested rank
+uint32_t KeyLatency::percentileUs(LatencyStage stage, int percent) const {
+    uint32_t total = _count[stage];
+    if(total == 0) return 0;
+    uint32_t rank = (total * percent + 99) / 100;   // Nearest-rank, at least 1
+    uint32_t seen = 0;
+    for(int b = 0; b < BUCKETS - 1; b++) {
+        seen += _buckets[stage][b];
+        if(seen >= rank) {
+            uint32_t limit = bucketLimitUs(b);
+            return limit < _maxUs[stage] ? limit : _maxUs[stage];
+        }
+    }
+    return _maxUs[stage];   // Overflow bucket
+}
+
+// Print every stage, then start a new interval
+void KeyLatency::report(char* buf, size_t size, uint32_t dropped) {
+    static const char* const names[LATENCY_STAGE_COUNT] = {"handler", "tone", "echo"};
+    int used = snprintf(buf, size, "Keys %lu, dropped %lu",
+                        (unsigned long)_count[LATENCY_HANDLER], (unsigned long)dropped);
+
+    for(int s = 0; s < LATENCY_STAGE_COUNT && used > 0 && (size_t)used < size; s++) {
+        LatencyStage stage = (LatencyStage)s;
+        used += snprintf(buf + used, size - used, ", %s %lu/%lu/%lu us", names[s],
+                         (unsigned long)percentileUs(stage, 50),
+                         (unsigned long)percentileUs(stage, 95),
+                         (unsigned long)percentileUs(stage, 99));
+    }
+    if(used > 0 && (size_t)used < size) {
+        snprintf(buf + used, size - used, " (p50/p95/p99)");
+    }
+
+    for(int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        for(int b = 0; b < BUCKETS; b++) {
+            core_util_atomic_exchange_u32(&_buckets[s][b], 0);
+        }
+        core_util_atomic_exchange_u32(&_count[s], 0);
+        _maxUs[s] = 0;
+    }
+}
+
+// Bucket 0 holds everything under 256 us; above that each power of two
+// is split into four, so bucket width stays a quarter of its start value
+int KeyLatency::bucketOf(uint32_t us) {
+    if(us < 256) return 0;
+    int msb = 31 - __builtin_clz(us);               // 8 or more
+    int bucket = (msb - 8) * 4 + (int)((us >> (msb - 2)) & 3) + 1;
+    return bucket < BUCKETS - 1 ? bucket : BUCKETS - 1;
+}
+
+// Inverse of bucketOf()
+uint32_t KeyLatency::bucketLimitUs(int bucket) {
+    if(bucket == 0) return 256;
+    int msb = (bucket - 1) / 4 + 8;
+    uint32_t quarter = (bucket - 1) % 4;
+    return (5 + quarter) << (msb - 2);
+}
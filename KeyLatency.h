@@ -0,0 +1,53 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+
+// Points on the key feedback path, each measured from key detection
+enum LatencyStage : uint8_t {
+    LATENCY_HANDLER,        // Key event taken by handleKeypress()
+    LATENCY_TONE,           // Feedback tone started
+    LATENCY_ECHO,           // LCD echo drawn by the display consumer
+    LATENCY_STAGE_COUNT
+};
+
+// Key-to-feedback latency histograms
+// Each stage keeps a log-linear histogram (four buckets per power of two,
+// 256 us to 2 s), so p50/p95/p99 come from a few hundred bytes of counters
+// instead of stored samples. Percentiles are reported as bucket upper
+// bounds - at most 25% high. Each stage may be recorded from one thread
+// while another formats the report.
+class KeyLatency {
+public:
+    static const int BUCKETS = 54;              // 1 below 256 us, 52 log-linear, 1 overflow
+
+    KeyLatency();
+
+    // Records the time from key detection to now
+    // Parameters:
+    //   stage:      Point reached on the feedback path
+    //   detectedUs: us_ticker time the key was confirmed
+    void record(LatencyStage stage, uint32_t detectedUs);
+
+    // Returns: samples recorded for a stage since the last report
+    uint32_t count(LatencyStage stage) const { return _count[stage]; }
+
+    // Returns: upper bound of the given percentile in microseconds, 0 if no samples
+    uint32_t percentileUs(LatencyStage stage, int percent) const;
+
+    // Formats p50/p95/p99 per stage and resets the histograms
+    // Parameters:
+    //   buf:     Output buffer
+    //   size:    Buffer size
+    //   dropped: Key events lost so far (scanner FIFO overflows)
+    void report(char* buf, size_t size, uint32_t dropped);
+
+private:
+    volatile uint32_t _buckets[LATENCY_STAGE_COUNT][BUCKETS];  // Sample counts per bucket
+    volatile uint32_t _count[LATENCY_STAGE_COUNT];             // Samples per stage
+    volatile uint32_t _maxUs[LATENCY_STAGE_COUNT];             // Largest sample per stage
+
+    static int bucketOf(uint32_t us);           // Histogram bucket for a latency
+    static uint32_t bucketLimitUs(int bucket);  // Exclusive upper bound of a bucket
+};
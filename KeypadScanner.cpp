@@ -0,0 +1,114 @@
+#include "KeypadScanner.h"
+
+// Keypad legends, indexed by row * 4 + column
+static const char KEYMAP[16] = {
+    '1', '2', '3', 'A',
+    '4', '5', '6', 'B',
+    '7', '8', '9', 'C',
+    '*', '0', '#', 'D'
+};
+
+// Constructor - idle, no keys down
+KeypadScanner::KeypadScanner(MCP23S17& expander, mbed::Callback<void()> notify) :
+    _expander(expander),
+    _notify(notify),
+    _due(false),
+    _active(false),
+    _state(0),
+    _count0(0),
+    _count1(0),
+    _dropped(0)
+{
+}
+
+// Configure port B for the matrix and idle with every row low
+void KeypadScanner::begin() {
+    MCP23S17::PortConfig unused = { 0xFF, 0x00, 0x00, 0x00 };   // Port A not connected
+    MCP23S17::PortConfig keypad = {
+        0xF0,   // Lower 4 bits output (rows), upper 4 bits input (columns)
+        0xF0,   // Enable pull-ups on column pins
+        0xF0,   // Any column change raises INTB
+        0x00    // Idle with every row low
+    };
+    _expander.begin(unused, keypad);
+    _expander.readPort(MCP23S17::PORT_B);    // Clear any change latched before configuration
+}
+
+// Start the sample clock and take the first sample right away
+void KeypadScanner::wake() {
+    core_util_critical_section_enter();
+    bool started = !_active;
+    if(started) {
+        _active = true;
+        _ticker.attach(callback(this, &KeypadScanner::onTick), std::chrono::milliseconds(SAMPLE_MS));
+    }
+    core_util_critical_section_exit();
+    if(started) onTick();
+}
+
+// Ticker handler - sampling needs the SPI bus, so hand it to thread context
+void KeypadScanner::onTick() {
+    _due = true;
+    if(_notify) _notify();
+}
+
+// Sample all keys and debounce them
+int KeypadScanner::sample() {
+    _due = false;
+    if(!_active) return 0;
+
+    uint16_t raw = readMatrix();
+    uint32_t now = us_ticker_read();
+
+    // 2-bit vertical counters: a key's counter runs while its raw state
+    // differs from the debounced state and toggles it on the fourth sample
+    uint16_t delta = raw ^ _state;
+    _count1 = (_count1 ^ _count0) & delta;
+    _count0 = ~_count0 & delta;
+    uint16_t toggled = delta & ~(_count0 | _count1);
+    _state ^= toggled;
+
+    int queued = 0;
+    for(int k = 0; toggled; k++, toggled >>= 1) {
+        if(toggled & 1) {
+            KeyEvent event = { KEYMAP[k], (bool)(_state & (1u << k)), now };
+            if(_fifo.push(event)) queued++;
+            else _dropped++;
+        }
+    }
+
+    // Everything up and settled - stop sampling until the next INTB edge
+    if(_state == 0 && delta == 0) {
+        park();
+    }
+    return queued;
+}
+
+// Drive each row low in turn and collect the columns that follow it
+uint16_t KeypadScanner::readMatrix() {
+    uint16_t raw = 0;
+    for(int row = 0; row < 4; row++) {
+        _expander.writePort(MCP23S17::PORT_B, ~(1 << row) & 0x0F);   // Latch write only - no read first
+        uint8_t cols = ~(_expander.readPort(MCP23S17::PORT_B) >> 4) & 0x0F;  // Active low
+        raw |= cols << (row * 4);
+    }
+    return raw;
+}
+
+// Return to interrupt-driven idle
+// The ticker is stopped before the rows are parked and INTB is cleared, so a
+// press landing in between either shows in the clearing read or raises a
+// fresh INTB edge that finds the scanner inactive
+void KeypadScanner::park() {
+    core_util_critical_section_enter();
+    _ticker.detach();
+    _active = false;
+    _due = false;
+    core_util_critical_section_exit();
+
+    _expander.writePort(MCP23S17::PORT_B, 0x00);
+    uint8_t cols = (_expander.readPort(MCP23S17::PORT_B) >> 4) & 0x0F;
+    if(cols != 0x0F) {
+        wake();     // Pressed while parking
+    }
+}
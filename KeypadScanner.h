@@ -0,0 +1,78 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "MCP23S17.h"      // Keypad port expander
+#include "SpscQueue.h"     // Lock-free key event FIFO
+
+// Debounced key transition
+struct KeyEvent {
+    char key;               // Keypad legend ('0'-'9', 'A'-'D', '*', '#')
+    bool pressed;           // true = press, false = release
+    uint32_t timestamp;     // us_ticker time of the sample that confirmed it
+};
+
+// Background 4x4 keypad matrix scanner
+// While any key is down or bouncing, a Ticker requests a sample every
+// SAMPLE_MS; each sample reads all 16 keys and runs them through 2-bit
+// vertical counters, so a key changes state after four equal samples in a
+// row. Every transition is queued with its timestamp, so keys pressed
+// together are all reported (rollover) and nothing is lost while the
+// consumer is busy. With every key up the Ticker stops and the rows idle
+// low, so the next press raises INTB and calls wake().
+// Samples touch the SPI bus, so they run in thread context: the Ticker
+// only flags that a sample is due and calls the notify handler.
+class KeypadScanner {
+public:
+    static const uint32_t SAMPLE_MS = 5;          // Sample period while active
+    static const uint32_t FIFO_DEPTH = 16;        // Key events buffered
+
+    // Constructor
+    // Parameters:
+    //   expander: Port expander with rows on GPB0-3 and columns on GPB4-7
+    //   notify:   Called from interrupt context when a sample is due
+    KeypadScanner(MCP23S17& expander, mbed::Callback<void()> notify);
+
+    // Configures the expander and parks the rows
+    void begin();
+
+    // Starts sampling; safe to call from interrupt context (INTB edge)
+    void wake();
+
+    // Reads the matrix once and queues any debounced transitions
+    // Returns: number of key events queued
+    int sample();
+
+    // Takes the oldest key event without waiting
+    // Returns: false if none is queued
+    bool read(KeyEvent& event) { return _fifo.pop(event); }
+
+    // Returns: true if a sample has been requested and not yet taken
+    bool sampleDue() const { return _due; }
+
+    // Returns: true while the Ticker is running
+    bool active() const { return _active; }
+
+    // Returns: debounced key state, bit (row * 4 + column) set while down
+    uint16_t keysDown() const { return _state; }
+
+    // Returns: key events dropped because the FIFO was full
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    MCP23S17& _expander;                        // Keypad port expander
+    mbed::Callback<void()> _notify;             // Sample-due handler
+    Ticker _ticker;                             // Sample clock while active
+    SpscQueue<KeyEvent, FIFO_DEPTH> _fifo;      // Sampler to consumer
+    volatile bool _due;                         // Sample requested
+    volatile bool _active;                      // Ticker running
+    uint16_t _state;                            // Debounced key state
+    uint16_t _count0;                           // Vertical counter bit 0, per key
+    uint16_t _count1;                           // Vertical counter bit 1, per key
+    uint32_t _dropped;                          // FIFO overflows
+
+    void onTick();                              // Ticker handler
+    uint16_t readMatrix();                      // Raw key state, one bit per key
+    void park();                                // Rows low, ticker off, INTB armed
+};
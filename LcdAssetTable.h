@@ -0,0 +1,26 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Generated by tools/mkassets from logo.png alarm_banner.png - do not edit
+// Sectors are on the uLCD's own microSD card, written there with dd.
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+
+// Images on the display's card
+enum LcdAsset {
+    ASSET_LOGO,
+    ASSET_ALARM_BANNER,
+    ASSET_COUNT
+};
+
+// Where an image is and how large it is
+struct LcdAssetInfo {
+    uint32_t sector;        // First sector, holding the raw image header
+    uint16_t width;         // Pixels
+    uint16_t height;        // Pixels
+};
+
+constexpr LcdAssetInfo LCD_ASSETS[ASSET_COUNT] = {
+    { 0, 128, 128 },    // logo.png, 65 sectors
+    { 65, 128, 48 },    // alarm_banner.png, 25 sectors
+};
@@ -0,0 +1,51 @@
+#include "LockoutPolicy.h"
+#include <cstring>
+
+// Constructor - no failures recorded for any source
+LockoutPolicy::LockoutPolicy() {
+    memset(_sources, 0, sizeof(_sources));
+}
+
+// Time left in a source's lockout window
+uint32_t LockoutPolicy::remaining(LockoutSource source, uint64_t now) const {
+    const SourceState& s = _sources[source];
+    return s.lockedUntil > now ? (uint32_t)(s.lockedUntil - now) : 0;    // At most MAX_LOCKOUT_MS
+}
+
+// Record a wrong code and start a lockout once the limit is reached
+bool LockoutPolicy::recordFailure(LockoutSource source, uint64_t now) {
+    SourceState& s = _sources[source];
+
+    // A long quiet period forgives earlier failures and lockouts
+    if(s.failures + s.lockouts > 0 && now - s.lastFailure >= FORGET_MS) {
+        s.failures = 0;
+        s.lockouts = 0;
+    }
+    s.lastFailure = now;
+
+    // Attempts during an active lockout are not validated, so never count them
+    if(remaining(source, now) > 0) return false;
+
+    if(++s.failures < MAX_FAILURES) return false;
+
+    // Limit reached - lock out for an exponentially growing window
+    s.lockedUntil = now + nextWindow(source);
+    s.failures = 0;
+    if(s.lockouts < 31) s.lockouts++;
+    return true;
+}
+
+// Record a valid code
+void LockoutPolicy::recordSuccess(LockoutSource source) {
+    SourceState& s = _sources[source];
+    s.failures = 0;
+    s.lockouts = 0;
+}
+
+// Window for the next lockout: BASE * 2^lockouts, capped
+uint32_t LockoutPolicy::nextWindow(LockoutSource source) const {
+    uint8_t n = _sources[source].lockouts;
+    if(n >= 5) return MAX_LOCKOUT_MS;    // 30s << 5 already exceeds the cap
+    uint32_t window = BASE_LOCKOUT_MS << n;
+    return window < MAX_LOCKOUT_MS ? window : MAX_LOCKOUT_MS;
+}
@@ -0,0 +1,55 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+
+// Code Entry Sources
+// Each source is tracked separately so a guesser on one cannot lock out another
+enum LockoutSource {
+    SOURCE_KEYPAD,      // Physical 4x4 keypad
+    SOURCE_SERIAL,      // USB serial command console
+    SOURCE_COUNT
+};
+
+// Wrong-code lockout policy with exponential backoff
+// Purely bookkeeping: callers pass in the current time and decide how to
+// react, so nothing here ever blocks the main loop
+// Times are the 64-bit kernel millisecond count; a 32-bit count wraps after
+// 49 days and would make an old or never-set window look current again
+class LockoutPolicy {
+public:
+    static const int MAX_FAILURES = 3;              // Wrong codes allowed before a lockout
+    static const uint32_t BASE_LOCKOUT_MS = 30000;  // First lockout window
+    static const uint32_t MAX_LOCKOUT_MS = 900000;  // Backoff cap (15 minutes)
+    static const uint32_t FORGET_MS = 3600000;      // Quiet time that resets the backoff
+
+    LockoutPolicy();
+
+    // Checks whether a source is currently locked out
+    // Parameters:
+    //   source: Code entry source
+    //   now:    Current time in milliseconds
+    // Returns: milliseconds remaining in the lockout, 0 if not locked
+    uint32_t remaining(LockoutSource source, uint64_t now) const;
+
+    // Records a wrong code
+    // Returns: true if this failure started a new lockout (log it once)
+    bool recordFailure(LockoutSource source, uint64_t now);
+
+    // Records a valid code - clears the failure count and backoff
+    void recordSuccess(LockoutSource source);
+
+    // Returns: lockout window that the next lockout of a source would use
+    uint32_t nextWindow(LockoutSource source) const;
+
+private:
+    // Per-source attempt history
+    struct SourceState {
+        uint8_t failures;       // Wrong codes since last success or lockout
+        uint8_t lockouts;       // Consecutive lockouts, drives the backoff exponent
+        uint64_t lastFailure;   // Time of the most recent wrong code
+        uint64_t lockedUntil;   // End of the current lockout window, 0 = never locked
+    };
+
+    SourceState _sources[SOURCE_COUNT];
+};
@@ -0,0 +1,289 @@
+#include "LogExporter.h"
+#include "TimeService.h"   // Line timestamps to Unix seconds
+
+// Decimal digits, or -1 if any is not a digit
+static int parseDigits(const uint8_t* p, int count) {
+    int value = 0;
+    for(int i = 0; i < count; i++) {
+        if(p[i] < '0' || p[i] > '9') return -1;
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// "YYYY-MM-DD HH:MM:SS" as written by logEvent()
+// Returns: Unix seconds, or 0 if the text is not a timestamp
+static uint32_t parseStamp(const uint8_t* p) {
+    int year = parseDigits(p, 4);
+    int month = parseDigits(p + 5, 2);
+    int date = parseDigits(p + 8, 2);
+    int hour = parseDigits(p + 11, 2);
+    int min = parseDigits(p + 14, 2);
+    int sec = parseDigits(p + 17, 2);
+    if(year < 2000 || year > 2099 || month < 0 || date < 0 || hour < 0 || min < 0 || sec < 0) return 0;
+
+    RtcTime time;
+    time.year = (uint8_t)(year - 2000);
+    time.month = (uint8_t)month;
+    time.date = (uint8_t)date;
+    time.hour = (uint8_t)hour;
+    time.min = (uint8_t)min;
+    time.sec = (uint8_t)sec;
+    time.day = 1;
+    return TimeService::toEpoch(time);
+}
+
+// Constructor - idle
+LogExporter::LogExporter(SDCard& sd, SerialConsole& console) :
+    _sd(sd),
+    _console(console),
+    _pending(false),
+    _nextFlags(0),
+    _nextFrom(0),
+    _nextTo(0),
+    _state(IDLE),
+    _flags(0),
+    _to(0),
+    _start(0),
+    _end(EXPORT_OPEN_END),
+    _offset(0),
+    _size(0),
+    _lo(0),
+    _hi(0),
+    _found(0),
+    _target(0),
+    _data(nullptr),
+    _dataLength(0),
+    _dataSent(0),
+    _rawLength(0),
+    _compressed(false)
+{
+}
+
+// The command handler and step() may run in different threads; the
+// request fields are only touched inside a critical section
+void LogExporter::request(uint8_t flags, uint32_t from, uint32_t to) {
+    core_util_critical_section_enter();
+    _nextFlags = flags;
+    _nextFrom = from;
+    _nextTo = to;
+    _pending = true;
+    core_util_critical_section_exit();
+}
+
+// Card reads never wait; only frames wait for the ring
+bool LogExporter::ready() const {
+    switch(_state) {
+        case IDLE:
+            return _pending;
+        case ANNOUNCE:
+        case SEND:
+        case FINISH:
+            return _console.txSpace() >= FRAME_SPACE;
+        default:
+            return true;
+    }
+}
+
+// One piece of work per call
+void LogExporter::step() {
+    if(_pending) begin();
+
+    switch(_state) {
+        case FIND_START:
+        case FIND_END:
+            search();
+            break;
+
+        case ANNOUNCE: {
+            uint8_t end[4];
+            putU32(end, _end);
+            if(sendReply(EXPORT_START, _start, 0, end, sizeof(end))) _state = READ;
+            break;
+        }
+
+        case READ:
+            readBlock();
+            break;
+
+        case SEND:
+            sendParts();
+            break;
+
+        case FINISH:
+            if(sendReply(EXPORT_END, _offset, 0, nullptr, 0)) _state = IDLE;
+            break;
+
+        case IDLE:
+            break;
+    }
+}
+
+// Start over with the newest request
+void LogExporter::begin() {
+    core_util_critical_section_enter();
+    _flags = _nextFlags;
+    uint32_t from = _nextFrom;
+    _to = _nextTo;
+    _pending = false;
+    core_util_critical_section_exit();
+
+    int32_t size = _sd.logSize();
+    if(size < 0) {
+        fail(RESULT_NO_CARD);
+        return;
+    }
+    _size = (uint32_t)size;
+
+    if(_flags & EXPORT_BY_TIME) {
+        _target = from;
+        _lo = 0;
+        _hi = _size;
+        _found = _size;
+        _state = FIND_START;
+    } else {
+        _start = from;
+        _end = _to ? _to : EXPORT_OPEN_END;
+        _offset = _start;
+        _state = ANNOUNCE;
+    }
+}
+
+// Lines are appended in time order, so "the next line starts at or after
+// _target" is false below some byte position and true from there on; each
+// probe halves the range. _found tracks the line the last true probe hit.
+void LogExporter::search() {
+    if(_lo < _hi) {
+        uint32_t mid = _lo + (_hi - _lo) / 2;
+        uint32_t lineStart;
+        uint32_t epoch;
+        int found = probe(mid, lineStart, epoch);
+        if(found < 0) {
+            fail(RESULT_NO_CARD);
+            return;
+        }
+        if(found == 0) {
+            _hi = mid;              // No line starts past mid: true by definition
+            _found = _size;
+        } else if(epoch >= _target) {
+            _hi = mid;
+            _found = lineStart;
+        } else {
+            _lo = lineStart + 1;    // Every position up to the line start finds the same line
+        }
+        if(_lo < _hi) return;
+    }
+
+    if(_state == FIND_START) {
+        _start = _found;
+        _offset = _start;
+        if(_to == 0 || _to == 0xFFFFFFFF) {
+            _end = EXPORT_OPEN_END;
+            _state = ANNOUNCE;
+            return;
+        }
+        _target = _to + 1;      // 'to' is the last second included
+        _lo = _start;
+        _hi = _size;
+        _found = _size;
+        _state = FIND_END;
+    } else {
+        _end = _found;
+        _state = ANNOUNCE;
+    }
+}
+
+// Reads from just before position, so a line starting exactly there is
+// recognised by the newline in front of it
+// Returns: 1 if a line was found, 0 if no complete timestamp follows
+//          position (end of log), -1 if the card could not be read
+int LogExporter::probe(uint32_t position, uint32_t& lineStart, uint32_t& epoch) {
+    uint32_t base = position ? position - 1 : 0;
+    int got = _sd.readLog(base, _block, sizeof(_block));
+    if(got <= 0) return got;
+
+    int i = 0;
+    if(position) {
+        while(i < got && _block[i] != '\n') i++;
+        i++;
+    }
+    if(i + (int)STAMP_LENGTH > got) return 0;
+    lineStart = base + i;
+    epoch = parseStamp(_block + i);
+    return 1;
+}
+
+// One sector-aligned read: the first block may be short to reach a sector
+// boundary, every later one is a whole sector unless the range ends in it
+void LogExporter::readBlock() {
+    if(_end != EXPORT_OPEN_END && _offset >= _end) {
+        _state = FINISH;
+        return;
+    }
+    uint32_t length = EXPORT_BLOCK - _offset % EXPORT_BLOCK;
+    if(_end != EXPORT_OPEN_END && _end - _offset < length) length = _end - _offset;
+
+    int got = _sd.readLog(_offset, _block, length);
+    if(got < 0) {
+        fail(RESULT_NO_CARD);
+        return;
+    }
+    if(got == 0) {
+        _state = FINISH;
+        return;
+    }
+
+    // Compressed only when it actually saves bytes
+    _rawLength = (uint16_t)got;
+    _data = _block;
+    _dataLength = (uint16_t)got;
+    _compressed = false;
+    if(_flags & EXPORT_LZSS) {
+        int packed = _encoder.compress(_block, got, _packed);
+        if(packed < got) {
+            _data = _packed;
+            _dataLength = (uint16_t)packed;
+            _compressed = true;
+        }
+    }
+    _dataSent = 0;
+    _state = SEND;
+    sendParts();
+}
+
+// As many parts as the ring takes now; the rest on a later step
+void LogExporter::sendParts() {
+    while(_dataSent < _dataLength) {
+        uint16_t part = _dataLength - _dataSent;
+        if(part > EXPORT_CHUNK) part = EXPORT_CHUNK;
+        uint8_t kind = EXPORT_DATA;
+        if(_dataSent + part == _dataLength) kind |= EXPORT_PART_LAST;
+        if(_compressed) kind |= EXPORT_PART_LZSS;
+        if(!sendReply(kind, _offset, _rawLength, _data + _dataSent, (uint8_t)part)) return;
+        _dataSent += part;
+    }
+    _offset += _rawLength;
+    _state = READ;
+}
+
+// Builds and queues one reply; nothing is queued (or counted as dropped)
+// unless the whole frame fits
+bool LogExporter::sendReply(uint8_t kind, uint32_t offset, uint16_t size, const uint8_t* data, uint8_t length) {
+    if(_console.txSpace() < FRAME_SPACE) return false;
+    uint8_t reply[CONSOLE_MAX_PAYLOAD];
+    reply[0] = RESULT_OK;
+    reply[1] = kind;
+    putU32(reply + 2, offset);
+    putU16(reply + 6, size);
+    if(length) memcpy(reply + EXPORT_HEADER, data, length);
+    return _console.sendFrame(CMD_EXPORT | CONSOLE_RESPONSE, reply, EXPORT_HEADER + length);
+}
+
+// The host times out and asks again if even this does not fit
+void LogExporter::fail(ConsoleResult result) {
+    uint8_t reply = result;
+    if(_console.txSpace() >= FRAME_SPACE) {
+        _console.sendFrame(CMD_EXPORT | CONSOLE_RESPONSE, &reply, 1);
+    }
+    _state = IDLE;
+}
@@ -0,0 +1,100 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SDCard.h"        // Event log source
+#include "SerialConsole.h" // Reply frames
+#include "Lzss.h"          // Optional block compression
+
+// Streams the event log over the serial console (CMD_EXPORT)
+// The file is read one card sector per block, straight into a sector
+// buffer, and each block goes out as one or more DATA frames. Every step()
+// does at most one card read and only queues frames the transmit ring has
+// room for, so the caller decides how much time export gets: the logger
+// thread runs it after its appends, the baremetal loop once per pass.
+// A time range is found by binary search over the line timestamps, one
+// probe per step(), so even a large log never stalls the caller.
+class LogExporter {
+public:
+    // Constructor
+    // Parameters:
+    //   sd:      Card holding the log
+    //   console: Port the blocks are sent on
+    LogExporter(SDCard& sd, SerialConsole& console);
+
+    // Queues a request from the command handler; replaces any running export
+    // Safe to call from another thread than step()
+    // Parameters:
+    //   flags: EXPORT_LZSS, EXPORT_BY_TIME
+    //   from:  First byte or Unix second
+    //   to:    End byte or last Unix second, 0 = end of file
+    void request(uint8_t flags, uint32_t from, uint32_t to);
+
+    // Does the next bounded piece of work
+    // The caller holds whatever lock guards the card
+    void step();
+
+    // Returns: true while a request is pending or running
+    bool active() const { return _pending || _state != IDLE; }
+
+    // Returns: true if the next step() can make progress without waiting
+    //          for transmit ring space
+    bool ready() const;
+
+private:
+    // Transfer phase
+    enum State : uint8_t {
+        IDLE,           // Nothing to do
+        FIND_START,     // Searching for the first line at or after 'from'
+        FIND_END,       // Searching for the first line after 'to'
+        ANNOUNCE,       // START frame waiting for ring space
+        READ,           // Next block to read
+        SEND,           // Block parts waiting for ring space
+        FINISH          // END frame waiting for ring space
+    };
+
+    static const uint32_t FRAME_SPACE = CONSOLE_MAX_PAYLOAD + CONSOLE_OVERHEAD;   // Ring bytes per frame
+    static const uint32_t MAX_LINE = 512;       // Longest log line (logEvent's buffer)
+    static const uint32_t STAMP_LENGTH = 19;    // "YYYY-MM-DD HH:MM:SS"
+
+    SDCard& _sd;                    // Log source
+    SerialConsole& _console;        // Frame sink
+    LzssEncoder _encoder;           // Block compressor
+
+    // Request handoff from the command handler
+    volatile bool _pending;         // A new request is waiting
+    uint8_t _nextFlags;             // Its flags
+    uint32_t _nextFrom;             // Its start
+    uint32_t _nextTo;               // Its end
+
+    // Running transfer
+    State _state;                   // Phase
+    uint8_t _flags;                 // Request flags
+    uint32_t _to;                   // Requested end (bytes or seconds)
+    uint32_t _start;                // First byte sent
+    uint32_t _end;                  // End byte, EXPORT_OPEN_END = end of file
+    uint32_t _offset;               // Next block's first byte
+    uint32_t _size;                 // Log size when the request started
+    uint32_t _lo;                   // Binary search lower bound (byte position)
+    uint32_t _hi;                   // Binary search upper bound (byte position)
+    uint32_t _found;                // First line at or after _hi
+    uint32_t _target;               // Binary search key (Unix seconds)
+
+    // Current block
+    uint8_t _block[MAX_LINE + STAMP_LENGTH + 1];  // Card data (a sector, or a search probe)
+    uint8_t _packed[lzssMaxOutput(EXPORT_BLOCK)]; // Compressed block
+    const uint8_t* _data;           // Encoded block being sent
+    uint16_t _dataLength;           // Encoded bytes
+    uint16_t _dataSent;             // Encoded bytes already queued
+    uint16_t _rawLength;            // Block bytes before encoding
+    bool _compressed;               // _data is LZSS
+
+    void begin();                   // Takes the pending request
+    void search();                  // One binary search probe
+    void readBlock();               // Reads and encodes the next block
+    void sendParts();               // Queues block parts while they fit
+    bool sendReply(uint8_t kind, uint32_t offset, uint16_t size, const uint8_t* data, uint8_t length);  // One reply frame if it fits
+    void fail(ConsoleResult result);  // Error reply, back to idle
+    int probe(uint32_t position, uint32_t& lineStart, uint32_t& epoch);   // First line at or after position
+};
@@ -0,0 +1,94 @@
+#include "Lzss.h"
+#include <cstring>         // memset
+
+// Hash of the three bytes a match must start with
+static inline int hash3(const uint8_t* p) {
+    return ((p[0] << 4) ^ (p[1] << 2) ^ p[2]) & 0xFF;
+}
+
+// Greedy parse: the longest match among the most recent candidates wins
+int LzssEncoder::compress(const uint8_t* in, int length, uint8_t* out) {
+    if(length <= 0) return 0;
+    memset(_head, 0, sizeof(_head));
+
+    uint8_t* flags = out;
+    uint8_t* p = out + 1;
+    int bit = 0;
+    *flags = 0;
+
+    int pos = 0;
+    while(pos < length) {
+        if(bit == 8) {
+            flags = p++;
+            *flags = 0;
+            bit = 0;
+        }
+
+        int bestLength = 0;
+        int bestDistance = 0;
+        if(pos + LZSS_MIN_MATCH <= length) {
+            int maxLength = length - pos < LZSS_MAX_MATCH ? length - pos : LZSS_MAX_MATCH;
+            int candidate = _head[hash3(in + pos)] - 1;
+            for(int depth = 0; candidate >= 0 && depth < CHAIN_DEPTH; depth++) {
+                int distance = pos - candidate;
+                if(distance > LZSS_WINDOW) break;
+                int matched = 0;
+                while(matched < maxLength && in[candidate + matched] == in[pos + matched]) matched++;
+                if(matched > bestLength) {
+                    bestLength = matched;
+                    bestDistance = distance;
+                    if(matched == maxLength) break;
+                }
+                candidate = _prev[candidate] - 1;
+            }
+        }
+
+        int advance = 1;
+        if(bestLength >= LZSS_MIN_MATCH) {
+            uint16_t token = (uint16_t)(((bestDistance - 1) << 6) | (bestLength - LZSS_MIN_MATCH));
+            *flags |= 1 << bit;
+            *p++ = (uint8_t)(token >> 8);
+            *p++ = (uint8_t)token;
+            advance = bestLength;
+        } else {
+            *p++ = in[pos];
+        }
+        bit++;
+
+        // Every covered position becomes a candidate for later matches
+        for(int end = pos + advance; pos < end; pos++) {
+            if(pos + LZSS_MIN_MATCH <= length) {
+                int h = hash3(in + pos);
+                _prev[pos] = _head[h];
+                _head[h] = (uint16_t)(pos + 1);
+            }
+        }
+    }
+    return (int)(p - out);
+}
+
+// Byte-by-byte copy, so matches may overlap their own output
+int lzssDecompress(const uint8_t* in, int length, uint8_t* out, int capacity) {
+    int ip = 0;
+    int op = 0;
+    while(ip < length) {
+        uint8_t flags = in[ip++];
+        for(int bit = 0; bit < 8 && ip < length; bit++) {
+            if(flags & (1 << bit)) {
+                if(ip + 2 > length) return -1;
+                uint16_t token = (uint16_t)((in[ip] << 8) | in[ip + 1]);
+                ip += 2;
+                int distance = (token >> 6) + 1;
+                int count = (token & 0x3F) + LZSS_MIN_MATCH;
+                if(distance > op || op + count > capacity) return -1;
+                for(int i = 0; i < count; i++, op++) {
+                    out[op] = out[op - distance];
+                }
+            } else {
+                if(op >= capacity) return -1;
+                out[op++] = in[ip++];
+            }
+        }
+    }
+    return op;
+}
@@ -0,0 +1,49 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+
+// LZSS for log export blocks, shared with the host tools
+// Each block is compressed on its own, so a transfer can resume at any
+// block boundary. A flag byte precedes every group of up to 8 items; bit i
+// set means item i is a match. A literal is one byte; a match is two bytes,
+// big-endian: (distance - 1) << 6 | (length - LZSS_MIN_MATCH).
+static const int LZSS_MIN_MATCH = 3;        // Shorter repeats are sent as literals
+static const int LZSS_MAX_MATCH = 66;       // 6-bit length field
+static const int LZSS_WINDOW = 1024;        // 10-bit distance field
+static const int LZSS_MAX_BLOCK = 1024;     // Largest block compress() accepts
+
+// Returns: worst-case compressed size of a block (all literals)
+constexpr int lzssMaxOutput(int length) {
+    return length + (length + 7) / 8;
+}
+
+// Block compressor
+// Matches are found through 3-byte hash chains rebuilt for every block,
+// so the tables are the only state and no block depends on another.
+class LzssEncoder {
+public:
+    // Compresses one block
+    // Parameters:
+    //   in:     Block data
+    //   length: Block length, at most LZSS_MAX_BLOCK
+    //   out:    Destination, at least lzssMaxOutput(length) bytes
+    // Returns: compressed length
+    int compress(const uint8_t* in, int length, uint8_t* out);
+
+private:
+    static const int HASH_SIZE = 256;       // Chain heads
+    static const int CHAIN_DEPTH = 16;      // Candidates tried per position
+
+    uint16_t _head[HASH_SIZE];              // Latest position + 1 per hash, 0 = none
+    uint16_t _prev[LZSS_MAX_BLOCK];         // Previous position + 1 with the same hash
+};
+
+// Expands one block
+// Parameters:
+//   in:       Compressed data
+//   length:   Compressed length
+//   out:      Destination
+//   capacity: Destination size
+// Returns: expanded length, or -1 if the data is corrupt or does not fit
+int lzssDecompress(const uint8_t* in, int length, uint8_t* out, int capacity);
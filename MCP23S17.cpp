@@ -0,0 +1,109 @@
+#include "MCP23S17.h"
+
+// Constructor - chip deselected, shadows at power-on defaults
+MCP23S17::MCP23S17(SPI& spi, PinName cs, uint8_t address) :
+    _spi(spi),
+    _cs(cs, 1),
+    _address((address & 0x07) << 1),
+    _transactions(0)
+{
+    for(int p = 0; p < PORT_COUNT; p++) {
+        _iodir[p] = 0xFF;       // All inputs after power-on
+        _gppu[p] = 0x00;
+        _gpinten[p] = 0x00;
+        _olat[p] = 0x00;
+    }
+}
+
+// Configure both ports with one sequential write
+// The latches land a few microseconds after the direction registers, so
+// new outputs briefly drive the previous latch value
+void MCP23S17::begin(const PortConfig& portA, const PortConfig& portB) {
+    uint8_t iocon = (_address ? IOCON_HAEN : 0x00) & ~IOCON_SEQOP;    // Keep auto-increment
+    uint8_t regs[REGISTER_COUNT];
+    memset(regs, 0, sizeof(regs));                   // No inverted inputs, compare-to-previous interrupts
+
+    regs[IODIRA] = portA.iodir;     regs[IODIRB] = portB.iodir;
+    regs[GPINTENA] = portA.gpinten; regs[GPINTENB] = portB.gpinten;
+    regs[IOCON] = iocon;            regs[IOCON + 1] = iocon;
+    regs[GPPUA] = portA.gppu;       regs[GPPUB] = portB.gppu;
+    regs[GPIOA] = portA.olat;       regs[GPIOB] = portB.olat;    // GPIO writes go to the latches
+    regs[OLATA] = portA.olat;       regs[OLATB] = portB.olat;
+    writeRegisters(IODIRA, regs, REGISTER_COUNT);    // INTF/INTCAP are read-only and ignore the bytes
+
+    _iodir[PORT_A] = portA.iodir;     _iodir[PORT_B] = portB.iodir;
+    _gppu[PORT_A] = portA.gppu;       _gppu[PORT_B] = portB.gppu;
+    _gpinten[PORT_A] = portA.gpinten; _gpinten[PORT_B] = portB.gpinten;
+    _olat[PORT_A] = portA.olat;       _olat[PORT_B] = portB.olat;
+}
+
+// Drive a port's outputs without reading it back
+bool MCP23S17::writePort(Port port, uint8_t value) {
+    if(value == _olat[port]) return false;
+    _olat[port] = value;
+    writeRegisters(OLATA + port, &value, 1);
+    return true;
+}
+
+// Update IODIR from the shadow copy
+void MCP23S17::setDirection(Port port, uint8_t iodir) {
+    if(iodir == _iodir[port]) return;
+    _iodir[port] = iodir;
+    writeRegisters(IODIRA + port, &iodir, 1);
+}
+
+// Update GPPU from the shadow copy
+void MCP23S17::setPullups(Port port, uint8_t gppu) {
+    if(gppu == _gppu[port]) return;
+    _gppu[port] = gppu;
+    writeRegisters(GPPUA + port, &gppu, 1);
+}
+
+// Read one port's pins
+uint8_t MCP23S17::readPort(Port port) {
+    uint8_t value;
+    readRegisters(GPIOA + port, &value, 1);
+    return value;
+}
+
+// Read both ports in one burst
+uint16_t MCP23S17::readPorts() {
+    uint8_t ports[PORT_COUNT];
+    readRegisters(GPIOA, ports, PORT_COUNT);
+    return ports[PORT_A] | (ports[PORT_B] << 8);
+}
+
+// Sequential register write
+void MCP23S17::writeRegisters(uint8_t reg, const uint8_t* data, int count) {
+    select();
+    _spi.write(OPCODE_WRITE | _address);
+    _spi.write(reg);
+    for(int i = 0; i < count; i++) {
+        _spi.write(data[i]);
+    }
+    deselect();
+}
+
+// Sequential register read
+void MCP23S17::readRegisters(uint8_t reg, uint8_t* data, int count) {
+    select();
+    _spi.write(OPCODE_READ | _address);
+    _spi.write(reg);
+    for(int i = 0; i < count; i++) {
+        data[i] = _spi.write(0x00);    // Dummy byte clocks the next register out
+    }
+    deselect();
+}
+
+// Start a transaction
+void MCP23S17::select() {
+    _spi.lock();    // SD card shares the bus
+    _cs = 0;
+    _transactions++;
+}
+
+// End a transaction
+void MCP23S17::deselect() {
+    _cs = 1;
+    _spi.unlock();
+}
@@ -0,0 +1,132 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+
+// MCP23S17 16-bit SPI port expander driver
+// Output, direction, pull-up and interrupt-enable registers are mirrored in
+// shadow copies, so output writes never read the chip first and unchanged
+// writes are skipped. The chip runs with IOCON.SEQOP clear (sequential
+// addressing), so consecutive registers are read or written in one
+// chip-select transaction. Every transaction locks the SPI bus, which is
+// shared with the SD card.
+class MCP23S17 {
+public:
+    // Register addresses (IOCON.BANK = 0, A/B registers interleaved)
+    enum Register : uint8_t {
+        IODIRA   = 0x00,    // I/O direction, 1 = input
+        IODIRB   = 0x01,
+        IPOLA    = 0x02,    // Input polarity
+        IPOLB    = 0x03,
+        GPINTENA = 0x04,    // Interrupt-on-change enable
+        GPINTENB = 0x05,
+        DEFVALA  = 0x06,    // Interrupt compare value
+        DEFVALB  = 0x07,
+        INTCONA  = 0x08,    // Interrupt compare mode
+        INTCONB  = 0x09,
+        IOCON    = 0x0A,    // Configuration (also mirrored at 0x0B)
+        GPPUA    = 0x0C,    // 100k pull-ups
+        GPPUB    = 0x0D,
+        INTFA    = 0x0E,    // Interrupt flags (read-only)
+        INTFB    = 0x0F,
+        INTCAPA  = 0x10,    // Port value captured at interrupt (read-only)
+        INTCAPB  = 0x11,
+        GPIOA    = 0x12,    // Port pins
+        GPIOB    = 0x13,
+        OLATA    = 0x14,    // Output latches
+        OLATB    = 0x15,
+        REGISTER_COUNT
+    };
+
+    // Ports
+    enum Port : uint8_t {
+        PORT_A,
+        PORT_B,
+        PORT_COUNT
+    };
+
+    // Per-port configuration written by begin()
+    struct PortConfig {
+        uint8_t iodir;      // 1 = input
+        uint8_t gppu;       // 1 = pull-up enabled
+        uint8_t gpinten;    // 1 = pin change raises INTA/INTB
+        uint8_t olat;       // Initial output levels
+    };
+
+    // Constructor
+    // Parameters:
+    //   spi:     SPI bus (already formatted for mode 0, up to 10 MHz)
+    //   cs:      Chip select pin
+    //   address: Hardware address A2..A0 (0-7)
+    MCP23S17(SPI& spi, PinName cs, uint8_t address = 0);
+
+    // Configures both ports in a single burst from IODIRA through OLATB
+    // Parameters:
+    //   portA, portB: Direction, pull-up, interrupt and output settings
+    void begin(const PortConfig& portA, const PortConfig& portB);
+
+    // Sets a port's output latch from the shadow copy - no read first
+    // Parameters:
+    //   port:  Port to drive
+    //   value: Output levels (bits of input pins are kept but have no effect)
+    // Returns: false if the value matched the shadow and nothing was sent
+    bool writePort(Port port, uint8_t value);
+
+    // Changes a port's pin directions, skipped if unchanged
+    // Parameters:
+    //   port:  Port to configure
+    //   iodir: 1 = input, 0 = output
+    void setDirection(Port port, uint8_t iodir);
+
+    // Changes a port's pull-ups, skipped if unchanged
+    // Parameters:
+    //   port: Port to configure
+    //   gppu: 1 = pull-up enabled
+    void setPullups(Port port, uint8_t gppu);
+
+    // Returns: current pin levels of one port
+    uint8_t readPort(Port port);
+
+    // Reads GPIOA and GPIOB in one burst
+    // Returns: GPIOA in the low byte, GPIOB in the high byte
+    uint16_t readPorts();
+
+    // Returns: last value written to a port's output latch
+    uint8_t outputs(Port port) const { return _olat[port]; }
+
+    // Writes consecutive registers in one transaction
+    // Parameters:
+    //   reg:   First register
+    //   data:  Values, one per register
+    //   count: Number of registers
+    void writeRegisters(uint8_t reg, const uint8_t* data, int count);
+
+    // Reads consecutive registers in one transaction
+    // Parameters:
+    //   reg:   First register
+    //   data:  Destination, one byte per register
+    //   count: Number of registers
+    void readRegisters(uint8_t reg, uint8_t* data, int count);
+
+    // Returns: SPI transactions issued since construction
+    uint32_t transactions() const { return _transactions; }
+
+private:
+    static const uint8_t OPCODE_WRITE = 0x40;   // Device opcode, R/W bit clear
+    static const uint8_t OPCODE_READ  = 0x41;
+    static const uint8_t IOCON_HAEN   = 0x08;   // Hardware address enable
+    static const uint8_t IOCON_SEQOP  = 0x20;   // Set = sequential addressing off
+
+    SPI& _spi;                      // Shared SPI bus
+    DigitalOut _cs;                 // Chip select, active low
+    uint8_t _address;               // Opcode address bits (A2..A0 << 1)
+    uint8_t _iodir[PORT_COUNT];     // Shadow of IODIRA/IODIRB
+    uint8_t _gppu[PORT_COUNT];      // Shadow of GPPUA/GPPUB
+    uint8_t _gpinten[PORT_COUNT];   // Shadow of GPINTENA/GPINTENB
+    uint8_t _olat[PORT_COUNT];      // Shadow of OLATA/OLATB
+    uint32_t _transactions;         // Chip-select cycles, for bus traffic checks
+
+    void select();                  // Locks the bus and asserts chip select
+    void deselect();                // Releases chip select and the bus
+};
@@ -0,0 +1,38 @@
+#include "MediaAssets.h"
+
+// The display sends each word high byte first and read_word() stores the two
+// bytes as they arrive, so on this little-endian MCU they come back swapped
+static uint16_t mediaWord(uLCD_4DGL& lcd) {
+    uint16_t raw = (uint16_t)lcd.read_word();
+    return (uint16_t)((raw << 8) | (raw >> 8));
+}
+
+// Constructor - nothing is available until mount()
+MediaAssets::MediaAssets(uLCD_4DGL& lcd) :
+    _lcd(lcd),
+    _found(0)
+{
+}
+
+// Checks the raw image header of each asset against the table
+int MediaAssets::mount() {
+    _found = 0;
+    if(!_lcd.media_init()) {
+        printf("LCD media: no card\n");
+        return 0;
+    }
+
+    int count = 0;
+    for(int i = 0; i < ASSET_COUNT; i++) {
+        const LcdAssetInfo& info = LCD_ASSETS[i];
+        _lcd.set_sector_address(info.sector >> 16, info.sector & 0xFFFF);
+        uint16_t width = mediaWord(_lcd);       // Reads advance the address
+        uint16_t height = mediaWord(_lcd);
+        if(width == info.width && height == info.height) {
+            _found |= 1u << i;
+            count++;
+        }
+    }
+    printf("LCD media: %d of %d assets\n", count, ASSET_COUNT);
+    return count;
+}
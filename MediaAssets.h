@@ -0,0 +1,33 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "uLCD_4DGL.h"     // Display driver
+#include "LcdAssetTable.h" // Generated sector table
+
+// Prerendered images on the uLCD's own microSD card
+// tools/mkassets turns PNGs into 4DGL raw images and LcdAssetTable.h; the
+// image file is written to the display's card with dd. Drawing one then
+// takes a sector address and a display_image command, where the same screen
+// built from text and shapes takes dozens. The card is checked once at
+// boot: each asset's raw header must match the table, so a missing card or
+// one written from another build leaves the panel on its text screens.
+class MediaAssets {
+public:
+    MediaAssets(uLCD_4DGL& lcd);
+
+    // Starts the display's card and checks every asset's header
+    // Call from the display consumer, after the LCD has booted
+    // Returns: number of assets found
+    int mount();
+
+    // Returns: true if the asset was found on the card
+    bool available(LcdAsset asset) const { return (_found >> asset) & 1; }
+
+private:
+    static_assert(ASSET_COUNT <= 32, "One bit per asset");
+
+    uLCD_4DGL& _lcd;        // Display
+    uint32_t _found;        // Assets found, bit per LcdAsset
+};
@@ -0,0 +1,84 @@
+#include "PanelCheckpoint.h"
+#include "Checksum.h"      // CRC-32 over the record
+
+#if !defined(TARGET_LPC1768)
+// No battery-backed registers known for this target - keep the record in RAM
+// so the code path still runs; it simply never survives a reset
+static uint32_t fallbackRegisters[5];
+#endif
+
+// Constructor
+PanelCheckpoint::PanelCheckpoint() :
+    _sequence(0)
+{
+}
+
+// Read and validate the stored record
+// Layout: w0 = magic:16 | state:8 | flags:8
+//         w1 = entryDelayRemaining:8 | exitDelayRemaining:8 | sequence:16
+//         w2, w3 = reserved, w4 = CRC-32 of w0-w3
+bool PanelCheckpoint::load(PanelSnapshot& snapshot) {
+    uint32_t words[WORDS];
+    readWords(words);
+
+    if((words[0] >> 16) != MAGIC) return false;
+    if(crc32(words, 4 * sizeof(uint32_t)) != words[4]) return false;
+
+    snapshot.state = (words[0] >> 8) & 0xFF;
+    snapshot.entryDelayActive = words[0] & 0x01;
+    snapshot.alarmCodeEntry = (words[0] >> 1) & 0x01;
+    snapshot.exitDelayActive = (words[0] >> 2) & 0x01;
+    snapshot.entryDelayRemaining = (words[1] >> 24) & 0xFF;
+    snapshot.exitDelayRemaining = (words[1] >> 16) & 0xFF;
+    snapshot.sequence = words[1] & 0xFFFF;
+    _sequence = snapshot.sequence;
+    return true;
+}
+
+// Store a snapshot
+void PanelCheckpoint::save(const PanelSnapshot& snapshot) {
+    uint32_t words[WORDS];
+    _sequence++;
+
+    words[0] = (MAGIC << 16) | ((uint32_t)snapshot.state << 8) |
+               (snapshot.exitDelayActive ? 0x04 : 0) |
+               (snapshot.alarmCodeEntry ? 0x02 : 0) | (snapshot.entryDelayActive ? 0x01 : 0);
+    words[1] = ((uint32_t)snapshot.entryDelayRemaining << 24) |
+               ((uint32_t)snapshot.exitDelayRemaining << 16) | _sequence;
+    words[2] = 0;
+    words[3] = 0;
+    words[4] = crc32(words, 4 * sizeof(uint32_t));
+    writeWords(words);
+}
+
+// Invalidate the record
+void PanelCheckpoint::clear() {
+    uint32_t words[WORDS] = {0, 0, 0, 0, 0};
+    writeWords(words);
+}
+
+// Read the five registers
+void PanelCheckpoint::readWords(uint32_t* words) {
+#if defined(TARGET_LPC1768)
+    words[0] = LPC_RTC->GPREG0;
+    words[1] = LPC_RTC->GPREG1;
+    words[2] = LPC_RTC->GPREG2;
+    words[3] = LPC_RTC->GPREG3;
+    words[4] = LPC_RTC->GPREG4;
+#else
+    memcpy(words, fallbackRegisters, sizeof(fallbackRegisters));
+#endif
+}
+
+// Write the five registers
+void PanelCheckpoint::writeWords(const uint32_t* words) {
+#if defined(TARGET_LPC1768)
+    LPC_RTC->GPREG0 = words[0];
+    LPC_RTC->GPREG1 = words[1];
+    LPC_RTC->GPREG2 = words[2];
+    LPC_RTC->GPREG3 = words[3];
+    LPC_RTC->GPREG4 = words[4];
+#else
+    memcpy(fallbackRegisters, words, sizeof(fallbackRegisters));
+#endif
+}
@@ -0,0 +1,47 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+
+// Panel state captured for a warm restart
+struct PanelSnapshot {
+    uint8_t state;                  // SystemState
+    bool entryDelayActive;          // Entry countdown running
+    bool alarmCodeEntry;            // Disarm code entry during alarm
+    uint8_t entryDelayRemaining;    // Seconds left in entry countdown
+    bool exitDelayActive;           // Exit countdown running
+    uint8_t exitDelayRemaining;     // Seconds left in exit countdown
+    uint16_t sequence;              // Incremented on every save
+};
+
+// Battery-backed panel checkpoint
+// The snapshot lives in the LPC1768 RTC general purpose registers
+// (GPREG0-4, 20 bytes), which survive watchdog resets, brownouts and - with
+// a coin cell on VBAT - full power loss. A CRC-32 guards against garbage
+// after the cell has been removed.
+class PanelCheckpoint {
+public:
+    PanelCheckpoint();
+
+    // Reads the stored snapshot
+    // Parameters:
+    //   snapshot: Receives the stored state
+    // Returns: true if a valid record was found
+    bool load(PanelSnapshot& snapshot);
+
+    // Stores a snapshot (five register writes - cheap enough for every state change)
+    void save(const PanelSnapshot& snapshot);
+
+    // Invalidates the stored snapshot
+    void clear();
+
+private:
+    static const uint32_t MAGIC = 0x5C4E;  // Record marker (upper half of word 0)
+    static const int WORDS = 5;            // Record size in 32-bit registers
+
+    uint16_t _sequence;                    // Sequence number of the last save
+
+    void readWords(uint32_t* words);       // Reads the raw registers
+    void writeWords(const uint32_t* words);  // Writes the raw registers
+};
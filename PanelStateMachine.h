@@ -0,0 +1,237 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Table-driven keypad/panel state machine
+// Every (panel mode, input) pair maps to exactly one (action, next mode) cell.
+// The table is constexpr so the completeness checks at the bottom of this file
+// run at compile time and dispatch is a single indexed load.
+
+#include <cstdint>         // Standard integer types
+
+// Panel Mode Enumeration
+// Finer-grained than SystemState: entry delay and alarm code entry are
+// separate rows because they accept a different set of keys
+enum PanelMode : uint8_t {
+    MODE_DISARMED,      // System inactive
+    MODE_ARMED_HOME,    // Armed, interior motion ignored
+    MODE_ARMED_AWAY,    // Fully armed
+    MODE_ENTRY_DELAY,   // Armed away, door opened, countdown running
+    MODE_EXIT_DELAY,    // Arming away, exit countdown running
+    MODE_ALARM,         // Alarm sounding, waiting for 'C'
+    MODE_ALARM_CODE,    // Alarm sounding, disarm code being entered
+    MODE_COUNT
+};
+
+// Panel Input Enumeration
+// Raw keys are folded into classes; code validation results are fed back
+// into the same table as synthetic inputs
+enum PanelInput : uint8_t {
+    IN_NONE,            // Key not on the keypad
+    IN_DIGIT,           // '0'..'9'
+    IN_ARM_HOME,        // 'A'
+    IN_ARM_AWAY,        // 'B'
+    IN_DISARM,          // 'C'
+    IN_PANIC,           // 'D'
+    IN_BACKSPACE,       // '*'
+    IN_ENTER,           // '#'
+    IN_CODE_OK,         // Valid code, no pending command
+    IN_CODE_OK_HOME,    // Valid code after 'A'
+    IN_CODE_OK_AWAY,    // Valid code after 'B'
+    IN_CODE_OK_DISARM,  // Valid code after 'C'
+    IN_CODE_BAD,        // Invalid code
+    IN_EXIT_DONE,       // Exit countdown reached zero
+    IN_COUNT
+};
+
+// Panel Action Enumeration
+// Side effects executed by SecuritySystem after the mode change is applied
+enum PanelAction : uint8_t {
+    ACT_INVALID,        // Unfilled cell - rejected at compile time
+    ACT_IGNORE,         // Input has no effect in this mode
+    ACT_PROMPT_CODE,    // Start code entry and remember the command key
+    ACT_DIGIT,          // Append digit, redraw full code entry screen
+    ACT_DIGIT_INLINE,   // Append digit, redraw only the masked code line
+    ACT_BACKSPACE,      // Remove last digit, redraw full code entry screen
+    ACT_BACKSPACE_INLINE, // Remove last digit, redraw only the masked code line
+    ACT_BACKSPACE_STATS, // Remove last digit, or show event statistics if there is none
+    ACT_SUBMIT,         // Validate buffer and dispatch IN_CODE_* result
+    ACT_SUBMIT_ZONES,   // Submit the code, or show the zone grid if nothing is entered
+    ACT_PANIC,          // Log panic and start the alarm
+    ACT_ACCEPT,         // Valid code with nothing to do - success tone only
+    ACT_ARMED_HOME,     // Announce and log home arming
+    ACT_ARMED_AWAY,     // Announce and log away arming
+    ACT_DISARMED,       // Announce and log disarm
+    ACT_ENTRY_DISARMED, // Disarm from the entry delay countdown
+    ACT_ALARM_DISARMED, // Disarm from an active alarm
+    ACT_REJECT,         // Wrong code, restore current status screen
+    ACT_ENTRY_REJECT,   // Wrong code during entry or exit delay
+    ACT_ALARM_REJECT,   // Wrong code during alarm, resume siren
+    ACT_EXIT_DELAY,     // Start the exit countdown
+    ACT_EXIT_CANCELLED, // Valid code during the exit countdown
+    ACT_COUNT
+};
+
+// One table cell: what to do and which mode to end up in
+struct PanelTransition {
+    PanelAction action;
+    PanelMode next;
+};
+
+// Maps a keypad character to its input class
+constexpr PanelInput classifyKey(char key) {
+    return (key >= '0' && key <= '9') ? IN_DIGIT :
+           key == 'A' ? IN_ARM_HOME :
+           key == 'B' ? IN_ARM_AWAY :
+           key == 'C' ? IN_DISARM :
+           key == 'D' ? IN_PANIC :
+           key == '*' ? IN_BACKSPACE :
+           key == '#' ? IN_ENTER : IN_NONE;
+}
+
+// Shorthand used only to keep the table readable
+#define PT(act, mode) PanelTransition{ACT_##act, MODE_##mode}
+
+// Transition table indexed by [PanelMode][PanelInput]
+constexpr PanelTransition PANEL_TABLE[MODE_COUNT][IN_COUNT] = {
+    // MODE_DISARMED
+    {   PT(IGNORE, DISARMED),           // IN_NONE
+        PT(DIGIT, DISARMED),            // IN_DIGIT
+        PT(PROMPT_CODE, DISARMED),      // IN_ARM_HOME
+        PT(PROMPT_CODE, DISARMED),      // IN_ARM_AWAY
+        PT(IGNORE, DISARMED),           // IN_DISARM
+        PT(PANIC, ALARM),               // IN_PANIC
+        PT(BACKSPACE_STATS, DISARMED),  // IN_BACKSPACE
+        PT(SUBMIT_ZONES, DISARMED),     // IN_ENTER
+        PT(ACCEPT, DISARMED),           // IN_CODE_OK
+        PT(ARMED_HOME, ARMED_HOME),     // IN_CODE_OK_HOME
+        PT(EXIT_DELAY, EXIT_DELAY),     // IN_CODE_OK_AWAY
+        PT(DISARMED, DISARMED),         // IN_CODE_OK_DISARM
+        PT(REJECT, DISARMED),           // IN_CODE_BAD
+        PT(IGNORE, DISARMED) },         // IN_EXIT_DONE
+    // MODE_ARMED_HOME
+    {   PT(IGNORE, ARMED_HOME),
+        PT(DIGIT, ARMED_HOME),
+        PT(PROMPT_CODE, ARMED_HOME),
+        PT(PROMPT_CODE, ARMED_HOME),
+        PT(PROMPT_CODE, ARMED_HOME),
+        PT(PANIC, ALARM),
+        PT(BACKSPACE, ARMED_HOME),
+        PT(SUBMIT_ZONES, ARMED_HOME),
+        PT(ACCEPT, ARMED_HOME),
+        PT(ARMED_HOME, ARMED_HOME),
+        PT(EXIT_DELAY, EXIT_DELAY),
+        PT(DISARMED, DISARMED),
+        PT(REJECT, ARMED_HOME),
+        PT(IGNORE, ARMED_HOME) },
+    // MODE_ARMED_AWAY
+    {   PT(IGNORE, ARMED_AWAY),
+        PT(DIGIT, ARMED_AWAY),
+        PT(PROMPT_CODE, ARMED_AWAY),
+        PT(PROMPT_CODE, ARMED_AWAY),
+        PT(PROMPT_CODE, ARMED_AWAY),
+        PT(PANIC, ALARM),
+        PT(BACKSPACE, ARMED_AWAY),
+        PT(SUBMIT_ZONES, ARMED_AWAY),
+        PT(ACCEPT, ARMED_AWAY),
+        PT(ARMED_HOME, ARMED_HOME),
+        PT(ARMED_AWAY, ARMED_AWAY),
+        PT(DISARMED, DISARMED),
+        PT(REJECT, ARMED_AWAY),
+        PT(IGNORE, ARMED_AWAY) },
+    // MODE_ENTRY_DELAY - only code entry is accepted, any valid code disarms
+    {   PT(IGNORE, ENTRY_DELAY),
+        PT(DIGIT_INLINE, ENTRY_DELAY),
+        PT(IGNORE, ENTRY_DELAY),
+        PT(IGNORE, ENTRY_DELAY),
+        PT(IGNORE, ENTRY_DELAY),
+        PT(IGNORE, ENTRY_DELAY),
+        PT(BACKSPACE_INLINE, ENTRY_DELAY),
+        PT(SUBMIT, ENTRY_DELAY),
+        PT(ENTRY_DISARMED, DISARMED),
+        PT(ENTRY_DISARMED, DISARMED),
+        PT(ENTRY_DISARMED, DISARMED),
+        PT(ENTRY_DISARMED, DISARMED),
+        PT(ENTRY_REJECT, ENTRY_DELAY),
+        PT(IGNORE, ENTRY_DELAY) },
+    // MODE_EXIT_DELAY - code entry cancels, countdown expiry arms away
+    {   PT(IGNORE, EXIT_DELAY),
+        PT(DIGIT_INLINE, EXIT_DELAY),
+        PT(IGNORE, EXIT_DELAY),
+        PT(IGNORE, EXIT_DELAY),
+        PT(IGNORE, EXIT_DELAY),
+        PT(PANIC, ALARM),
+        PT(BACKSPACE_INLINE, EXIT_DELAY),
+        PT(SUBMIT, EXIT_DELAY),
+        PT(EXIT_CANCELLED, DISARMED),
+        PT(EXIT_CANCELLED, DISARMED),
+        PT(EXIT_CANCELLED, DISARMED),
+        PT(EXIT_CANCELLED, DISARMED),
+        PT(ENTRY_REJECT, EXIT_DELAY),
+        PT(ARMED_AWAY, ARMED_AWAY) },
+    // MODE_ALARM - siren running, only 'C' starts code entry; '#' shows the tripped zones
+    {   PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(PROMPT_CODE, ALARM_CODE),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(SUBMIT_ZONES, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM),
+        PT(IGNORE, ALARM) },
+    // MODE_ALARM_CODE - disarm code being entered while siren continues
+    {   PT(IGNORE, ALARM_CODE),
+        PT(DIGIT, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(BACKSPACE, ALARM_CODE),
+        PT(SUBMIT, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(IGNORE, ALARM_CODE),
+        PT(ALARM_DISARMED, DISARMED),
+        PT(ALARM_REJECT, ALARM),
+        PT(IGNORE, ALARM_CODE) },
+};
+
+#undef PT
+
+// Compile-time validation: every cell filled with a real action and a real mode
+constexpr bool panelTableComplete() {
+    for(int m = 0; m < MODE_COUNT; m++) {
+        for(int i = 0; i < IN_COUNT; i++) {
+            const PanelTransition& t = PANEL_TABLE[m][i];
+            if(t.action == ACT_INVALID || t.action >= ACT_COUNT) return false;
+            if(t.next >= MODE_COUNT) return false;
+        }
+    }
+    return true;
+}
+
+// Compile-time validation: every mode can reach DISARMED through a valid code
+constexpr bool panelTableDisarmable() {
+    for(int m = 0; m < MODE_COUNT; m++) {
+        bool reachable = false;
+        for(int i = IN_CODE_OK; i <= IN_CODE_OK_DISARM; i++) {
+            if(PANEL_TABLE[m][i].next == MODE_DISARMED) reachable = true;
+        }
+        // Alarm siren mode gets there through MODE_ALARM_CODE
+        if(m == MODE_ALARM) reachable = PANEL_TABLE[m][IN_DISARM].next == MODE_ALARM_CODE;
+        if(!reachable) return false;
+    }
+    return true;
+}
+
+static_assert(sizeof(PANEL_TABLE) / sizeof(PANEL_TABLE[0]) == MODE_COUNT,
+              "Panel table must have one row per PanelMode");
+static_assert(panelTableComplete(), "Panel table has an unfilled or out-of-range cell");
+static_assert(panelTableDisarmable(), "Every panel mode must be disarmable with a valid code");
+static_assert(PANEL_TABLE[MODE_EXIT_DELAY][IN_EXIT_DONE].next == MODE_ARMED_AWAY,
+              "Exit countdown expiry must arm away");
+static_assert(classifyKey('#') == IN_ENTER && classifyKey('7') == IN_DIGIT,
+              "Keypad classifier out of sync with the keypad layout");
@@ -0,0 +1,68 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Sensor zones and their delay classes
+// Each zone's delay class decides whether a trip counts while an exit or
+// entry countdown is running. Classes and delay lengths are set in
+// mbed_app.json; the defaults below are only used when building without it.
+
+#include <cstdint>         // Standard integer types
+
+// Zone Delay Classes
+enum ZoneDelay : uint8_t {
+    DELAY_INSTANT,      // Trips immediately, even during exit/entry countdowns
+    DELAY_ENTRY_EXIT,   // Ignored during the exit delay; opening it when armed away starts the entry delay
+    DELAY_FOLLOWER      // Ignored while an exit or entry countdown runs, instant otherwise
+};
+
+// Sensor Zones
+enum PanelZone : uint8_t {
+    ZONE_DOOR,          // Magnetic door contact
+    ZONE_OUTSIDE_MOTION,  // External PIR
+    ZONE_INSIDE_MOTION, // Internal PIR
+    ZONE_WINDOW,        // Ultrasonic window/proximity sensor
+    ZONE_COUNT
+};
+
+// Delay lengths in seconds
+#ifndef MBED_CONF_APP_EXIT_DELAY
+#define MBED_CONF_APP_EXIT_DELAY 45
+#endif
+#ifndef MBED_CONF_APP_ENTRY_DELAY
+#define MBED_CONF_APP_ENTRY_DELAY 30
+#endif
+
+// Zone delay classes
+#ifndef MBED_CONF_APP_DOOR_ZONE_DELAY
+#define MBED_CONF_APP_DOOR_ZONE_DELAY DELAY_ENTRY_EXIT
+#endif
+#ifndef MBED_CONF_APP_OUTSIDE_MOTION_ZONE_DELAY
+#define MBED_CONF_APP_OUTSIDE_MOTION_ZONE_DELAY DELAY_FOLLOWER
+#endif
+#ifndef MBED_CONF_APP_INSIDE_MOTION_ZONE_DELAY
+#define MBED_CONF_APP_INSIDE_MOTION_ZONE_DELAY DELAY_FOLLOWER
+#endif
+#ifndef MBED_CONF_APP_WINDOW_ZONE_DELAY
+#define MBED_CONF_APP_WINDOW_ZONE_DELAY DELAY_FOLLOWER
+#endif
+
+// Per-zone configuration
+struct ZoneConfig {
+    ZoneDelay delay;    // Delay class
+    bool home;          // Also armed in home mode
+    char letter;        // Zone grid tile label
+};
+
+// Zone table indexed by PanelZone
+constexpr ZoneConfig ZONE_TABLE[ZONE_COUNT] = {
+    { MBED_CONF_APP_DOOR_ZONE_DELAY,           true,  'D' },    // ZONE_DOOR - chime only in home mode
+    { MBED_CONF_APP_OUTSIDE_MOTION_ZONE_DELAY, true,  'O' },    // ZONE_OUTSIDE_MOTION
+    { MBED_CONF_APP_INSIDE_MOTION_ZONE_DELAY,  false, 'I' },    // ZONE_INSIDE_MOTION - occupants move inside in home mode
+    { MBED_CONF_APP_WINDOW_ZONE_DELAY,         true,  'W' },    // ZONE_WINDOW - proximity chime in home mode
+};
+
+static_assert(sizeof(ZONE_TABLE) / sizeof(ZONE_TABLE[0]) == ZONE_COUNT,
+              "Zone table must have one entry per PanelZone");
+static_assert(MBED_CONF_APP_EXIT_DELAY >= 0 && MBED_CONF_APP_EXIT_DELAY <= 255,
+              "Exit delay must fit the checkpoint record (0-255 s)");
+static_assert(MBED_CONF_APP_ENTRY_DELAY > 0 && MBED_CONF_APP_ENTRY_DELAY <= 255,
+              "Entry delay must fit the checkpoint record (1-255 s)");
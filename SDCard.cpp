@@ -1,4 +1,13 @@
 #include "SDCard.h"
+#include <cerrno>          // ENOENT from stat
+#include <sys/stat.h>      // File existence check
+
+// True only if the file system says the path does not exist - an I/O or
+// FAT error is not taken as absence
+static bool pathMissing(const char* path) {
+    struct stat st;
+    return stat(path, &st) != 0 && errno == ENOENT;
+}
 
 // Constructor implementation
 SDCard::SDCard(PinName mosi, PinName miso, PinName sck, PinName cs) :
@@ -70,4 +79,105 @@ bool SDCard::writeData(const char* data, uint32_t length) {
     
     // Return true if all bytes were written
     return (written == length);
+}
+
+// Read a whole file into a caller-supplied buffer
+int SDCard::readFile(const char* name, void* buf, uint32_t length) {
+    if(!_mounted) return -1;
+    
+    char path[32];
+    snprintf(path, sizeof(path), "/fs/%s", name);
+    
+    FILE* fp = fopen(path, "rb");
+    if(fp == NULL) {
+        if(!pathMissing(path)) return -1;     // There but unreadable
+        
+        // Power lost between remove and rename in writeFile - use the new copy
+        snprintf(path, sizeof(path), "/fs/%s.tmp", name);
+        fp = fopen(path, "rb");
+        if(fp == NULL) return pathMissing(path) ? FILE_MISSING : -1;
+    }
+    
+    size_t got = fread(buf, 1, length, fp);
+    fclose(fp);
+    return (int)got;
+}
+
+// Read a slice of the events log - the file is opened per call, so the
+// logger can keep appending between slices
+int SDCard::readLog(uint32_t offset, void* buf, uint32_t length) {
+    if(!_mounted) return -1;
+    
+    FILE* fp = fopen("/fs/events.txt", "rb");
+    if(fp == NULL) return -1;
+    
+    size_t got = 0;
+    if(fseek(fp, offset, SEEK_SET) == 0) {
+        got = fread(buf, 1, length, fp);
+    }
+    fclose(fp);
+    return (int)got;
+}
+
+// Size from the directory entry - no data is read
+int32_t SDCard::logSize() {
+    if(!_mounted) return -1;
+    
+    FILE* fp = fopen("/fs/events.txt", "rb");
+    if(fp == NULL) return -1;
+    
+    long size = -1;
+    if(fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+    }
+    fclose(fp);
+    return (int32_t)size;
+}
+
+// Replace a file atomically via a temporary file and rename
+bool SDCard::writeFile(const char* name, const void* data, uint32_t length) {
+    if(!_mounted) return false;
+    
+    char path[32];
+    char tmpPath[32];
+    snprintf(path, sizeof(path), "/fs/%s", name);
+    snprintf(tmpPath, sizeof(tmpPath), "/fs/%s.tmp", name);
+    
+    // Write new contents to the temporary file
+    FILE* fp = fopen(tmpPath, "wb");
+    if(fp == NULL) return false;
+    size_t written = fwrite(data, 1, length, fp);
+    fflush(fp);
+    fclose(fp);
+    if(written != length) {
+        remove(tmpPath);
+        return false;
+    }
+    
+    // FAT rename does not overwrite, so drop the old file first
+    remove(path);
+    return rename(tmpPath, path) == 0;
+}
+
+// Create a file via a temporary file; the rename fails rather than
+// overwrite if the file appeared in the meantime
+bool SDCard::createFile(const char* name, const void* data, uint32_t length) {
+    if(!_mounted) return false;
+    
+    char path[32];
+    char tmpPath[32];
+    snprintf(path, sizeof(path), "/fs/%s", name);
+    snprintf(tmpPath, sizeof(tmpPath), "/fs/%s.tmp", name);
+    if(!pathMissing(path) || !pathMissing(tmpPath)) return false;
+    
+    FILE* fp = fopen(tmpPath, "wb");
+    if(fp == NULL) return false;
+    size_t written = fwrite(data, 1, length, fp);
+    fflush(fp);
+    fclose(fp);
+    if(written != length || rename(tmpPath, path) != 0) {
+        remove(tmpPath);
+        return false;
+    }
+    return true;
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 // Class to manage SD card operations
 class SDCard {
 public:
+    static const int FILE_MISSING = -2;     // readFile(): neither the file nor its temporary copy exists
+
     // Constructor initializes SD card with specified pins
     // Parameters:
     //   mosi: Master Out Slave In pin for SPI
@@ -30,6 +32,48 @@ public:
     // Returns: true if write successful, false otherwise
     bool writeData(const char* data, uint32_t length);
     
+    // Reads a whole file from the SD card
+    // Parameters:
+    //   name:   File name relative to the card root (e.g. "users.dat")
+    //   buf:    Destination buffer
+    //   length: Size of the destination buffer in bytes
+    // Returns: number of bytes read, FILE_MISSING if the card has no such
+    //          file, or -1 if it exists but could not be opened
+    int readFile(const char* name, void* buf, uint32_t length);
+    
+    // Reads part of the event log file
+    // Parameters:
+    //   offset: Byte position to start at
+    //   buf:    Destination buffer
+    //   length: Most bytes to read
+    // Returns: number of bytes read (0 at the end), or -1 if the log could not be opened
+    int readLog(uint32_t offset, void* buf, uint32_t length);
+    
+    // Returns: size of the event log file in bytes, or -1 if it could not be opened
+    int32_t logSize();
+    
+    // Replaces a file on the SD card with new contents
+    // Data is written to a temporary file first and renamed over the old one,
+    // so a power loss mid-write leaves the previous version intact
+    // Parameters:
+    //   name:   File name relative to the card root
+    //   data:   Pointer to the data to write
+    //   length: Length of the data in bytes
+    // Returns: true if the file was fully written, false otherwise
+    bool writeFile(const char* name, const void* data, uint32_t length);
+    
+    // Writes a file that must not exist yet - never replaces one that does
+    // Parameters:
+    //   name:   File name relative to the card root
+    //   data:   Pointer to the data to write
+    //   length: Length of the data in bytes
+    // Returns: true if the file was created, false if it (or its temporary
+    //          copy) already exists or the write failed
+    bool createFile(const char* name, const void* data, uint32_t length);
+    
+    // Returns: true if the filesystem is mounted
+    bool isMounted() const { return _mounted; }
+    
 private:
     SDBlockDevice _bd;        // Block device interface for SD card
     FATFileSystem _fs;        // FAT filesystem interface
@@ -1,45 +1,121 @@
 #include "SecuritySystem.h"
-
-// Define the system security code - code needed to arm/disarm system
-const char SecuritySystem::SECURITY_CODE[] = "2580";
+#include "hal/us_ticker_api.h"  // Microsecond timestamps for thread load accounting
 
 // Constructor - Initializes all hardware components and system variables
 SecuritySystem::SecuritySystem() :
     // Initialize all hardware interfaces with their respective pins
-    lcd(p13, p14, p11),         // uLCD display (TX, RX, RST)
-    buzzer(p21),                // Piezo buzzer
-    ledRed(p22),                // RGB LED components
-    ledGreen(p23),
-    ledBlue(p24),
+    lcd(p13, p14, p11, false),  // uLCD display (TX, RX, RST) - boots in the background
+    annunciator(p21, p22, p23, p24, timers),  // Buzzer and RGB LED
     pirSensor1(p17),            // External motion sensor
     pirSensor2(p16),            // Internal motion sensor
     doorSensor(p18),            // Magnetic door sensor
     trigPin(p19),               // Ultrasonic sensor trigger
     echoPin(p20),               // Ultrasonic sensor echo
     spi(p5, p6, p7),           // SPI bus (MOSI, MISO, SCK)
-    cs(p12),                    // MCP23S17 chip select
-    sdCard(p5, p6, p7, p8),    // SD card interface (shares SPI bus)
-    i2c(p9, p10),              // I2C bus for RTC (SDA, SCL)
+    expander(spi, p12),         // MCP23S17 chip select
+    keypad(expander, callback(this, &SecuritySystem::onKeypadSample)),
+    keyDetectedUs(0),
+    lastEchoKeyUs(0),
+    echoPendingUs(0),
+    keypadIrq(p15),             // MCP23S17 INTB
+    rtcInterrupt(p26),          // DS3231 INT/SQW
+#if MBED_CONF_RTOS_PRESENT
+    keypadThread(osPriorityHigh, KEYPAD_STACK_SIZE, keypadStack, "keypad"),
+    displayThread(osPriorityBelowNormal, DISPLAY_STACK_SIZE, displayStack, "display"),
+    loggerThread(osPriorityLow, LOGGER_STACK_SIZE, loggerStack, "logger"),
+#endif
     // Initialize system state variables
     currentState(DISARMED),
     codeIndex(0),
+    lastUser(UserCodeStore::NO_USER),
     lastCommand(0),
     entryDelayActive(false),
-    entryDelayStart(0),
+    entryDelayRemaining(0),
+    exitDelayActive(false),
+    exitDelayRemaining(0),
+    alarmCodeEntry(false),
+    warmRestart(false),
+    displayReady(false),
+    armableMs(0),
     lastDoorState(false),
-    lastUltrasonicAlert(0)
+    i2c(p9, p10),              // I2C bus for RTC (SDA, SCL)
+    rtc(i2c),
+    timeService(rtc),
+    rtcAlarms(0),
+    rtcEdgeMs(0),
+    display(lcd),
+    clockText(1, 1),
+    statusIcon(121, 7, 4),
+    messageText(1, 4, 17),
+    messageWrap(1, 5, 17),
+    promptText(1, 3, 11),
+    codeField(1, 5),
+    countdownTitle(1, 1, 7),
+    countdown(9, 1, Rect{ COUNTDOWN_BAR_X0, COUNTDOWN_BAR_Y0, COUNTDOWN_BAR_X1, COUNTDOWN_BAR_Y1 }, EXIT_FAST_CHIRP_S),
+    statsPanel(0, 32, 127, 127, callback(this, &SecuritySystem::paintStats)),
+    zoneTitle(1, 3, 5),
+    zoneGrid(1, 4, 4, ZONE_COUNT),
+    media(lcd),
+    logoImage(0, 0, LCD_ASSETS[ASSET_LOGO]),
+    alarmBanner((128 - LCD_ASSETS[ASSET_ALARM_BANNER].width) / 2, ALARM_BANNER_Y, LCD_ASSETS[ASSET_ALARM_BANNER]),
+    alarmCause(1, 6, 17),
+    alarmCauseWrap(1, 7, 17),
+    pendingSchedule(),
+    scheduleArmedHome(false),
+    sdCard(p5, p6, p7, p8),    // SD card interface (shares SPI bus)
+    console(SerialConsole::instance()),
+    exporter(sdCard, console),
+    telemetryPeriodS(0),
+    telemetryDue(false),
+    windowNear(false),
+    trippedZones(0),
+    zoneTiles(0)
 {
+    bootTimer.start();                          // Time-to-armable reference
+
     // Initialize system memory and configuration
     memset(inputCode, 0, sizeof(inputCode));    // Clear security code buffer
+#if MBED_CONF_RTOS_PRESENT
+    memset((void*)taskBusyUs, 0, sizeof(taskBusyUs));  // Clear thread load counters
+#endif
     doorSensor.mode(PullUp);                    // Enable internal pullup for door sensor
+    keypadIrq.mode(PullUp);                     // INTB idles high
+    rtcInterrupt.mode(PullUp);                 // INT/SQW is open drain
     echoPin.mode(PullDown);                     // Configure echo pin with pulldown
     trigPin = 0;                                // Ensure trigger starts LOW
+
+    // Screens, in paint order
+    statusScreen.add(clockText);
+    statusScreen.add(statusIcon);
+    statusScreen.add(messageText);
+    statusScreen.add(messageWrap);
+    codeScreen.add(clockText);
+    codeScreen.add(statusIcon);
+    codeScreen.add(promptText);
+    codeScreen.add(codeField);
+    countdownScreen.add(countdownTitle);
+    countdownScreen.add(countdown);
+    countdownScreen.add(statusIcon);
+    countdownScreen.add(promptText);
+    countdownScreen.add(codeField);
+    statsScreen.add(clockText);
+    statsScreen.add(statsPanel);
+    zoneScreen.add(clockText);
+    zoneScreen.add(statusIcon);
+    zoneScreen.add(zoneTitle);
+    zoneScreen.add(zoneGrid);
+    logoScreen.add(logoImage);
+    alarmScreen.add(clockText);
+    alarmScreen.add(statusIcon);
+    alarmScreen.add(alarmBanner);
+    alarmScreen.add(alarmCause);
+    alarmScreen.add(alarmCauseWrap);
+    zoneTitle.setText("Zones");
     ultrasonicTimer.reset();                    // Reset ultrasonic timer
     
     // Configure SPI interface for keypad controller
     spi.format(8, 0);                          // 8-bit mode, clock polarity 0
     spi.frequency(1000000);                    // Set SPI clock to 1MHz
-    cs = 1;                                    // Deselect MCP23S17
     
     // Set I2C frequency for RTC communication
     i2c.frequency(100000);                     // 100kHz I2C clock
@@ -47,29 +123,546 @@ SecuritySystem::SecuritySystem() :
 
 // Main system initialization
 void SecuritySystem::initialize() {
-    ThisThread::sleep_for(500ms);  // Initial delay for system stabilization
+    // Put the panel back into its pre-reset state before anything slow runs
+    reset_reason_t reason = ResetReason::get();
+    PanelSnapshot snapshot;
+    bool restored = checkpoint.load(snapshot);
+    if(restored) {
+        restoreCheckpoint(snapshot);
+        warmRestart = (reason != RESET_REASON_POWER_ON);
+    }
+
+    // The LCD is still booting (about 3 s after its reset pulse); everything
+    // below runs in that window and the screen is drawn once it is ready
+    timers.begin();                // Start the panel timer service
     
     // Initialize all major system components
-    initializeLCD();     // Setup LCD display
     initializeKeypad();  // Configure keypad interface
     initRTC();          // Initialize real-time clock
-    initMCP();          // Setup MCP23S17 port expander
 
     // Initialize SD card logging
     if (!sdCard.initialize()) {
+        printf("SD Init Failed!\n");  // Shown on the LCD once it is ready
+    } else {
+        publish(EVT_SYSTEM_STARTED, "System Started");  // Log system startup
+    }
+
+    // Load user codes into RAM (provisions the factory master code only when
+    // the card has no users.dat; otherwise codes are refused until it loads)
+    codeStore.load(sdCard);
+
+    // Auto-arm schedule - the DS3231 alarm wakes the panel for the next transition
+    schedule.load(sdCard);
+    programNextSchedule();
+
+    // Event counters carry on from the last checkpoint
+    eventStats.load(sdCard);
+
+    if(restored) {
+        logRestart(snapshot, reason);
+    }
+
+    // Cosmetic self-test only on a cold start - plays while the panel is live
+    updateLED(currentState);
+    if(!warmRestart) {
+        runStartupSequence();  // Run system startup tests
+    }
+    resumeRestoredState();
+    saveCheckpoint();
+
+    // Wake sources for the idle loop
+    pirSensor1.rise(callback(this, &SecuritySystem::onSensorEdge));
+    pirSensor2.rise(callback(this, &SecuritySystem::onSensorEdge));
+    doorSensor.rise(callback(this, &SecuritySystem::onSensorEdge));
+    doorSensor.fall(callback(this, &SecuritySystem::onSensorEdge));
+    keypadIrq.fall(callback(this, &SecuritySystem::onKeypadIrq));
+    rtcInterrupt.fall(callback(this, &SecuritySystem::onRtcAlarm));
+    console.attach(callback(this, &SecuritySystem::onConsoleRx));
+    timers.start(clockTimer, 1000, callback(this, &SecuritySystem::onClockTick), true);
+    timers.start(timeSyncTimer, TimeService::SYNC_INTERVAL_MS, callback(this, &SecuritySystem::onTimeSync), true);
+    onDisciplineDue();     // First sample at the next minute boundary
+    timers.start(idleReportTimer, IDLE_REPORT_MS, callback(this, &SecuritySystem::onIdleReport), true);
+    setTelemetryPeriod(MBED_CONF_APP_TELEMETRY_PERIOD);
+
+    // Recover through a warm restart if the main loop ever stalls
+    Watchdog::get_instance().start(WATCHDOG_TIMEOUT_MS);
+
+    // Keypad and sensors are serviced from here on
+    armableMs = duration_cast<milliseconds>(bootTimer.elapsed_time()).count();
+}
+
+// Finish LCD setup once the screen has booted and report boot timing
+void SecuritySystem::serviceDisplayBoot() {
+    if(!lcd.resetDone()) return;
+    displayReady = true;
+    initializeLCD();
+    media.mount();
+
+    uint32_t displayMs = duration_cast<milliseconds>(bootTimer.elapsed_time()).count();
+    bootTimer.stop();
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Boot: armable %lums, display %lums",
+             (unsigned long)armableMs, (unsigned long)displayMs);
+    printf("%s\n", msg);
+    if(sdCard.isMounted()) logEvent(msg);
+#if MBED_CONF_APP_FAST_FORMAT_BENCHMARK
+    fastFormatBenchmark();
+#endif
+
+    if(!sdCard.isMounted()) {
         showStatus("SD Init Failed!");
-        ThisThread::sleep_for(2s);
+        scheduleStatusRestore(2000);
+    } else if(!warmRestart && media.available(ASSET_LOGO)) {
+        display.show(logoScreen);       // One image; the status follows
+        scheduleStatusRestore(LOGO_SCREEN_MS);
     } else {
-        logEvent("System Started");  // Log system startup
+        redrawScreen();
+    }
+}
+
+// Draw whatever screen belongs to the current state
+void SecuritySystem::redrawScreen() {
+    if(entryDelayActive) showCountdown("Entry", entryDelayRemaining, ENTRY_DELAY_S);
+    else if(exitDelayActive) showCountdown("Exit", exitDelayRemaining, EXIT_DELAY_S);
+    else if(codeIndex > 0) showInputCode();
+    else showState(currentState);
+}
+
+// Store current state in battery-backed registers
+void SecuritySystem::saveCheckpoint() {
+    PanelSnapshot snapshot;
+    snapshot.state = (uint8_t)currentState;
+    snapshot.entryDelayActive = entryDelayActive;
+    snapshot.alarmCodeEntry = alarmCodeEntry;
+    snapshot.entryDelayRemaining = (uint8_t)entryDelayRemaining;
+    snapshot.exitDelayActive = exitDelayActive;
+    snapshot.exitDelayRemaining = (uint8_t)exitDelayRemaining;
+    snapshot.sequence = 0;    // Assigned by PanelCheckpoint
+    checkpoint.save(snapshot);
+}
+
+// Load state variables from a checkpoint snapshot
+void SecuritySystem::restoreCheckpoint(const PanelSnapshot& snapshot) {
+    currentState = snapshot.state <= ALARM ? (SystemState)snapshot.state : DISARMED;
+    entryDelayActive = (currentState == ARMED_AWAY) && snapshot.entryDelayActive;
+    entryDelayRemaining = entryDelayActive ? snapshot.entryDelayRemaining : 0;
+    exitDelayActive = (currentState == ARMED_AWAY) && !entryDelayActive && snapshot.exitDelayActive;
+    exitDelayRemaining = exitDelayActive ? snapshot.exitDelayRemaining : 0;
+    alarmCodeEntry = false;    // Partially entered code is gone - back to siren mode
+}
+
+// Restart whatever was running when the reset hit
+void SecuritySystem::resumeRestoredState() {
+    if(entryDelayActive) {
+        if(entryDelayRemaining < 1) entryDelayRemaining = 1;
+        publish(EVT_ENTRY_COUNTDOWN, nullptr, entryDelayRemaining);
+        timers.start(entryDelayTimer, 1000, callback(this, &SecuritySystem::processEntryDelay), true);
+    } else if(exitDelayActive) {
+        if(exitDelayRemaining < 1) exitDelayRemaining = 1;
+        publish(EVT_EXIT_COUNTDOWN, nullptr, exitDelayRemaining);
+        timers.start(exitDelayTimer, 1000, callback(this, &SecuritySystem::processExitDelay), true);
+    } else if(currentState == ALARM) {
+        publish(EVT_ALARM, "Alarm Resumed After Restart");
     }
+}
+
+// Log the restored checkpoint record
+void SecuritySystem::logRestart(const PanelSnapshot& snapshot, reset_reason_t reason) {
+    const char* cause =
+        reason == RESET_REASON_WATCHDOG  ? "watchdog" :
+        reason == RESET_REASON_BROWN_OUT ? "brownout" :
+        reason == RESET_REASON_PIN_RESET ? "reset pin" :
+        reason == RESET_REASON_SOFTWARE  ? "software" :
+        reason == RESET_REASON_POWER_ON  ? "power on" : "other";
 
-    runStartupSequence();  // Run system startup tests
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%s Restart (%s): %s, entry %us, exit %us, seq %u",
+             warmRestart ? "Warm" : "Cold", cause, statusText(currentState),
+             (unsigned)snapshot.entryDelayRemaining, (unsigned)snapshot.exitDelayRemaining,
+             (unsigned)snapshot.sequence);
+    printf("%s\n", msg);
+    logEvent(msg);    // Direct write - the text is not a static string
 }
 
 // RTC initialization
 void SecuritySystem::initRTC() {
     // Time can be set by uncommenting and modifying this line
     //setTime(10, 51, 17, 3, 4, 12, 23);  // Format: sec, min, hour, day, date, month, year
+
+    // INT/SQW becomes the alarm output; alarms stay off until the schedule is loaded
+    rtc.enableAlarms(0);
+    rtc.takeAlarmFlags();
+    rtc.setAlarm2EveryMinute();
+
+    // Whole-second start for the local clock; the first minute edge refines it
+    if(!timeService.sync()) {
+        printf("RTC read failed\n");
+    }
+}
+
+// Handle a DS3231 alarm - the flags are read once per INT/SQW edge, never polled
+void SecuritySystem::serviceRtcAlarm() {
+    uint8_t fired = rtc.takeAlarmFlags() & rtcAlarms;   // Disabled alarms still set their flags
+
+    // Alarm 2 edge is a minute boundary; one time read says which minute.
+    // A late read (seconds past 30) could be in the next minute - skip it
+    if(fired & DS3231::ALARM_2) {
+        core_util_critical_section_enter();
+        uint64_t edgeMs = rtcEdgeMs;
+        core_util_critical_section_exit();
+
+        RtcTime time;
+        if(rtc.readTime(time) && time.sec < 30) {
+            uint32_t epoch = TimeService::toEpoch(time);
+            if(epoch) timeService.discipline(edgeMs, epoch - time.sec);
+        }
+        rtcAlarms &= ~DS3231::ALARM_2;
+        rtc.enableAlarms(rtcAlarms);
+        timers.start(disciplineTimer, timeService.sampleIntervalMs(), callback(this, &SecuritySystem::onDisciplineDue));
+    }
+
+    if(fired & DS3231::ALARM_1) {
+        runSchedule((ScheduleAction)pendingSchedule.action);
+        programNextSchedule(true);
+    }
+}
+
+// Program Alarm 1 with the first transition after the current time, or
+// after the transition that just fired: before the first discipline edge
+// the local clock may still read the previous second and would pick the
+// same entry again, a week later
+void SecuritySystem::programNextSchedule(bool afterPending) {
+    RtcTime now;
+    if(afterPending && pendingSchedule.action != SCHEDULE_NONE) {
+        now.day = pendingSchedule.day;
+        now.hour = pendingSchedule.hour;
+        now.min = pendingSchedule.minute;
+    } else {
+        TimeService::toCalendar(timeService.now(), now);
+    }
+    if(!schedule.next(now.day, now.hour, now.min, pendingSchedule)) {
+        pendingSchedule.action = SCHEDULE_NONE;
+        rtcAlarms &= ~DS3231::ALARM_1;
+        rtc.enableAlarms(rtcAlarms);
+        return;
+    }
+    rtc.setAlarm1Weekly(pendingSchedule.day, pendingSchedule.hour, pendingSchedule.minute, 0);
+    rtcAlarms |= DS3231::ALARM_1;
+    rtc.enableAlarms(rtcAlarms);
+}
+
+// Scheduled arms only happen while disarmed. A scheduled disarm only ends an
+// arm home that a scheduled arm set and nothing has changed since, so it
+// never disarms away mode, a delay or an alarm; a pending code entry is
+// discarded. The flag is not checkpointed, so after a restart the panel
+// stays armed until someone disarms it
+void SecuritySystem::runSchedule(ScheduleAction action) {
+    switch(action) {
+        case SCHEDULE_ARM_HOME:
+            if(currentState != DISARMED) return;
+            clearCode();
+            publish(EVT_SCHEDULE, "Scheduled Arm - Home");
+            enterMode(MODE_ARMED_HOME);
+            scheduleArmedHome = true;
+            performAction(ACT_ARMED_HOME, 0);
+            break;
+
+        case SCHEDULE_ARM_AWAY:
+            if(currentState != DISARMED) return;
+            clearCode();
+            publish(EVT_SCHEDULE, "Scheduled Arm - Away");
+            enterMode(MODE_EXIT_DELAY);
+            performAction(ACT_EXIT_DELAY, 0);
+            break;
+
+        case SCHEDULE_DISARM:
+            if(currentState != ARMED_HOME || !scheduleArmedHome) return;
+            clearCode();
+            publish(EVT_SCHEDULE, "Scheduled Disarm");
+            enterMode(MODE_DISARMED);
+            performAction(ACT_DISARMED, 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Decode every complete frame received since the last pass
+// Stray response frames (an echo, a second host) are ignored
+void SecuritySystem::serviceConsole() {
+    ConsoleFrame frame;
+    while(console.readFrame(frame)) {
+        if(!(frame.command & CONSOLE_RESPONSE)) handleConsoleCommand(frame);
+    }
+}
+
+// One command, one reply frame - except the export, which streams from
+// the logger's context
+// A reply that does not fit the transmit ring is dropped; the host retries
+void SecuritySystem::handleConsoleCommand(const ConsoleFrame& frame) {
+    uint8_t reply[CONSOLE_MAX_PAYLOAD];
+    uint8_t length = 1;
+    reply[0] = RESULT_OK;
+
+    switch(frame.command) {
+        case CMD_STATUS: {
+            reply[1] = (uint8_t)currentState;
+            reply[2] = (uint8_t)currentMode();
+            reply[3] = (uint8_t)(entryDelayActive ? entryDelayRemaining :
+                                 exitDelayActive ? exitDelayRemaining : 0);
+            putU32(reply + 4, timeService.now());
+            reply[8] = sdCard.isMounted() ? STATUS_FLAG_SD : 0;
+            length = STATUS_LENGTH;
+            break;
+        }
+
+        case CMD_ARM_HOME:
+        case CMD_ARM_AWAY:
+        case CMD_DISARM: {
+            if(frame.length != CONSOLE_CODE_LENGTH) {
+                reply[0] = RESULT_BAD_REQUEST;
+                break;
+            }
+            char code[CONSOLE_CODE_LENGTH + 1];
+            memcpy(code, frame.payload, CONSOLE_CODE_LENGTH);
+            code[CONSOLE_CODE_LENGTH] = '\0';
+            reply[0] = remoteCommand(frame.command, code);
+            memset(code, 0, sizeof(code));
+            break;
+        }
+
+        case CMD_SET_USER:
+            if(frame.length != USER_REQUEST_LENGTH) {
+                reply[0] = RESULT_BAD_REQUEST;
+                break;
+            }
+            reply[0] = remoteSetUser(frame.payload);
+            break;
+
+        case CMD_EXPORT: {
+            const uint8_t* p = frame.payload;
+            if(frame.length != EXPORT_REQUEST_LENGTH || p[0] != EXPORT_FILE_EVENTS ||
+               (p[1] & ~(EXPORT_LZSS | EXPORT_BY_TIME))) {
+                reply[0] = RESULT_BAD_REQUEST;
+            } else if(!sdCard.isMounted()) {
+                reply[0] = RESULT_NO_CARD;
+            } else {
+                exporter.request(p[1], getU32(p + 2), getU32(p + 6));   // Replaces a running export
+#if MBED_CONF_RTOS_PRESENT
+                bus.wake(CONSUMER_LOGGER);
+#endif
+                return;
+            }
+            break;
+        }
+
+        case CMD_STATS: {
+            uint32_t stats[STAT_COUNT];
+            collectStats(stats);
+            uint8_t* p = reply + 1;
+            for(int i = 0; i < STAT_COUNT; i++) {
+                p = putU32(p, stats[i]);
+            }
+            length = p - reply;
+            break;
+        }
+
+        case CMD_TELEMETRY: {
+            if(frame.length == 2) {
+                setTelemetryPeriod(getU16(frame.payload));
+            } else if(frame.length != 0) {
+                reply[0] = RESULT_BAD_REQUEST;
+                break;
+            }
+            telemetry.requestKeyframe();    // A new listener needs the full picture
+            break;
+        }
+
+        default:
+            reply[0] = RESULT_UNKNOWN_COMMAND;
+            break;
+    }
+    console.sendFrame(frame.command | CONSOLE_RESPONSE, reply, length);
+}
+
+// Health counters for CMD_STATS and telemetry
+void SecuritySystem::collectStats(uint32_t* stats) {
+    uint32_t eventsDropped = 0;
+    for(int c = 0; c < CONSUMER_COUNT; c++) {
+        eventsDropped += bus.dropped((EventConsumer)c);
+    }
+    stats[STAT_UPTIME_S] = (uint32_t)(Kernel::get_ms_count() / 1000);
+    stats[STAT_KEYS_DROPPED] = keypad.dropped();
+    stats[STAT_EVENTS_DROPPED] = eventsDropped;
+    stats[STAT_BAD_FRAMES] = console.badFrames();
+    stats[STAT_TX_DROPPED] = console.dropped();
+    stats[STAT_CLOCK_DRIFT_PPB] = (uint32_t)timeService.driftPpb();
+    stats[STAT_CLOCK_ERROR_MS] = timeService.errorMs();
+}
+
+// Period 0 stops the pushes; the next frame after a restart is a keyframe
+void SecuritySystem::setTelemetryPeriod(uint16_t seconds) {
+    telemetryPeriodS = seconds;
+    if(seconds) {
+        timers.start(telemetryTimer, seconds * 1000u, callback(this, &SecuritySystem::onTelemetryDue), true);
+        telemetry.requestKeyframe();
+    } else {
+        timers.cancel(telemetryTimer);
+        telemetryDue = false;
+    }
+}
+
+// Checked every loop pass: state, mode, zone and countdown changes go out
+// at once, health counters with the periodic frame. A frame is encoded
+// only when the ring has room for it, so the encoder's idea of what the
+// station holds never gets ahead of what was sent. PIR release edges do
+// not wake the loop, so a zone clearing shows up within IDLE_MAX_MS.
+void SecuritySystem::serviceTelemetry() {
+    if(!telemetryPeriodS || console.txSpace() < TELEMETRY_MAX_PAYLOAD + CONSOLE_OVERHEAD) return;
+
+    uint32_t stats[STAT_COUNT];
+    collectStats(stats);
+    TelemetrySnapshot now;
+    now.epoch = timeService.now();
+    now.field[TLM_STATE] = currentState;
+    now.field[TLM_MODE] = currentMode();
+    now.field[TLM_ZONES] = (doorSensor.read() << ZONE_DOOR) | (pirSensor1.read() << ZONE_OUTSIDE_MOTION) |
+                           (pirSensor2.read() << ZONE_INSIDE_MOTION) | ((windowNear && zoneArmed(ZONE_WINDOW)) << ZONE_WINDOW);
+    now.field[TLM_COUNTDOWN] = entryDelayActive ? entryDelayRemaining : exitDelayActive ? exitDelayRemaining : 0;
+    now.field[TLM_UPTIME_S] = (int32_t)stats[STAT_UPTIME_S];
+    now.field[TLM_KEYS_DROPPED] = (int32_t)stats[STAT_KEYS_DROPPED];
+    now.field[TLM_EVENTS_DROPPED] = (int32_t)stats[STAT_EVENTS_DROPPED];
+    now.field[TLM_BAD_FRAMES] = (int32_t)stats[STAT_BAD_FRAMES];
+    now.field[TLM_TX_DROPPED] = (int32_t)stats[STAT_TX_DROPPED];
+    now.field[TLM_CLOCK_DRIFT_PPB] = (int32_t)stats[STAT_CLOCK_DRIFT_PPB];
+    now.field[TLM_CLOCK_ERROR_MS] = (int32_t)stats[STAT_CLOCK_ERROR_MS];
+
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    int length = telemetry.encode(now, telemetryDue, payload);
+    telemetryDue = false;
+    if(length) console.sendFrame(TELEMETRY_PUSH, payload, (uint8_t)length);
+}
+
+// Checked every loop pass like telemetry: a zone is faulted if it started
+// the current alarm, bypassed if home mode leaves it unarmed, otherwise
+// active while its sensor sees something. Only a change is published, and
+// the display redraws just the tiles that differ.
+static_assert(ZONE_COUNT * 2 <= 16 && ZONE_COUNT <= ZoneGrid::MAX_TILES,
+              "Zone tiles must fit zoneTiles and the zone grid");
+void SecuritySystem::serviceZones() {
+    uint8_t active = (doorSensor.read() << ZONE_DOOR) | (pirSensor1.read() << ZONE_OUTSIDE_MOTION) |
+                     (pirSensor2.read() << ZONE_INSIDE_MOTION) | ((windowNear && zoneArmed(ZONE_WINDOW)) << ZONE_WINDOW);
+    uint16_t tiles = 0;
+    for(int z = 0; z < ZONE_COUNT; z++) {
+        ZoneGrid::TileState tile =
+            (trippedZones & (1u << z)) ? ZoneGrid::TILE_FAULT :
+            (currentState == ARMED_HOME && !ZONE_TABLE[z].home) ? ZoneGrid::TILE_BYPASSED :
+            (active & (1u << z)) ? ZoneGrid::TILE_ACTIVE : ZoneGrid::TILE_QUIET;
+        tiles |= tile << (z * 2);
+    }
+    if(tiles != zoneTiles) {
+        zoneTiles = tiles;
+        requestScreen(SCREEN_ZONE_TILES);
+    }
+}
+
+// Telemetry period elapsed - the frame is built in the main loop
+void SecuritySystem::onTelemetryDue() {
+    telemetryDue = true;
+}
+
+// Serial user management - adds, changes or removes one slot
+// The request carries a master code, checked with the serial lockout. The
+// last master can be neither removed nor demoted. The change is saved at
+// once; if the card write fails it still holds until the next restart.
+ConsoleResult SecuritySystem::remoteSetUser(const uint8_t* request) {
+    uint64_t now = Kernel::get_ms_count();
+    if(!codeStore.available()) return RESULT_REFUSED;       // No user database loaded
+    if(lockout.remaining(SOURCE_SERIAL, now)) return RESULT_LOCKED_OUT;
+
+    char code[CONSOLE_CODE_LENGTH + 1];
+    memcpy(code, request, CONSOLE_CODE_LENGTH);
+    code[CONSOLE_CODE_LENGTH] = '\0';
+    int admin = codeStore.lookup(code);
+    if(!(codeStore.permissions(admin) & PERM_MASTER)) {
+        memset(code, 0, sizeof(code));
+        if(lockout.recordFailure(SOURCE_SERIAL, now)) {
+            publish(EVT_REMOTE, "Serial Console Locked Out");
+        }
+        return RESULT_BAD_CODE;
+    }
+    lockout.recordSuccess(SOURCE_SERIAL);
+
+    int slot = request[CONSOLE_CODE_LENGTH];
+    uint8_t perms = request[CONSOLE_CODE_LENGTH + 1];
+    const uint8_t ALL = PERM_ARM | PERM_DISARM | PERM_DURESS | PERM_MASTER;
+    if(slot >= UserCodeStore::MAX_USERS || (perms & ~ALL)) return RESULT_BAD_REQUEST;
+    if((codeStore.permissions(slot) & PERM_MASTER) && !(perms & PERM_MASTER) &&
+       codeStore.userCount(PERM_MASTER) == 1) {
+        return RESULT_REFUSED;      // Would lock every master out
+    }
+
+    bool changed;
+    if(perms == 0) {
+        changed = codeStore.removeUser(slot);
+    } else {
+        memcpy(code, request + CONSOLE_CODE_LENGTH + 2, CONSOLE_CODE_LENGTH);
+        for(int i = 0; i < CONSOLE_CODE_LENGTH; i++) {
+            if(code[i] < '0' || code[i] > '9') {
+                memset(code, 0, sizeof(code));
+                return RESULT_BAD_REQUEST;
+            }
+        }
+        changed = codeStore.setUser(slot, code, perms);    // Refused if another slot has the code
+    }
+    memset(code, 0, sizeof(code));
+    if(!changed) return RESULT_REFUSED;
+
+#if MBED_CONF_RTOS_PRESENT
+    logMutex.lock();        // The logger thread owns the card
+#endif
+    bool saved = codeStore.save(sdCard);
+#if MBED_CONF_RTOS_PRESENT
+    logMutex.unlock();
+#endif
+    publish(EVT_REMOTE, perms ? "Serial User Changed" : "Serial User Removed");
+    return saved ? RESULT_OK : RESULT_NO_CARD;
+}
+
+// Serial arm/disarm - the same code check as the keypad with its own
+// lockout, then the transition the keypad would take after A, B or C
+ConsoleResult SecuritySystem::remoteCommand(uint8_t command, const char* code) {
+    uint64_t now = Kernel::get_ms_count();
+    if(!codeStore.available()) return RESULT_REFUSED;      // No user database loaded
+    if(lockout.remaining(SOURCE_SERIAL, now)) return RESULT_LOCKED_OUT;
+
+    if(!validateCode(code, command == CMD_DISARM ? PERM_DISARM : PERM_ARM)) {
+        if(lockout.recordFailure(SOURCE_SERIAL, now)) {
+            publish(EVT_REMOTE, "Serial Console Locked Out");   // Log only - the keypad is not affected
+        }
+        return RESULT_BAD_CODE;
+    }
+    lockout.recordSuccess(SOURCE_SERIAL);
+    if(codeStore.permissions(lastUser) & PERM_DURESS) {
+        publish(EVT_DURESS, "Duress Code Used");
+    }
+
+    // Arming never ends a countdown or an alarm; disarming works from any armed mode
+    PanelMode mode = currentMode();
+    if(command == CMD_DISARM) {
+        if(mode == MODE_DISARMED) return RESULT_REFUSED;
+        clearCode();
+        publish(EVT_REMOTE, "Serial Disarm");
+        if(mode == MODE_ALARM) enterMode(MODE_ALARM_CODE);     // As if 'C' had been pressed
+        dispatch(IN_CODE_OK_DISARM, 0);
+    } else {
+        if(mode != MODE_DISARMED && mode != MODE_ARMED_HOME && mode != MODE_ARMED_AWAY) return RESULT_REFUSED;
+        clearCode();
+        publish(EVT_REMOTE, command == CMD_ARM_HOME ? "Serial Arm - Home" : "Serial Arm - Away");
+        dispatch(command == CMD_ARM_HOME ? IN_CODE_OK_HOME : IN_CODE_OK_AWAY, 0);
+    }
+    return RESULT_OK;
 }
 
 // LCD display initialization
@@ -80,425 +673,611 @@ void SecuritySystem::initializeLCD() {
     lcd.color(WHITE);                   // Set text color
     lcd.text_width(1);                  // Set text width
     lcd.text_height(2);                 // Set text height
+    display.invalidateAll();            // Screen content is gone
 }
 
-// Keypad initialization - placeholder for any future keypad setup
+// Keypad initialization - MCP23S17 rows parked, scanner idle until INTB
 void SecuritySystem::initializeKeypad() {
+    keypad.begin();
 }
 
-// System startup test sequence
+// LED and buzzer self-test played at startup
+static const ToneStep SELF_TEST[] = {
+    {   0, 200, 100,   0,   0 },    // Red
+    {   0, 200,   0, 100,   0 },    // Green
+    {   0, 200,   0,   0, 100 },    // Blue
+    { 440, 100,   0,   0,   0 },    // Lower pitch
+    {   0, 100,   0,   0,   0 },
+    { 880, 100,   0,   0,   0 },    // Higher pitch
+    {   0, 500,   0,   0,   0 }
+};
+
+// Alarm siren - loops until disarmed
+static const ToneStep SIREN[] = {
+    { 1760, 100, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP },
+    {    0, 100,   0, Annunciator::LED_KEEP, Annunciator::LED_KEEP }
+};
+
+// Door opened while armed home - three blue flashes with chirps
+static const ToneStep DOOR_CHIME[] = {
+    { 880, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    { 880, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    { 880, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 200, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 }
+};
+
+// Ultrasonic proximity warning - two short blue flashes
+static const ToneStep PROXIMITY_CHIME[] = {
+    { 880,  50, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    { 880,  50, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    {   0, 100, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 }
+};
+
+// Exit delay chirp - once per second
+static const ToneStep EXIT_CHIRP[] = {
+    { 2000, 40, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    {    0, 10, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 }
+};
+
+// Last seconds of the exit delay - double chirp
+static const ToneStep EXIT_CHIRP_FAST[] = {
+    { 2000, 40, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    {    0, 80, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 },
+    { 2000, 40, Annunciator::LED_KEEP, Annunciator::LED_KEEP, 70 },
+    {    0, 10, Annunciator::LED_KEEP, Annunciator::LED_KEEP,  0 }
+};
+
+#define PATTERN(p) p, (int)(sizeof(p) / sizeof(p[0]))
+
+// System startup test sequence - LED and buzzer check, runs in the background
 void SecuritySystem::runStartupSequence() {
-    showStatus((const char*)"Starting...");
-    
-    // Test RGB LED components
-    ledRed = 1.0;   ThisThread::sleep_for(200ms); ledRed = 0.0;
-    ledGreen = 1.0; ThisThread::sleep_for(200ms); ledGreen = 0.0;
-    ledBlue = 1.0;  ThisThread::sleep_for(200ms); ledBlue = 0.0;
-    
-    // Test buzzer with two tones
-    playTone(440.0, 0.1);  // Lower pitch
-    ThisThread::sleep_for(100ms);
-    playTone(880.0, 0.1);  // Higher pitch
-    
-    // Complete startup sequence
-    ThisThread::sleep_for(500ms);
-    showStatus((const char*)"Ready");
-    ThisThread::sleep_for(1s);
-    updateLED(DISARMED);    // Set initial LED state
-    showStatus((const char*)"DISARMED");
+    annunciator.play(PATTERN(SELF_TEST));
 }
 
 // Main system operation loop
+// Each pass handles whatever woke it, then sleeps until the next interrupt or
+// timer expiry instead of polling at a fixed rate. In the RTOS profile this
+// loop is the alarm thread and the LCD and SD card consumers get their own
+// lower-priority threads; on baremetal it drains them itself.
 void SecuritySystem::run() {
-    static uint32_t lastTimeUpdate = 0;  // Track last time display update
-    
+#if MBED_CONF_RTOS_PRESENT
+    osThreadSetPriority(ThisThread::get_id(), osPriorityAboveNormal);
+    keypadThread.start(callback(this, &SecuritySystem::keypadTask));
+    displayThread.start(callback(this, &SecuritySystem::displayTask));
+    loggerThread.start(callback(this, &SecuritySystem::loggerTask));
+#endif
+    uint32_t woke = 0;    // WakeSource bits from the last sleep
+
     while(1) {
-        // Check keypad for input
-        char key = scanKeypad();
-        if(key) {
-            handleKeypress(key);
+#if MBED_CONF_RTOS_PRESENT
+        uint32_t startUs = us_ticker_read();
+#else
+        // Draw the first screen as soon as the LCD has booted
+        if(!displayReady) {
+            serviceDisplayBoot();
         }
+#endif
+
+#if !MBED_CONF_RTOS_PRESENT
+        // Take the keypad sample the scanner's Ticker asked for
+        if(keypad.sampleDue()) {
+            keypad.sample();
+        }
+#endif
+        // Catch an INTB edge that arrived before the handler was attached
+        if(keypadIrq.read() == 0 && !keypad.active()) {
+            keypad.wake();
+        }
+
+        // Handle every key pressed since the last pass, in order
+        KeyEvent keyEvent;
+        while(keypad.read(keyEvent)) {
+            if(keyEvent.pressed) {
+                keyLatency.record(LATENCY_HANDLER, keyEvent.timestamp);
+                keyDetectedUs = keyEvent.timestamp;     // Tags the events this key publishes
+                handleKeypress(keyEvent.key);
+                keyDetectedUs = 0;
+            }
+        }
+
+        // Run every timeout that expired since the last pass
+        timers.service();
 
         // Monitor sensors if system is armed
         if(currentState != DISARMED && currentState != ALARM) {
             checkSensors();
         }
-        
-        // Update time display every second
-        uint32_t currentTime = Kernel::get_ms_count();
-        if(currentTime - lastTimeUpdate >= 1000) {
-            lcd.locate(1,1);
-            lcd.puts(getTimeStr());
-            lastTimeUpdate = currentTime;
+        serviceZones();
+
+        // Scheduled transition due - INT/SQW stays low until the flag is cleared
+        if((woke & (1u << WAKE_RTC)) || rtcInterrupt.read() == 0) {
+            serviceRtcAlarm();
         }
 
-        ThisThread::sleep_for(50ms);  // Prevent CPU overload
+        // Remote commands run here, between keypad and sensor passes
+        serviceConsole();
+        serviceTelemetry();
+
+        // Let each consumer work through its events at its own pace:
+        // buzzer/LED changes are cheap and display events only update
+        // widgets - the LCD is drawn once for all of them - while an SD
+        // append can take much longer, so the logger gets a small budget
+        bus.drain(CONSUMER_ANNUNCIATOR, EventBus::QUEUE_DEPTH, callback(this, &SecuritySystem::onAnnunciatorEvent));
+#if MBED_CONF_RTOS_PRESENT
+        addBusyTime(TASK_ALARM, startUs);
+#else
+        bus.drain(CONSUMER_DISPLAY, EventBus::QUEUE_DEPTH, callback(this, &SecuritySystem::onDisplayEvent));
+        renderDisplay();
+        bus.drain(CONSUMER_LOGGER, 1, callback(this, &SecuritySystem::onLogEvent));
+        exporter.step();
+        serviceStats();
+#endif
+
+        Watchdog::get_instance().kick();  // Main loop is alive
+        woke = idle.sleep(idleBudget());  // Sleep until there is work
     }
 }
 
+#if MBED_CONF_RTOS_PRESENT
+// Keypad thread - samples the matrix whenever the scanner's Ticker fires
+// Runs above the alarm thread, so a long pass there never delays a sample
+void SecuritySystem::keypadTask() {
+    while(1) {
+        keypadSampleDue.wait_any(1);
+        uint32_t startUs = us_ticker_read();
+        if(keypad.sample() > 0) {
+            idle.signal(WAKE_KEYPAD);   // Key events for the alarm thread
+        }
+        addBusyTime(TASK_KEYPAD, startUs);
+    }
+}
+
+// Display thread - owns the LCD from boot onwards
+void SecuritySystem::displayTask() {
+    while(1) {
+        bus.wait(CONSUMER_DISPLAY, displayReady ? IDLE_MAX_MS : IDLE_BOOT_POLL_MS);
+        uint32_t startUs = us_ticker_read();
+        if(!displayReady) {
+            serviceDisplayBoot();
+        }
+        bus.drain(CONSUMER_DISPLAY, EventBus::QUEUE_DEPTH, callback(this, &SecuritySystem::onDisplayEvent));
+        renderDisplay();
+        addBusyTime(TASK_DISPLAY, startUs);
+    }
+}
+
+// Logger thread - owns the SD card: appends first, then one export step
+// An export only ever gets the time left at the lowest priority
+void SecuritySystem::loggerTask() {
+    while(1) {
+        bus.wait(CONSUMER_LOGGER, exporter.ready() ? 0 : exporter.active() ? CONSOLE_POLL_MS : IDLE_MAX_MS);
+        uint32_t startUs = us_ticker_read();
+        bus.drain(CONSUMER_LOGGER, EventBus::QUEUE_DEPTH, callback(this, &SecuritySystem::onLogEvent));
+        logMutex.lock();    // logEvent() may also run on the display thread
+        if(exporter.active()) {
+            exporter.step();
+        }
+        serviceStats();
+        logMutex.unlock();
+        addBusyTime(TASK_LOGGER, startUs);
+    }
+}
+
+// Add the time since startUs to a thread's busy counter
+void SecuritySystem::addBusyTime(PanelTask task, uint32_t startUs) {
+    core_util_atomic_incr_u32(&taskBusyUs[task], us_ticker_read() - startUs);
+}
+#endif
+
+// Time the loop may sleep - up to the next timer, never past queued work
+uint32_t SecuritySystem::idleBudget() {
+#if MBED_CONF_RTOS_PRESENT
+    if(bus.pending(CONSUMER_ANNUNCIATOR)) return 0;    // Other queues have their own threads
+#else
+    for(int c = 0; c < CONSUMER_COUNT; c++) {
+        if(bus.pending((EventConsumer)c)) return 0;
+    }
+#endif
+#if !MBED_CONF_RTOS_PRESENT
+    if(exporter.active()) {
+        // Next export step as soon as it can make progress
+        if(exporter.ready()) return 0;
+        if(timers.msUntilNext() > CONSOLE_POLL_MS) return CONSOLE_POLL_MS;
+    }
+#endif
+    uint32_t budget = timers.msUntilNext();
+#if !MBED_CONF_RTOS_PRESENT
+    if(!displayReady && budget > IDLE_BOOT_POLL_MS) budget = IDLE_BOOT_POLL_MS;
+#endif
+    return budget < IDLE_MAX_MS ? budget : IDLE_MAX_MS;
+}
+
+// PIR or door contact edge
+void SecuritySystem::onSensorEdge() {
+    idle.signal(WAKE_SENSOR);
+}
+
+// Keypad column changed - start sampling
+void SecuritySystem::onKeypadIrq() {
+    keypad.wake();
+}
+
+// Keypad sample due - the SPI reads happen in thread context
+void SecuritySystem::onKeypadSample() {
+#if MBED_CONF_RTOS_PRESENT
+    keypadSampleDue.set(1);
+#else
+    idle.signal(WAKE_KEYPAD);
+#endif
+}
+
+// DS3231 alarm matched - the edge time is the clock discipline sample
+void SecuritySystem::onRtcAlarm() {
+    rtcEdgeMs = Kernel::get_ms_count();
+    idle.signal(WAKE_RTC);
+}
+
+// Serial console bytes arrived - frames are decoded in the main loop
+void SecuritySystem::onConsoleRx() {
+    idle.signal(WAKE_SERIAL);
+}
+
+// Print idle residency and wake latency for the last interval
+void SecuritySystem::onIdleReport() {
+    char msg[96];
+    idle.report(msg, sizeof(msg));
+    printf("%s\n", msg);
+
+    // Key feedback latency over the same interval
+    char keys[160];
+    keyLatency.report(keys, sizeof(keys), keypad.dropped());
+    printf("%s\n", keys);
+
+    // Clock discipline state
+    char clock[96];
+    timeService.report(clock, sizeof(clock));
+    printf("%s\n", clock);
+
+#if MBED_CONF_RTOS_PRESENT
+    // CPU share of each thread over the same interval, in tenths of a percent
+    static const char* const names[TASK_COUNT] = {"keypad", "alarm", "display", "logger"};
+    printf("CPU");
+    for(int t = 0; t < TASK_COUNT; t++) {
+        uint32_t busyUs = core_util_atomic_exchange_u32(&taskBusyUs[t], 0);
+        uint32_t perMille = (uint32_t)((uint64_t)busyUs * 1000 / (IDLE_REPORT_MS * 1000ULL));
+        printf("%s %s %lu.%lu%%", t ? "," : "", names[t],
+               (unsigned long)(perMille / 10), (unsigned long)(perMille % 10));
+    }
+    printf("\n");
+#endif
+}
+
+// Refresh the time display every second
+void SecuritySystem::onClockTick() {
+    requestScreen(SCREEN_CLOCK);
+}
+
 // Sets the time in the DS3231 RTC
 // Parameters represent each time component in standard format
 void SecuritySystem::setTime(int sec, int min, int hour, int day, int date, int month, int year) {
-    char data[8];
-    data[0] = DS3231_REG_TIME;          // First byte is the register address
-    data[1] = decToBcd(sec) & 0x7F;     // Seconds (clear CH bit)
-    data[2] = decToBcd(min) & 0x7F;     // Minutes
-    data[3] = decToBcd(hour) & 0x3F;    // Hours (24hr mode)
-    data[4] = decToBcd(day) & 0x07;     // Day of week (1-7)
-    data[5] = decToBcd(date) & 0x3F;    // Date (1-31)
-    data[6] = decToBcd(month) & 0x1F;   // Month (1-12)
-    data[7] = decToBcd(year);           // Year (00-99)
-    
-    // Write time data to RTC via I2C
-    i2c.write((DS3231_ADDRESS << 1), data, 8);
-}
-
-// Reads the current time from the DS3231 RTC
-// Parameters are passed by reference to return all time components
-void SecuritySystem::getTime(int &sec, int &min, int &hour, int &day, int &date, int &month, int &year) {
-    char reg = DS3231_REG_TIME;    // Register address to start reading from
-    char data[7];                  // Buffer for time data
-    
-    // Read time data from RTC using repeated start I2C operation
-    i2c.write((DS3231_ADDRESS << 1), &reg, 1, true);  // Send register address
-    i2c.read((DS3231_ADDRESS << 1), data, 7);         // Read time data
-    
-    // Convert BCD values to decimal and store in reference parameters
-    sec = bcdToDec(data[0] & 0x7F);
-    min = bcdToDec(data[1] & 0x7F);
-    hour = bcdToDec(data[2] & 0x3F);
-    day = bcdToDec(data[3] & 0x07);
-    date = bcdToDec(data[4] & 0x3F);
-    month = bcdToDec(data[5] & 0x1F);
-    year = bcdToDec(data[6]);
-}
-
-// Returns formatted time string for display
-// Format: HH:MM:SS
-char* SecuritySystem::getTimeStr() {
-    static char timeStr[32];    // Static buffer for formatted time string
-    int sec, min, hour, day, date, month, year;
-    
-    // Get current time from RTC
-    getTime(sec, min, hour, day, date, month, year);
-    
-    // Format time into string
-    char temp[16];
-    sprintf(temp, "%02d:%02d:%02d", hour, min, sec);
-    strcpy(timeStr, temp);
-    
-    return timeStr;
+    RtcTime time = { (uint8_t)sec, (uint8_t)min, (uint8_t)hour, (uint8_t)day,
+                     (uint8_t)date, (uint8_t)month, (uint8_t)year };
+    timeService.set(time);    // Day of week is derived from the date
 }
 
-// Converts Binary Coded Decimal (BCD) to standard decimal
-uint8_t SecuritySystem::bcdToDec(uint8_t val) {
-    return (val/16*10) + (val%16);    // Convert tens and ones
+// Whole-second DS3231 read - only steps the clock if discipline has lost it
+void SecuritySystem::onTimeSync() {
+    timeService.sync();
 }
 
-// Converts standard decimal to Binary Coded Decimal (BCD)
-uint8_t SecuritySystem::decToBcd(uint8_t val) {
-    return (val/10*16) + (val%10);    // Convert to tens and ones in BCD
+// Let the next minute edge through; serviceRtcAlarm() turns it off again,
+// so INT/SQW is quiet between samples
+void SecuritySystem::onDisciplineDue() {
+    rtc.clearAlarmFlags(DS3231::ALARM_2);
+    rtcAlarms |= DS3231::ALARM_2;
+    rtc.enableAlarms(rtcAlarms);
 }
 
 // Handles all keypad input and processes system commands
 void SecuritySystem::handleKeypress(char key) {
-    playTone(1000.0, 0.05);  // Key press feedback tone
-
-    // Special handling for entry delay during ARMED_AWAY state
-    if(currentState == ARMED_AWAY && entryDelayActive) {
-        // Handle numeric input during entry delay
-        if(key >= '0' && key <= '9' && codeIndex < 4) {
-            inputCode[codeIndex++] = key;
-            // Update code display
-            lcd.locate(1,5);
-            for(int i = 0; i < 4; i++) {
-                lcd.putc(i < codeIndex ? '*' : '_');
-            }
-        }
-        // Handle code confirmation
-        else if(key == '#' && codeIndex == 4) {
-            if(validateCode()) {
-                entryDelayActive = false;
-                currentState = DISARMED;
-                showStatus((const char*)"DISARMED");
-                updateLED(DISARMED);
-                playTone(440.0, 0.1);  // Success tone
-            } else {
-                // Handle invalid code
-                clearDisplay();
-                showStatus((const char*)"Wrong Code!");
-                playTone(220.0, 0.5);  // Error tone
-                ThisThread::sleep_for(1s);
-                
-                // Reset code entry
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
-                clearDisplay();
-            }
-        }
-        // Handle backspace
-        else if(key == '*' && codeIndex > 0) {
-            inputCode[--codeIndex] = 0;
-            lcd.locate(1,5);
-            for(int i = 0; i < 4; i++) {
-                lcd.putc(i < codeIndex ? '*' : '_');
-            }
-        }
-        return;  // Skip normal processing during entry delay
+    if(currentState != ALARM) {
+        annunciator.beep(1000.0, 50);  // Key press feedback tone (siren has priority)
+        if(keyDetectedUs) keyLatency.record(LATENCY_TONE, keyDetectedUs);
     }
-    
-    // Process regular keypad input
-    switch(key) {
-        case 'A': { // ARM HOME mode
-            if(currentState != ALARM) {
-                showStatus((const char*)"Enter Code:");
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
-                lastCommand = 'A';
-            }
-            break;
-        }
-            
-        case 'B': { // ARM AWAY mode
-            if(currentState != ALARM) {
-                showStatus((const char*)"Enter Code:");
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
-                lastCommand = 'B';
-            }
+    timers.cancel(statusTimer);  // New input supersedes any pending status restore
+    dispatch(classifyKey(key), key);
+}
+
+// Maps the current state and flags onto a row of the panel transition table
+PanelMode SecuritySystem::currentMode() const {
+    switch(currentState) {
+        case ARMED_HOME: return MODE_ARMED_HOME;
+        case ARMED_AWAY: return entryDelayActive ? MODE_ENTRY_DELAY :
+                                exitDelayActive ? MODE_EXIT_DELAY : MODE_ARMED_AWAY;
+        case ALARM:      return alarmCodeEntry ? MODE_ALARM_CODE : MODE_ALARM;
+        default:         return MODE_DISARMED;
+    }
+}
+
+// Applies a table mode to the state variables it is derived from
+void SecuritySystem::enterMode(PanelMode mode) {
+    if(mode != currentMode()) scheduleArmedHome = false;   // Any real transition hands the panel back to the user
+    switch(mode) {
+        case MODE_DISARMED:    currentState = DISARMED;   resetEntryDelay(); resetExitDelay(); trippedZones = 0; break;
+        case MODE_ARMED_HOME:  currentState = ARMED_HOME; resetEntryDelay(); resetExitDelay(); break;
+        case MODE_ARMED_AWAY:  currentState = ARMED_AWAY; resetEntryDelay(); resetExitDelay(); break;
+        case MODE_ENTRY_DELAY: currentState = ARMED_AWAY; resetExitDelay(); break;
+        case MODE_EXIT_DELAY:  currentState = ARMED_AWAY; resetEntryDelay(); break;
+        case MODE_ALARM:       currentState = ALARM; alarmCodeEntry = false; resetEntryDelay(); resetExitDelay(); break;
+        case MODE_ALARM_CODE:  currentState = ALARM; alarmCodeEntry = true;  break;
+        default: break;
+    }
+    saveCheckpoint();
+}
+
+// Single state machine engine - one table lookup selects the action and next mode
+void SecuritySystem::dispatch(PanelInput input, char key) {
+    const PanelTransition& t = PANEL_TABLE[currentMode()][input];
+    enterMode(t.next);
+    performAction(t.action, key);
+}
+
+// Executes the side effects of a table transition
+void SecuritySystem::performAction(PanelAction action, char key) {
+    switch(action) {
+        case ACT_PROMPT_CODE: { // Start code entry for the command key
+            clearCode();
+            requestScreen(SCREEN_CODE_PROMPT);
+            lastCommand = key;
             break;
         }
-            
-        case 'C': { // DISARM system
-            if(currentState != DISARMED) {
-                showStatus((const char*)"Enter Code:");
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
-                lastCommand = 'C';
+
+        case ACT_DIGIT:
+        case ACT_DIGIT_INLINE: { // Append digit to code buffer
+            if(codeIndex < 4) {
+                inputCode[codeIndex++] = key;
+                requestScreen(action == ACT_DIGIT ? SCREEN_CODE_ENTRY : SCREEN_CODE_MASK);
             }
             break;
         }
-            
-        case 'D': { // Emergency/Panic button
-            currentState = ALARM;
-            logEvent("Panic Button Pressed");
-            handleAlarm();
-            break;
-        }
-            
-        case '*': { // Backspace
+
+        case ACT_BACKSPACE:
+        case ACT_BACKSPACE_INLINE: { // Remove last digit
             if(codeIndex > 0) {
-                codeIndex--;
-                inputCode[codeIndex] = 0;
-                showInputCode();
+                inputCode[--codeIndex] = 0;
+                requestScreen(action == ACT_BACKSPACE ? SCREEN_CODE_ENTRY : SCREEN_CODE_MASK);
             }
             break;
         }
-            
-        case '#': { // Enter/Confirm code
+
+        case ACT_SUBMIT_ZONES: // Nothing entered - show the zone grid instead
+            if(codeIndex == 0) {
+                requestScreen(SCREEN_ZONES);
+                scheduleStatusRestore(ZONE_SCREEN_MS);
+                break;
+            }
+            // Fall through - a partial code is submitted (and ignored) as usual
+
+        case ACT_SUBMIT: { // Validate code and feed the result back into the table
             if(codeIndex == 4) {
-                if(validateCode()) {
-                    // Process valid code based on last command
-                    if(lastCommand == 'A') {
-                        resetEntryDelay();
-                        currentState = ARMED_HOME;
-                        showStatus((const char*)"ARMED HOME");
-                        logEvent("System Armed - Home Mode");
-                    } 
-                    else if(lastCommand == 'B') {
-                        resetEntryDelay();
-                        currentState = ARMED_AWAY;
-                        showStatus((const char*)"ARMED AWAY");
-                        logEvent("System Armed - Away Mode");
-                    }
-                    else if(lastCommand == 'C') {
-                        resetEntryDelay();
-                        currentState = DISARMED;
-                        showStatus((const char*)"DISARMED");
-                        logEvent("System Disarmed");
+                // Without a user database every code is refused - not counted as wrong
+                if(!codeStore.available()) {
+                    requestScreen(SCREEN_NO_CODES);
+                    scheduleStatusRestore(1500);
+                    clearCode();
+                    break;
+                }
+
+                // Codes are not even checked while the keypad is locked out
+                uint64_t now = Kernel::get_ms_count();
+                uint32_t locked = lockout.remaining(SOURCE_KEYPAD, now);
+                if(locked) {
+                    publish(EVT_LOCKOUT, nullptr, (uint16_t)((locked + 999) / 1000));
+                    clearCode();
+                    break;
+                }
+
+                // Disarming from any mode needs PERM_DISARM, arming needs PERM_ARM
+                PanelMode mode = currentMode();
+                uint8_t required =
+                    (mode == MODE_ENTRY_DELAY || mode == MODE_EXIT_DELAY ||
+                     mode == MODE_ALARM_CODE || lastCommand == 'C') ? PERM_DISARM :
+                    (lastCommand == 'A' || lastCommand == 'B') ? PERM_ARM : 0;
+
+                if(validateCode(inputCode, required)) {
+                    lockout.recordSuccess(SOURCE_KEYPAD);
+                    if(codeStore.permissions(lastUser) & PERM_DURESS) {
+                        publish(EVT_DURESS, "Duress Code Used");  // Silent - panel behaves normally
                     }
-                    updateLED(currentState);
-                    playTone(880.0, 0.1);  // Success tone
+                    dispatch(lastCommand == 'A' ? IN_CODE_OK_HOME :
+                             lastCommand == 'B' ? IN_CODE_OK_AWAY :
+                             lastCommand == 'C' ? IN_CODE_OK_DISARM : IN_CODE_OK, key);
                 } else {
-                    // Handle invalid code
-                    showStatus((const char*)"Wrong Code!");
-                    playTone(220.0, 0.5);
-                    ThisThread::sleep_for(1s);
-                    
-                    // Restore previous state display
-                    switch(currentState) {
-                        case DISARMED: 
-                            showStatus((const char*)"DISARMED"); 
-                            break;
-                        case ARMED_HOME: 
-                            showStatus((const char*)"ARMED HOME"); 
-                            break;
-                        case ARMED_AWAY: 
-                            showStatus((const char*)"ARMED AWAY"); 
-                            break;
-                        case ALARM: 
-                            showStatus((const char*)"! ALARM !"); 
-                            break;
+                    dispatch(IN_CODE_BAD, key);
+                    if(lockout.recordFailure(SOURCE_KEYPAD, now)) {
+                        // Once per lockout, not per attempt
+                        publish(EVT_LOCKOUT, "Keypad Locked Out",
+                                (uint16_t)(lockout.remaining(SOURCE_KEYPAD, now) / 1000));
                     }
                 }
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
+                clearCode();
             }
             break;
         }
-            
-        default: { // Handle numeric keys
-            if(key >= '0' && key <= '9' && codeIndex < 4) {
-                inputCode[codeIndex++] = key;
-                showInputCode();
+
+        case ACT_BACKSPACE_STATS: { // Nothing to remove - show the statistics instead
+            if(codeIndex > 0) {
+                inputCode[--codeIndex] = 0;
+                requestScreen(SCREEN_CODE_ENTRY);
+            } else {
+                requestScreen(SCREEN_STATS);
+                scheduleStatusRestore(STATS_SCREEN_MS);
             }
             break;
         }
-    }
-}
 
-// Scans the 4x4 keypad matrix and returns the pressed key
-char SecuritySystem::scanKeypad() {
-    // Keypad layout matrix
-    static const char keys[4][4] = {
-        {'1', '2', '3', 'A'},
-        {'4', '5', '6', 'B'},
-        {'7', '8', '9', 'C'},
-        {'*', '0', '#', 'D'}
-    };
-    
-    // Scan each row
-    for(int row = 0; row < 4; row++) {
-        setKeypadRow(row);                  // Activate current row
-        ThisThread::sleep_for(1ms);         // Debounce delay
-        
-        uint8_t cols = readKeypadCols();    // Read all columns
-        if(cols != 0x0F) {                  // If any column is active (low)
-            // Check each column in the row
-            for(int col = 0; col < 4; col++) {
-                if(!(cols & (1 << col))) {
-                    // Wait for key release with debounce
-                    while(!(readKeypadCols() & (1 << col))) {
-                        ThisThread::sleep_for(1ms);
-                    }
-                    ThisThread::sleep_for(50ms);  // Additional debounce
-                    return keys[row][col];        // Return the pressed key
+        case ACT_PANIC: { // Emergency/Panic button
+            publish(EVT_ALARM_CAUSE, "Panic Button Pressed");
+            handleAlarm();
+            break;
+        }
+
+        case ACT_ACCEPT: { // Valid code with no pending command
+            updateLED(currentState);
+            annunciator.beep(880.0, 100);  // Success tone
+            break;
+        }
+
+        case ACT_ARMED_HOME:
+        case ACT_ARMED_AWAY:
+        case ACT_DISARMED: { // Announce the new state
+            if(action == ACT_DISARMED) {
+                publish(EVT_DISARMED, "System Disarmed");
+            } else {
+                if(action == ACT_ARMED_AWAY) {
+                    lastDoorState = false;    // A door left open starts the entry delay
                 }
+                publish(EVT_ARMED, action == ACT_ARMED_HOME ? "System Armed - Home Mode"
+                                                            : "System Armed - Away Mode");
             }
+            break;
         }
+
+        case ACT_EXIT_DELAY: { // Arming away - leave before the sensors go live
+            startExitDelay();
+            break;
+        }
+
+        case ACT_EXIT_CANCELLED: { // Valid code before the exit delay expired
+            publish(EVT_DISARMED, "Exit Delay Cancelled");
+            break;
+        }
+
+        case ACT_ENTRY_DISARMED: { // Disarmed before entry delay expired
+            publish(EVT_DISARMED, "Entry Delay Disarmed");
+            break;
+        }
+
+        case ACT_ALARM_DISARMED: { // Disarmed while alarm sounding
+            publish(EVT_DISARMED, "Alarm Disarmed");
+            break;
+        }
+
+        case ACT_REJECT:
+        case ACT_ENTRY_REJECT: { // Invalid code - not logged outside an alarm
+            publish(EVT_WRONG_CODE);
+            break;
+        }
+
+        case ACT_ALARM_REJECT: { // Invalid code during alarm - siren keeps going
+            publish(EVT_WRONG_CODE, "Wrong Code Entry During Alarm");
+            break;
+        }
+
+        default: // ACT_IGNORE
+            break;
     }
-    return 0;  // No key pressed
 }
 
-// Initialize the MCP23S17 port expander for keypad operation
-void SecuritySystem::initMCP() {
-    // Configure Port B for keypad matrix
-    writeMCP(IODIRB, 0xF0);  // Lower 4 bits output (rows), upper 4 bits input (columns)
-    writeMCP(0x0D, 0xF0);    // Enable pull-ups on column pins (GPPUB register)
+// Puts the current state's status screen back after a timed message
+void SecuritySystem::scheduleStatusRestore(uint32_t delayMs) {
+    timers.start(statusTimer, delayMs, callback(this, &SecuritySystem::onStatusTimer));
 }
 
-// Write data to a register in the MCP23S17
-void SecuritySystem::writeMCP(uint8_t reg, uint8_t data) {
-    cs = 0;                        // Select MCP23S17
-    spi.write(MCP_ADDR);          // Send write command
-    spi.write(reg);               // Send register address
-    spi.write(data);              // Send data
-    cs = 1;                       // Deselect MCP23S17
+// Status restore timer expired - countdown screen redraws itself
+void SecuritySystem::onStatusTimer() {
+    if(!entryDelayActive && !exitDelayActive) requestScreen(SCREEN_STATUS);
 }
 
-// Read data from a register in the MCP23S17
-uint8_t SecuritySystem::readMCP(uint8_t reg) {
-    cs = 0;                        // Select MCP23S17
-    spi.write(MCP_ADDR | 0x01);   // Send read command
-    spi.write(reg);               // Send register address
-    uint8_t data = spi.write(0x00); // Read data (send dummy byte)
-    cs = 1;                       // Deselect MCP23S17
-    return data;
+// Clears the code entry buffer
+void SecuritySystem::clearCode() {
+    codeIndex = 0;
+    memset(inputCode, 0, sizeof(inputCode));
 }
 
-// Set the active row for keypad scanning
-void SecuritySystem::setKeypadRow(int row) {
-    // Create row pattern (active low)
-    uint8_t rowPattern = ~(1 << row) & 0x0F;  // Invert bit for selected row, mask to 4 bits
-    // Preserve column inputs while updating row outputs
-    writeMCP(GPIOB, (readMCP(GPIOB) & 0xF0) | rowPattern);
+// Returns the status screen text for a system state
+const char* SecuritySystem::statusText(SystemState state) {
+    switch(state) {
+        case ARMED_HOME: return "ARMED HOME";
+        case ARMED_AWAY: return "ARMED AWAY";
+        case ALARM:      return "! ALARM !";
+        default:         return "DISARMED";
+    }
 }
 
-// Read the state of all keypad columns
-uint8_t SecuritySystem::readKeypadCols() {
-    // Read and extract column bits (upper 4 bits)
-    return (readMCP(GPIOB) >> 4) & 0x0F;
+// Returns the status icon colour for a system state - matches updateLED()
+int SecuritySystem::stateColor(SystemState state) {
+    switch(state) {
+        case ARMED_HOME: return 0xFF00FF;   // Purple
+        case ARMED_AWAY: return BLUE;
+        case ALARM:      return RED;
+        default:         return GREEN;
+    }
 }
 
-// Validate entered security code
-bool SecuritySystem::validateCode() {
-    return (strcmp(inputCode, SECURITY_CODE) == 0);
+// Validate a code against the user database
+// The matching slot must hold every permission in 'required'; the slot is
+// remembered in lastUser so actions can tell which user operated the panel
+bool SecuritySystem::validateCode(const char* code, uint8_t required) {
+    lastUser = codeStore.lookup(code);
+    uint8_t perms = codeStore.permissions(lastUser);
+    if(perms == 0) return false;                            // Unknown code
+    if(perms & (PERM_MASTER | PERM_DURESS)) return true;    // Full access
+    return (perms & required) == required;
 }
 
 // Main sensor monitoring function - checks all sensors and handles their states
 void SecuritySystem::checkSensors() {
-    // Check PIR motion sensors
-    if (pirSensor1.read() == 1 || pirSensor2.read() == 1) {
-        if (currentState == ARMED_AWAY) {
-            // Any motion triggers alarm in AWAY mode
-            handleMotionDetected("Motion Detected!");
-        }
-        else if (currentState == ARMED_HOME && pirSensor1.read() == 1) {
-            // Only external sensor (PIR1) triggers in HOME mode
-            handleMotionDetected("Outside Motion!");
-        }
+    // Check PIR motion sensors - the zone table decides which count right now
+    if (pirSensor1.read() == 1 && zoneArmed(ZONE_OUTSIDE_MOTION)) {
+        trippedZones |= 1u << ZONE_OUTSIDE_MOTION;
+        handleMotionDetected(currentState == ARMED_AWAY ? "Motion Detected!" : "Outside Motion!");
+    }
+    else if (pirSensor2.read() == 1 && zoneArmed(ZONE_INSIDE_MOTION)) {
+        // Internal sensor (PIR2) is not armed in HOME mode
+        trippedZones |= 1u << ZONE_INSIDE_MOTION;
+        handleMotionDetected("Motion Detected!");
     }
     
     // Check magnetic door sensor
     bool currentDoorState = doorSensor.read();
-    if(currentDoorState == 1 && lastDoorState == 0) {  // Door opening detected
-        switch(currentState) {
-            case ARMED_HOME:
-                handleDoorOpen("Door Opened");
-                break;
-            case ARMED_AWAY:
-                handleDoorOpen("Entry Started");
-                break;
-            default:
-                break;
-        }
+    if(currentDoorState == 1 && lastDoorState == 0 && zoneArmed(ZONE_DOOR)) {  // Door opening detected
+        handleDoorOpen(currentState == ARMED_AWAY ? "Entry Started" : "Door Opened");
     }
     lastDoorState = currentDoorState;
     
     // Check ultrasonic sensor for proximity/window breach
-    if(currentState != DISARMED && !entryDelayActive) {
+    if(zoneArmed(ZONE_WINDOW)) {
         float distance = measureDistance();
-        static bool inAlertZone = false;
-        
         // Check if object is within alert threshold (10cm)
-        if(distance < 10.0f && !inAlertZone) {
-            inAlertZone = true;
+        if(distance < 10.0f && !windowNear) {
+            windowNear = true;
             if(currentState == ARMED_HOME) {
                 handleUltrasonicAlert("Proximity Alert");
             } else if(currentState == ARMED_AWAY) {
                 handleUltrasonicAlert("Window Breach!");
             }
         } else if(distance > 12.0f) {  // Reset alert with 2cm hysteresis
-            inAlertZone = false;
+            windowNear = false;
         }
     }
-    
-    // Process entry delay countdown if active
-    if(currentState == ARMED_AWAY && entryDelayActive) {
-        processEntryDelay();
-    }
 }
 
 // Function to measure distance using ultrasonic sensor
 float SecuritySystem::measureDistance() {
-    static uint32_t lastMeasureTime = 0;
-    uint32_t currentTime = Kernel::get_ms_count();
-    
     // Rate limit measurements to prevent sensor flooding
-    if (currentTime - lastMeasureTime < 60) {  // Minimum 60ms between measurements
+    if (measureHoldoff.active()) {  // Minimum 60ms between measurements
         return 400.0f;  // Return max range if too soon
     }
-    lastMeasureTime = currentTime;
+    timers.start(measureHoldoff, 60);
     
     // Generate trigger pulse
     trigPin = 0;
@@ -541,295 +1320,459 @@ float SecuritySystem::measureDistance() {
     return distance_cm;
 }
 
-// Main alarm handler - manages alarm state and user response
+// Main alarm handler - announces the alarm; keypad input is handled by the state machine
 void SecuritySystem::handleAlarm() {
-    showStatus((const char*)"! ALARM !");
-    updateLED(ALARM);
-    logEvent("ALARM TRIGGERED");  // Log alarm event
-    bool codeEntryMode = false;   // Track if in code entry mode
-    
-    // Continue alarm until system is disarmed
-    while(currentState == ALARM) {
-        if (!codeEntryMode) {
-            // Generate alarm sound and flash LED
-            ledRed = 1.0;
-            playTone(1760.0, 0.1);    // High-pitched alarm tone
-            ThisThread::sleep_for(100ms);
-            ledRed = 0.0;
-            ThisThread::sleep_for(100ms);
-            
-            // Check for disarm attempt (C button)
-            char tempKey = scanKeypad();
-            if(tempKey == 'C') {
-                codeEntryMode = true;
-                codeIndex = 0;
-                memset(inputCode, 0, sizeof(inputCode));
-                lastCommand = 'C';
-                showStatus((const char*)"Enter Code:");
-                ThisThread::sleep_for(100ms);
-            }
-        } else {
-            // Handle code entry while alarm is active
-            ledRed = !ledRed;  // Continue LED flashing
-            playTone(1760.0, 0.1);
-            
-            char key = scanKeypad();
-            if(key) {
-                if(key >= '0' && key <= '9' && codeIndex < 4) {
-                    // Process numeric input
-                    inputCode[codeIndex++] = key;
-                    showInputCode();
-                    playTone(1000.0, 0.05);  // Key feedback
-                }
-                else if(key == '#' && codeIndex == 4) {
-                    // Validate entered code
-                    if(validateCode()) {
-                        resetEntryDelay();
-                        currentState = DISARMED;
-                        logEvent("Alarm Disarmed");
-                        showStatus((const char*)"DISARMED");
-                        updateLED(DISARMED);
-                        break;
-                    } else {
-                        // Handle invalid code
-                        logEvent("Wrong Code Entry During Alarm");
-                        showStatus((const char*)"Wrong Code!");
-                        ThisThread::sleep_for(1s);
-                        showStatus((const char*)"! ALARM !");
-                        codeEntryMode = false;
-                        codeIndex = 0;
-                        memset(inputCode, 0, sizeof(inputCode));
-                    }
-                }
-                else if(key == '*') {
-                    // Backspace functionality
-                    if(codeIndex > 0) {
-                        codeIndex--;
-                        inputCode[codeIndex] = 0;
-                        showInputCode();
-                    }
-                }
-            }
-            ThisThread::sleep_for(100ms);
-        }
-    }
+    alarmCodeEntry = false;
+    clearCode();
+    saveCheckpoint();
+    publish(EVT_ALARM, "ALARM TRIGGERED");  // Display, siren and log
 }
 
 // Handles motion detection events
 void SecuritySystem::handleMotionDetected(const char* motionMsg) {
     if (currentState != ALARM) {  // Prevent multiple alarms
-        resetEntryDelay();
-        currentState = ALARM;
-        showStatus(motionMsg);
-        logEvent(motionMsg);
+        enterMode(MODE_ALARM);  // Ends an entry or exit delay still counting
+        publish(EVT_ALARM_CAUSE, motionMsg);
         handleAlarm();
     }
 }
 
 // Processes door sensor triggers
 void SecuritySystem::handleDoorOpen(const char* msg) {
-    showStatus(msg);
-    logEvent(msg);
-    
-    if(currentState == DISARMED) {
-        // Just show brief notification in disarmed state
-        ThisThread::sleep_for(1s);
-        showStatus((const char*)"DISARMED");
-    }
-    else if(currentState == ARMED_HOME) {
-        // Visual and audible alert in home mode
-        for(int i = 0; i < 3; i++) {
-            ledBlue = 0.0;
-            playTone(880.0, 0.1);
-            ThisThread::sleep_for(200ms);
-            ledBlue = 0.7;
-            ThisThread::sleep_for(200ms);
-        }
-        showStatus((const char*)"ARMED HOME");
+    if(currentState == ARMED_AWAY && ZONE_TABLE[ZONE_DOOR].delay != DELAY_ENTRY_EXIT) {
+        trippedZones |= 1u << ZONE_DOOR;
+        handleMotionDetected("Door Opened!");  // Door configured without an entry delay
+        return;
     }
-    else if(currentState == ARMED_AWAY) {
+    publish(EVT_DOOR_OPENED, msg);
+    
+    if(currentState == ARMED_AWAY) {
         // Start entry delay sequence
         entryDelayActive = true;
-        entryDelayStart = Kernel::get_ms_count();
-        codeIndex = 0;
-        memset(inputCode, 0, sizeof(inputCode));
+        entryDelayRemaining = ENTRY_DELAY_S;
+        clearCode();
+        saveCheckpoint();
+        publish(EVT_ENTRY_COUNTDOWN, nullptr, entryDelayRemaining);
+        timers.start(entryDelayTimer, 1000, callback(this, &SecuritySystem::processEntryDelay), true);
     }
 }
 
 // Handles ultrasonic sensor alerts
 void SecuritySystem::handleUltrasonicAlert(const char* alertMsg) {
-    uint32_t currentTime = Kernel::get_ms_count();
-    
     // Rate limit alerts to prevent rapid triggering
-    if(currentTime - lastUltrasonicAlert < 1000) {
+    if(ultrasonicHoldoff.active()) {
         return;
     }
-    
-    lastUltrasonicAlert = currentTime;
+    timers.start(ultrasonicHoldoff, 1000);
     
     if(currentState == ARMED_HOME) {
-        logEvent(alertMsg);
         // Visual and audible proximity warning
-        for(int i = 0; i < 2; i++) {
-            showStatus(alertMsg);
-            ledBlue = 0.0;
-            playTone(880.0, 0.05);
-            ThisThread::sleep_for(100ms);
-            ledBlue = 0.7;
-            ThisThread::sleep_for(100ms);
-        }
-        showStatus((const char*)"ARMED HOME");
+        publish(EVT_PROXIMITY, alertMsg);
     }
     else if(currentState == ARMED_AWAY) {
-        logEvent(alertMsg);
         // Trigger full alarm for potential breach
-        currentState = ALARM;
-        showStatus(alertMsg);
+        trippedZones |= 1u << ZONE_WINDOW;
+        enterMode(MODE_ALARM);
+        publish(EVT_ALARM_CAUSE, alertMsg);
         handleAlarm();
     }
 }
 
 // Process entry delay countdown when system is ARMED_AWAY and door is opened
+// Runs once per second from entryDelayTimer
 void SecuritySystem::processEntryDelay() {
     if(!entryDelayActive) return;  // Exit if entry delay isn't active
-    
-    static uint32_t lastUpdate = 0;
-    uint32_t currentTime = Kernel::get_ms_count();
-    
-    // Calculate remaining time in entry delay
-    uint32_t elapsed = (currentTime - entryDelayStart) / 1000;  // Convert to seconds
-    uint32_t remaining = 30 - elapsed;  // 30-second entry delay
-    
-    // Update display once per second
-    if(currentTime - lastUpdate >= 1000 || lastUpdate == 0) {
-        lastUpdate = currentTime;
-        
-        if(remaining > 0) {
-            // Update display with countdown and code entry prompt
-            if(lastUpdate == currentTime) {
-                clearDisplay();
-                
-                // Show countdown timer
-                lcd.locate(9,1);
-                char countMsg[32];
-                sprintf(countMsg, "Time: %ds", remaining);
-                lcd.puts(countMsg);
-                
-                // Show code entry prompt
-                lcd.locate(1,3);
-                lcd.puts("Enter code:");
-                
-                // Show code entry progress
-                lcd.locate(1,5);
-                for(int i = 0; i < 4; i++) {
-                    lcd.putc(i < codeIndex ? '*' : '_');
-                }
-            }
-        } else {
-            // Time expired - trigger alarm
-            entryDelayActive = false;
-            currentState = ALARM;
-            handleAlarm();
-        }
+
+    if(--entryDelayRemaining > 0) {
+        saveCheckpoint();
+        publish(EVT_ENTRY_COUNTDOWN, nullptr, entryDelayRemaining);
+    } else {
+        // Time expired - trigger alarm
+        trippedZones |= 1u << ZONE_DOOR;
+        enterMode(MODE_ALARM);
+        publish(EVT_ALARM_CAUSE, "Entry Delay Expired");
+        handleAlarm();
     }
 }
 
+// Countdown and code entry prompt - after the first second only the time
+// digits and a slice of the bar change
+void SecuritySystem::showCountdown(const char* title, int remaining, int total) {
+    countdownTitle.setText(title);
+    countdown.set(remaining, total);
+    promptText.setText("Enter code:");
+    codeField.setCount(codeIndex);
+    display.show(countdownScreen);
+}
+
 // Reset entry delay timer and flags
 void SecuritySystem::resetEntryDelay() {
     entryDelayActive = false;
-    entryDelayStart = 0;
+    timers.cancel(entryDelayTimer);
 }
 
-// Clear the LCD screen
-void SecuritySystem::clearDisplay() {
-    lcd.cls();
+// Start the exit delay - sensors stay quiet until it runs out
+void SecuritySystem::startExitDelay() {
+    if(EXIT_DELAY_S <= 0) {
+        dispatch(IN_EXIT_DONE, 0);    // Exit delay disabled - arm straight away
+        return;
+    }
+    exitDelayActive = true;
+    exitDelayRemaining = EXIT_DELAY_S;
+    clearCode();
+    saveCheckpoint();
+    publish(EVT_EXIT_COUNTDOWN, "Exit Delay Started", exitDelayRemaining);
+    timers.start(exitDelayTimer, 1000, callback(this, &SecuritySystem::processExitDelay), true);
 }
 
-// Display system status with time
+// Process exit delay countdown after arming away
+// Runs once per second from exitDelayTimer
+void SecuritySystem::processExitDelay() {
+    if(!exitDelayActive) return;  // Exit if exit delay isn't active
+
+    if(--exitDelayRemaining > 0) {
+        saveCheckpoint();
+        publish(EVT_EXIT_COUNTDOWN, nullptr, exitDelayRemaining);
+    } else {
+        dispatch(IN_EXIT_DONE, 0);    // Table arms away and resets the countdown
+    }
+}
+
+// Reset exit delay timer and flags
+void SecuritySystem::resetExitDelay() {
+    exitDelayActive = false;
+    timers.cancel(exitDelayTimer);
+}
+
+// Decide whether a zone trip counts in the current state
+// Home mode skips zones not marked for it; while a countdown runs only
+// instant zones count, so follower zones on the way to the keypad stay quiet
+bool SecuritySystem::zoneArmed(PanelZone zone) const {
+    const ZoneConfig& config = ZONE_TABLE[zone];
+    if(currentState == ARMED_HOME) return config.home;
+    if(currentState != ARMED_AWAY) return false;
+    if(entryDelayActive || exitDelayActive) return config.delay == DELAY_INSTANT;
+    return true;
+}
+
+// Status screen with time - a message longer than a row continues on the next
 void SecuritySystem::showStatus(const char* msg) {
-    clearDisplay();
+    setMessage(messageText, messageWrap, msg);
+    clockText.setTime(timeService.now());
+    display.show(statusScreen);
+}
 
-    // Show current time at top
-    lcd.locate(1,1);
-    char* timeStr = getTimeStr();
-    lcd.puts(timeStr);
+// Status for a state - an alarm gets the banner screen when the banner is on
+// the LCD's card: one image instead of the text, flashed by showClock()
+void SecuritySystem::showState(SystemState state) {
+    if(state != ALARM || !media.available(ASSET_ALARM_BANNER)) {
+        showStatus(statusText(state));
+        return;
+    }
+    clockText.setTime(timeService.now());
+    alarmBanner.setVisible(true);
+    display.show(alarmScreen);
+}
 
-    // Show status message
-    lcd.locate(1,4);
-    
-    // Convert message to writable buffer (LCD requires non-const char*)
-    char buffer[32];
-    strncpy(buffer, msg, sizeof(buffer)-1);
-    buffer[sizeof(buffer)-1] = '\0';  // Ensure null termination
-    
-    lcd.puts(buffer);
+// First 17 characters on one label, the rest on the next
+void SecuritySystem::setMessage(Label& first, Label& rest, const char* msg) {
+    char line[TEXT_MAX_CELLS];
+    size_t length = strlen(msg);
+    size_t split = length > 17 ? 17 : length;
+    memcpy(line, msg, split);
+    line[split] = '\0';
+    first.setText(line);
+    rest.setText(msg + split);
 }
 
-// Display code entry interface
+// Code entry screen
 void SecuritySystem::showInputCode() {
-    clearDisplay();
-    // Show prompt
-    lcd.locate(1,3);
-    lcd.puts("Enter Code:");
-    // Show code entry progress with asterisks
-    lcd.locate(1,5);
-    for(int i = 0; i < 4; i++) {
-        lcd.putc(i < codeIndex ? '*' : '_');
+    clockText.setTime(timeService.now());
+    promptText.setText("Enter Code:");
+    codeField.setCount(codeIndex);
+    display.show(codeScreen);
+}
+
+// Time of day - drawn only on screens that show it; also flashes the alarm banner
+void SecuritySystem::showClock() {
+    clockText.setTime(timeService.now());
+    if(display.current() == &alarmScreen) alarmBanner.setVisible(!alarmBanner.visible());
+}
+
+// Statistics screen - the counts may have changed since it was last shown,
+// so the panel is always painted afresh
+void SecuritySystem::showStats() {
+    clockText.setTime(timeService.now());
+    display.show(statsScreen);
+    display.invalidateAll();
+}
+
+// Statistics panel: counts for the last 7 days, then alarms by hour of day
+// as a bar chart along the bottom (one 5-pixel bar per hour). The counts use
+// half-height rows to fit below the time.
+void SecuritySystem::paintStats(LcdRenderer& out) {
+    uLCD_4DGL& lcd = out.lcd();
+    static const struct {
+        const char* label;
+        PanelEventType type;
+    } ROWS[] = {
+        { "Alarms    ", EVT_ALARM },
+        { "Armed     ", EVT_ARMED },
+        { "Disarmed  ", EVT_DISARMED },
+        { "Door      ", EVT_DOOR_OPENED },
+        { "Wrong code", EVT_WRONG_CODE },
+        { "Lockouts  ", EVT_LOCKOUT },
+    };
+
+    EventStatsView view;
+    eventStats.view(timeService.now(), view);
+
+    lcd.text_height(1);                 // 8-pixel rows: row 4 is just below the time
+    char line[32];    // LCD requires non-const char*
+    *fmtText(line, line + sizeof(line) - 1, "Last 7 days") = '\0';
+    lcd.locate(1,4);
+    lcd.puts(line);
+    for(size_t i = 0; i < sizeof(ROWS) / sizeof(ROWS[0]); i++) {
+        char* p = fmtText(line, line + sizeof(line) - 8, ROWS[i].label);
+        p = fmtUintPadded(p, view.week[ROWS[i].type], 5);
+        *p = '\0';
+        lcd.locate(1, 5 + i);
+        lcd.puts(line);
+    }
+    lcd.text_height(2);                 // Back to the size every other screen uses
+
+    uint16_t peak = 1;
+    for(int h = 0; h < 24; h++) {
+        if(view.alarmsByHour[h] > peak) peak = view.alarmsByHour[h];
     }
+    for(int h = 0; h < 24; h++) {
+        int height = view.alarmsByHour[h] * STATS_CHART_HEIGHT / peak;
+        int x = STATS_CHART_X0 + h * 5;
+        lcd.line(x, STATS_CHART_Y1 + 1, x + 3, STATS_CHART_Y1 + 1, WHITE);    // Hour tick
+        if(height) lcd.filled_rectangle(x, STATS_CHART_Y1 - height + 1, x + 3, STATS_CHART_Y1, RED);
+    }
+}
+
+// Zone grid screen - tiles stay live while it is shown
+void SecuritySystem::showZones() {
+    showZoneTiles();
+    clockText.setTime(timeService.now());
+    display.show(zoneScreen);
 }
 
-// Generate tones for audio feedback
-void SecuritySystem::playTone(float frequency, float duration) {
-    buzzer.period(1.0/frequency);  // Set tone frequency
-    buzzer = 0.5;                  // 50% duty cycle
-    ThisThread::sleep_for(duration * 1000);  // Hold tone
-    buzzer = 0.0;                  // Silence
+// Zone grid tiles from the last sample - unchanged tiles are not redrawn
+void SecuritySystem::showZoneTiles() {
+    uint16_t tiles = zoneTiles;
+    for(int z = 0; z < ZONE_COUNT; z++) {
+        zoneGrid.setTile(z, ZONE_TABLE[z].letter, (ZoneGrid::TileState)((tiles >> (z * 2)) & 3));
+    }
+}
+
+// Ask the display consumer to draw a screen
+void SecuritySystem::requestScreen(PanelScreen screen) {
+    publish(EVT_SCREEN, nullptr, screen);
+}
+
+// Masked code field - one cell changes per key
+void SecuritySystem::showCodeMask() {
+    codeField.setCount(codeIndex);
 }
 
 // Update RGB LED based on system state
 void SecuritySystem::updateLED(SystemState state) {
-    // Turn off all LED components
-    ledRed = 0.0;
-    ledGreen = 0.0;
-    ledBlue = 0.0;
-    
     // Set appropriate color for current state
     switch(state) {
         case DISARMED:
-            ledGreen = 1.0;        // Green for disarmed
+            annunciator.setColor(0.0, 1.0, 0.0);   // Green for disarmed
             break;
         case ARMED_HOME:
-            ledBlue = 1.0;         // Purple for armed home
-            ledRed = 1.0;
+            annunciator.setColor(1.0, 0.0, 1.0);   // Purple for armed home
             break;
         case ARMED_AWAY:
-            ledBlue = 1.0;         // Blue for armed away
+            annunciator.setColor(0.0, 0.0, 1.0);   // Blue for armed away
             break;
         case ALARM:
-            ledRed = 1.0;          // Red for alarm
+            annunciator.setColor(1.0, 0.0, 0.0);   // Red for alarm
             break;
     }
 }
 
-// Log an event with timestamp to SD card
-void SecuritySystem::logEvent(const char* event) {
-    int sec, min, hour, day, date, month, year;
-    
-    // Get current time from RTC
-    getTime(sec, min, hour, day, date, month, year);
+// Publish a panel event stamped with the current state and time
+void SecuritySystem::publish(PanelEventType type, const char* text, uint16_t arg) {
+    PanelEvent event;
+    event.type = type;
+    event.state = (uint8_t)currentState;
+    event.arg = arg;
+    event.timestamp = timeService.now();
+    event.keyUs = keyDetectedUs;
+    event.text = text;
+    bus.publish(event);
+}
+
+// Logger consumer - every event carrying text goes to the SD card
+// Textless events are countdown seconds and lockout reminders, except wrong
+// codes outside an alarm: those are not logged but still counted
+void SecuritySystem::onLogEvent(const PanelEvent& event) {
+    if(event.text || event.type == EVT_WRONG_CODE) eventStats.record(event.type, event.timestamp);
+    if(event.text) logEvent(event.text, event.timestamp);    // Stamped when it happened, not when written
+}
+
+// Checkpoint the event counters - runs where the card is owned
+void SecuritySystem::serviceStats() {
+    if(sdCard.isMounted() && eventStats.saveDue(Kernel::get_ms_count())) {
+        eventStats.save(sdCard);
+    }
+}
+
+// Display consumer - status screens and timed messages
+// Only widget state changes here; renderDisplay() draws once per pass
+void SecuritySystem::onDisplayEvent(const PanelEvent& event) {
+    SystemState state = (SystemState)event.state;
+    statusIcon.setColor(stateColor(state));
+
+    switch(event.type) {
+        case EVT_ARMED:
+        case EVT_DISARMED:
+        case EVT_ALARM:
+            showState(state);
+            break;
+            
+        case EVT_ALARM_CAUSE:
+            setMessage(alarmCause, alarmCauseWrap, event.text);
+            showStatus(event.text);     // Replaced by the ALARM screen right after
+            break;
+            
+        case EVT_DOOR_OPENED:
+            if(state != ARMED_AWAY) {   // Away mode goes straight to the countdown
+                showStatus(event.text);
+                scheduleStatusRestore(state == ARMED_HOME ? 1500 : 1000);
+            }
+            break;
+            
+        case EVT_PROXIMITY:
+            showStatus(event.text);
+            scheduleStatusRestore(500);
+            break;
+            
+        case EVT_ENTRY_COUNTDOWN:
+            if(entryDelayActive) showCountdown("Entry", event.arg, ENTRY_DELAY_S);
+            break;
+            
+        case EVT_EXIT_COUNTDOWN:
+            if(exitDelayActive) showCountdown("Exit", event.arg, EXIT_DELAY_S);
+            break;
+            
+        case EVT_WRONG_CODE:
+            showStatus((const char*)"Wrong Code!");
+            scheduleStatusRestore(1000);
+            break;
+            
+        case EVT_LOCKOUT: {
+            char msg[32];
+            char* p = fmtText(msg, msg + sizeof(msg), "Locked: ");
+            p = fmtUint(p, event.arg);
+            p[0] = 's';
+            p[1] = '\0';
+            showStatus(msg);
+            scheduleStatusRestore(1000);
+            break;
+        }
+
+        case EVT_SCREEN:
+            switch(event.arg) {
+                case SCREEN_STATUS:      showState(state); break;
+                case SCREEN_CODE_PROMPT: showStatus((const char*)"Enter Code:"); break;
+                case SCREEN_CODE_ENTRY:  showInputCode(); break;
+                case SCREEN_CODE_MASK:   showCodeMask(); break;
+                case SCREEN_CLOCK:       showClock(); break;
+                case SCREEN_STATS:       showStats(); break;
+                case SCREEN_ZONES:       showZones(); break;
+                case SCREEN_ZONE_TILES:  showZoneTiles(); break;
+                case SCREEN_NO_CODES:    showStatus((const char*)"Codes Unavailable"); break;
+                default: break;
+            }
+            break;
+            
+        default:
+            break;
+    }
+
+    // First drawing caused by a key is its echo, measured once it is on the LCD
+    if(event.keyUs && event.keyUs != lastEchoKeyUs) {
+        echoPendingUs = event.keyUs;
+    }
+}
+
+// Draw what the events of this display pass changed
+void SecuritySystem::renderDisplay() {
+    if(!displayReady) return;    // Widgets keep their state until the LCD has booted
+    display.render();
+    if(echoPendingUs) {
+        keyLatency.record(LATENCY_ECHO, echoPendingUs);
+        lastEchoKeyUs = echoPendingUs;
+        echoPendingUs = 0;
+    }
+}
+
+// Annunciator consumer - LED color, tones and patterns
+void SecuritySystem::onAnnunciatorEvent(const PanelEvent& event) {
+    SystemState state = (SystemState)event.state;
     
-    // Format log entry with timestamp and event description
-    // Format: YYYY-MM-DD HH:MM:SS - Event Message\n
-    snprintf(eventBuffer, sizeof(eventBuffer), 
-             "%04d-%02d-%02d %02d:%02d:%02d - %s\n",
-             2000 + year,    // Convert 2-digit year to 4-digit
-             month, 
-             date,           // Day of month
-             hour, 
-             min, 
-             sec, 
-             event);        // Event description
+    switch(event.type) {
+        case EVT_ARMED:
+        case EVT_DISARMED:
+            annunciator.stop();             // Silences the siren if it was running
+            updateLED(state);
+            annunciator.beep(880.0, 100);   // Success tone
+            break;
+            
+        case EVT_ALARM:
+            updateLED(ALARM);
+            annunciator.play(PATTERN(SIREN), true);
+            break;
+            
+        case EVT_DOOR_OPENED:
+            if(state == ARMED_HOME) annunciator.play(PATTERN(DOOR_CHIME));
+            break;
+            
+        case EVT_PROXIMITY:
+            annunciator.play(PATTERN(PROXIMITY_CHIME));
+            break;
+            
+        case EVT_EXIT_COUNTDOWN:
+            if(event.text) updateLED(state);    // First second of the countdown
+            if(event.arg <= EXIT_FAST_CHIRP_S) annunciator.play(PATTERN(EXIT_CHIRP_FAST));
+            else annunciator.play(PATTERN(EXIT_CHIRP));
+            break;
+            
+        case EVT_WRONG_CODE:
+            if(state != ALARM) annunciator.beep(220.0, 500);  // Error tone, siren has priority
+            break;
+            
+        default:
+            break;
+    }
+}
+
+// Log an event with timestamp to SD card
+void SecuritySystem::logEvent(const char* event, uint32_t epoch) {
+#if MBED_CONF_RTOS_PRESENT
+    logMutex.lock();    // eventBuffer and the card are shared
+#endif
+    // Calendar breakdown happens only here, at presentation time
+    // Format: YYYY-MM-DD HH:MM:SS - Event Message\n, written in place
+    char* end = eventBuffer + sizeof(eventBuffer) - 2;     // Room for '\n' and NUL
+    RtcTime time;
+    TimeService::toCalendar(epoch ? epoch : timeService.now(), time);
+    char* p = fmtIsoDateTime(eventBuffer, time);
+    p = fmtText(p, end, " - ");
+    p = fmtText(p, end, event);
+    p[0] = '\n';
+    p[1] = '\0';
     
     // Write the formatted log entry to SD card
-    sdCard.writeData(eventBuffer, strlen(eventBuffer));
+    sdCard.writeData(eventBuffer, p + 1 - eventBuffer);
+#if MBED_CONF_RTOS_PRESENT
+    logMutex.unlock();
+#endif
 }
\ No newline at end of file
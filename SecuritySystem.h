@@ -5,13 +5,33 @@
 #include "uLCD_4DGL.h"     // LCD display interface
 #include <cstdint>         // Standard integer types
 #include "SDCard.h"        // Custom SD card handling
+#include "UserCodeStore.h" // Per-user code database
+#include "LockoutPolicy.h" // Wrong-code lockout with backoff
+#include "TimerWheel.h"    // Shared timeout service
+#include "EventBus.h"      // Intra-firmware publish/subscribe
+#include "Annunciator.h"   // Non-blocking buzzer and status LED
+#include "PanelCheckpoint.h" // Battery-backed warm restart record
+#include "IdleManager.h"   // Interrupt-driven low-power idle
+#include "PanelStateMachine.h" // Keypad/panel transition table
+#include "PanelZones.h"    // Zone delay classes and delay lengths
+#include "MCP23S17.h"      // Keypad port expander driver
+#include "KeypadScanner.h" // Debounced background keypad scanning
+#include "KeyLatency.h"    // Key feedback latency histograms
+#include "DS3231.h"        // Real-time clock driver
+#include "TimeService.h"   // Epoch time disciplined to the DS3231
+#include "FastFormat.h"    // Table-driven number and timestamp writers
+#include "ArmSchedule.h"   // Weekly auto-arm/disarm table
+#include "SerialConsole.h" // USB serial command frames and debug text
+#include "LogExporter.h"   // Background event log export over the console
+#include "TelemetryProtocol.h" // Compact state and health push frames
+#include "EventStats.h"    // Rolling per-type and per-hour event counters
+#include "Widgets.h"       // Retained-mode LCD screens
+#include "MediaAssets.h"   // Prerendered images on the LCD's own card
 
-// MCP23S17 Port Expander Register Definitions
-#define IODIRA      0x00    // I/O Direction Register A - controls Port A pins as input/output
-#define IODIRB      0x01    // I/O Direction Register B - controls Port B pins as input/output
-#define GPIOA       0x12    // GPIO Port Register A - read/write Port A pins
-#define GPIOB       0x13    // GPIO Port Register B - read/write Port B pins
-#define MCP_ADDR    0x40    // Device address for MCP23S17 on SPI bus
+// Seconds between periodic telemetry frames (0 = no telemetry until a host asks)
+#ifndef MBED_CONF_APP_TELEMETRY_PERIOD
+#define MBED_CONF_APP_TELEMETRY_PERIOD 10
+#endif
 
 // Enable use of chrono literals for time specifications
 using namespace std::chrono;
@@ -25,6 +45,31 @@ enum SystemState {
     ALARM           // System is in alarm state due to trigger
 };
 
+// Display Screens
+// Carried in the arg of EVT_SCREEN so only the display consumer touches the LCD
+enum PanelScreen : uint8_t {
+    SCREEN_STATUS,          // Time and status text for the current state
+    SCREEN_CODE_PROMPT,     // "Enter Code:" after a command key
+    SCREEN_CODE_ENTRY,      // Full code entry screen
+    SCREEN_CODE_MASK,       // Masked code line only
+    SCREEN_CLOCK,           // Time line only
+    SCREEN_STATS,           // Event statistics ('*' with no code entered while disarmed)
+    SCREEN_ZONES,           // Zone grid ('#' with no code entered)
+    SCREEN_ZONE_TILES,      // Zone grid tiles only
+    SCREEN_NO_CODES         // "Codes Unavailable" - the user database could not be loaded
+};
+
+#if MBED_CONF_RTOS_PRESENT
+// Panel Threads (RTOS profile)
+enum PanelTask : uint8_t {
+    TASK_KEYPAD,            // Keypad matrix sampling - high
+    TASK_ALARM,             // Key handling, sensors, state machine, tones - main thread, above normal
+    TASK_DISPLAY,           // LCD rendering - below normal
+    TASK_LOGGER,            // SD card logging - low
+    TASK_COUNT
+};
+#endif
+
 // Main Security System Class Declaration
 class SecuritySystem {
 public:
@@ -34,15 +79,16 @@ public:
     void run();         // Main system operation loop
 
 private:
+    // Timer and Event Services - declared first, hardware drivers depend on them
+    TimerWheel timers;              // Hashed timer wheel service
+    EventBus bus;                   // Event queues for logger, display and annunciator
+
     // Hardware Components
     uLCD_4DGL lcd;          // LCD display interface (pins: TX→p13, RX→p14, RST→p11)
-    PwmOut buzzer;          // Piezo buzzer for audio alerts (p21)
-    PwmOut ledRed;          // Red component of RGB LED (p22)
-    PwmOut ledGreen;        // Green component of RGB LED (p23)
-    PwmOut ledBlue;         // Blue component of RGB LED (p24)
-    DigitalIn pirSensor1;   // External PIR motion sensor (p17)
-    DigitalIn pirSensor2;   // Internal PIR motion sensor (p16)
-    DigitalIn doorSensor;   // Magnetic door contact sensor (p18)
+    Annunciator annunciator;  // Buzzer (p21) and RGB LED (R→p22, G→p23, B→p24)
+    InterruptIn pirSensor1; // External PIR motion sensor (p17)
+    InterruptIn pirSensor2; // Internal PIR motion sensor (p16)
+    InterruptIn doorSensor; // Magnetic door contact sensor (p18)
 
     // Ultrasonic Sensor Configuration
     DigitalOut trigPin;     // Trigger pin for HC-SR04 sensor (p19)
@@ -51,32 +97,149 @@ private:
     
     // SPI Interface for MCP23S17 Port Expander
     SPI spi;               // SPI bus interface (MOSI→p5, MISO→p6, SCK→p7)
-    DigitalOut cs;         // Chip select for MCP23S17 (p12)
+    MCP23S17 expander;     // Keypad port expander, chip select p12 - rows GPB0-3, columns GPB4-7
+    KeypadScanner keypad;  // Samples and debounces the matrix, queues key events
+    KeyLatency keyLatency; // Key detection to handler, tone and LCD echo
+    uint32_t keyDetectedUs;         // Detection time of the key being handled, 0 = none
+    uint32_t lastEchoKeyUs;         // Key whose LCD echo was last measured (display consumer)
+    uint32_t echoPendingUs;         // Key whose update is waiting for the next render, 0 = none
+    InterruptIn keypadIrq; // MCP23S17 INTB, low while a column change is unread (p15)
+
+    // Low-Power Idle
+    InterruptIn rtcInterrupt;   // DS3231 INT/SQW alarm output, low until the flag is cleared (p26)
+    IdleManager idle;           // Sleeps the loop between interrupts and timers
+    WheelTimer idleReportTimer; // Periodic idle statistics report
+    static const uint32_t IDLE_MAX_MS = 1000;         // Longest sleep, well inside the watchdog timeout
+    static const uint32_t IDLE_BOOT_POLL_MS = 50;     // Sleep limit while waiting for the LCD to boot
+    static const uint32_t IDLE_REPORT_MS = 600000;    // Idle statistics interval (10 min)
+
+#if MBED_CONF_RTOS_PRESENT
+    // RTOS Profile - LCD and SD card run below the alarm logic
+    static const uint32_t KEYPAD_STACK_SIZE = 1024;   // Keypad thread stack bytes
+    static const uint32_t DISPLAY_STACK_SIZE = 2048;  // Display thread stack bytes
+    static const uint32_t LOGGER_STACK_SIZE = 4096;   // Logger thread stack bytes (FAT needs more)
+    MBED_ALIGN(8) unsigned char keypadStack[KEYPAD_STACK_SIZE];    // Statically allocated stacks
+    MBED_ALIGN(8) unsigned char displayStack[DISPLAY_STACK_SIZE];
+    MBED_ALIGN(8) unsigned char loggerStack[LOGGER_STACK_SIZE];
+    Thread keypadThread;        // Takes keypad samples - keys are not lost while the alarm thread is busy
+    rtos::EventFlags keypadSampleDue;  // Set by the scanner's Ticker
+    Thread displayThread;       // Drains CONSUMER_DISPLAY
+    Thread loggerThread;        // Drains CONSUMER_LOGGER
+    volatile uint32_t taskBusyUs[TASK_COUNT];  // Busy time per thread since the last report
+    PlatformMutex logMutex;     // logEvent() is reached from the logger and display threads
+#endif
 
     // System State Variables
     SystemState currentState;     // Current state of the security system
     char inputCode[5];           // Buffer for storing entered security code (4 digits + null)
     int codeIndex;              // Current position in code entry buffer
-    static const char SECURITY_CODE[];  // Defined security code for system access
+    UserCodeStore codeStore;    // Hashed per-user codes loaded from SD card
+    int lastUser;               // Slot of the most recently validated code
+    LockoutPolicy lockout;      // Wrong-code attempt tracking per entry source
     char lastCommand;           // Last keypad command received
     bool entryDelayActive;      // Flag for entry delay countdown
-    uint32_t entryDelayStart;   // Timestamp for entry delay start
+    int entryDelayRemaining;    // Seconds left in the entry delay countdown
+    static const int ENTRY_DELAY_S = MBED_CONF_APP_ENTRY_DELAY;  // Entry delay length in seconds
+    bool exitDelayActive;       // Flag for exit delay countdown
+    int exitDelayRemaining;     // Seconds left in the exit delay countdown
+    static const int EXIT_DELAY_S = MBED_CONF_APP_EXIT_DELAY;    // Exit delay length in seconds
+    static const int EXIT_FAST_CHIRP_S = 10;  // Chirp faster for the last seconds of the exit delay
+    static const int COUNTDOWN_BAR_X0 = 8;    // Countdown progress bar outline (pixels)
+    static const int COUNTDOWN_BAR_Y0 = 104;
+    static const int COUNTDOWN_BAR_X1 = 119;
+    static const int COUNTDOWN_BAR_Y1 = 116;
+    bool alarmCodeEntry;        // Disarm code being entered while alarm sounds
+    PanelCheckpoint checkpoint; // State record that survives resets
+    bool warmRestart;           // Booted from a valid checkpoint after a non-power-on reset
+    static const uint32_t WATCHDOG_TIMEOUT_MS = 8000;  // Main loop stall limit
+    bool displayReady;          // LCD has finished booting and accepts commands
+    Timer bootTimer;            // Runs from construction until the LCD is ready
+    uint32_t armableMs;         // Boot time until keypad and sensors were live
     bool lastDoorState;         // Previous state of door sensor for edge detection
 
-    // Ultrasonic Sensor Parameters
-    uint32_t lastUltrasonicAlert;  // Timestamp of last ultrasonic alert to prevent rapid retriggering
+    // Panel Timers - all driven by one TimerWheel tick
+    WheelTimer statusTimer;         // Restores status screen after a timed message
+    WheelTimer entryDelayTimer;     // 1 s entry delay countdown step
+    WheelTimer exitDelayTimer;      // 1 s exit delay countdown step
+    WheelTimer ultrasonicHoldoff;   // Suppresses repeat ultrasonic alerts for 1 s
+    WheelTimer measureHoldoff;      // Minimum 60 ms between ultrasonic pings
+    WheelTimer clockTimer;          // 1 s clock display refresh
+    WheelTimer timeSyncTimer;       // Hourly whole-second DS3231 cross-check
+    WheelTimer disciplineTimer;     // Arms Alarm 2 for the next clock discipline sample
 
     // I2C Interface
     I2C i2c;                    // I2C bus for RTC communication (SDA→p9, SCL→p10)
     
-    // RTC (DS3231) Configuration
-    static const int DS3231_ADDRESS = 0x68;    // I2C address of DS3231 RTC
-    static const int DS3231_REG_TIME = 0x00;   // Base register address for time data
+    DS3231 rtc;                 // DS3231 real-time clock
+    TimeService timeService;    // Kernel tick clock disciplined to the DS3231
+    uint8_t rtcAlarms;          // DS3231 alarms currently enabled
+    uint64_t rtcEdgeMs;         // Kernel tick of the last INT/SQW falling edge (ISR)
+
+    // LCD Screens - widgets hold what is shown, the renderer sends only changes
+    LcdRenderer display;        // Draws the current screen after each display pass
+    Clock clockText;            // Time, row 1 (status, code entry and stats screens)
+    StatusIcon statusIcon;      // State colour as on the RGB LED, top right
+    Label messageText;          // Status message, row 4
+    Label messageWrap;          // Rest of a message longer than one row, row 5
+    Label promptText;           // "Enter Code:" above the code field, row 3
+    CodeField codeField;        // Masked code, row 5
+    Label countdownTitle;       // "Entry" / "Exit", row 1
+    Countdown countdown;        // Seconds left and elapsed-time bar
+    PaintWidget statsPanel;     // Weekly counts and alarms-by-hour chart
+    Screen statusScreen;        // Time and status message
+    Screen codeScreen;          // Time, prompt and code field
+    Screen countdownScreen;     // Entry/exit delay with code field
+    Screen statsScreen;         // Time and statistics
+    Label zoneTitle;            // "Zones", row 3
+    ZoneGrid zoneGrid;          // Tile per zone from row 4
+    Screen zoneScreen;          // Time and zone grid
+    MediaAssets media;          // Images on the LCD's card, checked once the LCD has booted
+    ImageWidget logoImage;      // Startup logo, whole screen
+    ImageWidget alarmBanner;    // ALARM banner, flashes with the clock
+    Label alarmCause;           // What started the alarm, row 6 under the banner
+    Label alarmCauseWrap;       // Rest of a cause longer than one row, row 7
+    Screen logoScreen;          // Startup logo after a cold boot
+    Screen alarmScreen;         // Time, banner and cause - used when the banner is on the card
+    static const int ALARM_BANNER_Y = 40;           // Banner top edge (pixels), between rows 1 and 6
+    static const uint32_t LOGO_SCREEN_MS = 2000;    // Logo shown before the status
+    void renderDisplay();       // Paints what changed in this display pass
+    void paintStats(LcdRenderer& out);  // Draws the statistics panel
+
+    // Auto-Arm Schedule
+    ArmSchedule schedule;           // Weekly table from schedule.dat
+    ScheduleEntry pendingSchedule;  // Transition programmed into Alarm 1
+    bool scheduleArmedHome;         // Current arm home was set by the schedule - a scheduled disarm may end it
 
     // SD Card Logging
     SDCard sdCard;              // SD card interface for event logging
-    void logEvent(const char* event);  // Method to log events with timestamp
+    void logEvent(const char* event, uint32_t epoch = 0);  // Method to log events with timestamp (0 = now)
     char eventBuffer[512];      // Buffer for formatting log entries
+    EventStats eventStats;      // Counters fed by the logger consumer, saved to stats.dat
+    static const uint32_t STATS_SCREEN_MS = 8000;   // Stats screen shown before the status returns
+    static const int STATS_CHART_X0 = 4;            // Alarms-by-hour chart: left edge (pixels)
+    static const int STATS_CHART_Y1 = 124;          // Bottom of the bars
+    static const int STATS_CHART_HEIGHT = 32;       // Tallest bar (text ends at y 88)
+    void serviceStats();        // Saves the counters when due - logger context
+
+    // Serial Command Console
+    SerialConsole& console;     // USB serial port - command frames in, replies and printf out
+    LogExporter exporter;       // Streams the event log - runs in the logger's context
+    static const uint32_t CONSOLE_POLL_MS = 10;   // Sleep limit while an export waits for ring space
+    void serviceConsole();                              // Handles received frames
+    void handleConsoleCommand(const ConsoleFrame& frame);  // Executes one command and replies
+    ConsoleResult remoteCommand(uint8_t command, const char* code);  // Serial arm/disarm
+    ConsoleResult remoteSetUser(const uint8_t* request);             // Serial user management (master code)
+    void collectStats(uint32_t* stats);                 // STAT_COUNT health counters
+
+    // Telemetry Push
+    TelemetryEncoder telemetry;     // Delta-encodes state and health for a monitoring station
+    WheelTimer telemetryTimer;      // Periodic frame
+    uint16_t telemetryPeriodS;      // Seconds between periodic frames, 0 = off
+    bool telemetryDue;              // Periodic frame owed
+    bool windowNear;                // Ultrasonic zone sees an object
+    void setTelemetryPeriod(uint16_t seconds);  // Starts or stops telemetry
+    void serviceTelemetry();        // Pushes state changes and the periodic frame
+    void onTelemetryDue();          // Telemetry timer expiry
 
     // Sensor Monitoring Methods
     void checkSensors();                    // Main sensor monitoring loop
@@ -84,44 +247,91 @@ private:
     void handleMotionDetected(const char* motionMsg);  // Processes motion detection with specific message
     float measureDistance();                // Measures distance using ultrasonic sensor
     void handleUltrasonicAlert(const char* alertMsg);  // Handles ultrasonic sensor triggers
+    uint8_t trippedZones;                   // Zones that started the current alarm, bit per PanelZone
+    uint16_t zoneTiles;                     // Tile state per zone, 2 bits each (ZoneGrid::TileState)
+    static const uint32_t ZONE_SCREEN_MS = 15000;  // Zone grid shown before the status returns
+    void serviceZones();                    // Publishes zone tile changes for the display
 
     // Component Initialization Methods
     void initializeLCD();     // Sets up LCD display parameters
     void initializeKeypad();  // Initializes keypad through MCP23S17
-    void runStartupSequence(); // Performs system startup tests and animations
+    void runStartupSequence(); // Starts the background LED/buzzer self-test
+    void serviceDisplayBoot(); // Finishes LCD setup once the screen has booted
+    void redrawScreen();       // Draws the screen for the current state
+    void saveCheckpoint();     // Stores current state in the checkpoint record
+    void restoreCheckpoint(const PanelSnapshot& snapshot);  // Loads state variables from a snapshot
+    void resumeRestoredState();  // Restarts countdown/siren for a restored state
+    void logRestart(const PanelSnapshot& snapshot, reset_reason_t reason);  // Reports the restored record
 
     // Core Security Functions
     void handleKeypress(char key);  // Processes keypad input
-    char scanKeypad();              // Scans keypad matrix for pressed keys
-    bool validateCode();            // Validates entered security code
-    void handleAlarm();            // Manages alarm state and responses
+    bool validateCode(const char* code, uint8_t required);  // Validates a code and user permissions
+    void clearCode();               // Clears the code entry buffer
+    void scheduleStatusRestore(uint32_t delayMs);  // Redraws status after a timed message
+    void onStatusTimer();           // Status restore timer expiry
+    void onClockTick();             // Clock refresh request (1 s timer)
+    void handleAlarm();            // Announces alarm state
+
+    // Panel State Machine
+    PanelMode currentMode() const;               // Table row for current state
+    void enterMode(PanelMode mode);              // Applies a table mode to state variables
+    void dispatch(PanelInput input, char key);   // Looks up and executes one transition
+    void performAction(PanelAction action, char key);  // Executes transition side effects
+    static const char* statusText(SystemState state);  // Status screen text per state
+    static int stateColor(SystemState state);          // Status icon colour per state (as the RGB LED)
     void handleDoorOpen(const char* msg);  // Handles door sensor triggers
-    void processEntryDelay();      // Manages entry delay countdown
+    void processEntryDelay();      // Entry delay countdown step (1 s timer)
+    void showCountdown(const char* title, int remaining, int total);  // Draws/updates a countdown screen
     void resetEntryDelay();        // Resets entry delay timer
+    void startExitDelay();         // Starts the exit countdown
+    void processExitDelay();       // Exit delay countdown step (1 s timer)
+    void resetExitDelay();         // Resets exit delay timer
+    bool zoneArmed(PanelZone zone) const;  // True if a zone trip counts right now
 
     // Display Functions
-    void clearDisplay();           // Clears LCD screen
     void showStatus(const char* msg);  // Displays system status message
+    void showState(SystemState state); // Status screen for a state - the banner screen for an alarm
+    static void setMessage(Label& first, Label& rest, const char* msg);  // Splits text over two rows
     void showInputCode();          // Shows code entry interface
+    void showCodeMask();           // Updates the masked code field
+    void showClock();              // Updates the time
+    void showStats();              // Weekly counts and alarms by hour of day
+    void showZones();              // Zone grid screen
+    void showZoneTiles();          // Updates the zone grid tiles
+    void requestScreen(PanelScreen screen);  // Queues a redraw for the display consumer
 
     // Hardware Control Functions
-    void playTone(float frequency, float duration);  // Generates buzzer tones
     void updateLED(SystemState state);  // Updates RGB LED based on system state
 
-    // MCP23S17 Port Expander Functions
-    void writeMCP(uint8_t reg, uint8_t data);  // Writes to MCP23S17 registers
-    uint8_t readMCP(uint8_t reg);              // Reads from MCP23S17 registers
-    void initMCP();                            // Initializes MCP23S17
-    void setKeypadRow(int row);                // Sets active keypad row
-    uint8_t readKeypadCols();                  // Reads keypad columns
+    // Low-Power Idle
+    uint32_t idleBudget();         // Milliseconds the loop may sleep
+    void onSensorEdge();           // PIR/door interrupt
+    void onKeypadIrq();            // MCP23S17 INTB interrupt
+    void onKeypadSample();         // Scanner Ticker - a sample is due
+    void onRtcAlarm();             // DS3231 alarm interrupt
+    void onConsoleRx();            // Serial console bytes received
+    void onIdleReport();           // Prints idle statistics
+#if MBED_CONF_RTOS_PRESENT
+    void keypadTask();             // Keypad thread body
+    void displayTask();            // Display thread body
+    void loggerTask();             // Logger thread body
+    void addBusyTime(PanelTask task, uint32_t startUs);  // Accounts thread CPU time
+#endif
+
+    // Event Bus Producers and Consumers
+    void publish(PanelEventType type, const char* text = nullptr, uint16_t arg = 0);  // Publishes a panel event
+    void onLogEvent(const PanelEvent& event);          // SD card logger consumer
+    void onDisplayEvent(const PanelEvent& event);      // LCD consumer
+    void onAnnunciatorEvent(const PanelEvent& event);  // Buzzer/LED consumer
 
     // RTC (Real-Time Clock) Functions
     void initRTC();              // Initializes DS3231 RTC
-    uint8_t bcdToDec(uint8_t val);  // Converts BCD to decimal
-    uint8_t decToBcd(uint8_t val);  // Converts decimal to BCD
+    void serviceRtcAlarm();      // Clears DS3231 alarm flags and runs what fired
+    void programNextSchedule(bool afterPending = false);  // Loads the next transition into Alarm 1 (after now, or after the one that fired)
+    void runSchedule(ScheduleAction action);  // Performs a scheduled arm/disarm
     
     // Time Management Functions
     void setTime(int sec, int min, int hour, int day, int date, int month, int year);  // Sets RTC time
-    void getTime(int &sec, int &min, int &hour, int &day, int &date, int &month, int &year);  // Gets current time
-    char* getTimeStr();          // Gets formatted time string
+    void onTimeSync();           // Re-reads the DS3231 (sync timer)
+    void onDisciplineDue();      // Enables the minute edge for the next discipline sample
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "SerialConsole.h"
+
+// Route stdout/stderr through the console so text and frames share one ring
+namespace mbed {
+FileHandle* mbed_override_console(int fd) {
+    return &SerialConsole::instance();
+}
+}
+
+// Single instance - the UART can only have one owner
+SerialConsole& SerialConsole::instance() {
+    static SerialConsole console;
+    return console;
+}
+
+// Constructor
+// Attaching the receive interrupt keeps the UART clocked, which holds off
+// deep sleep - only done when the command console is enabled
+SerialConsole::SerialConsole() :
+    SerialBase(USBTX, USBRX, BAUD),
+    _lastRxMs(0),
+    _txActive(false),
+    _dropped(0)
+{
+#if MBED_CONF_APP_SERIAL_CONSOLE
+    SerialBase::attach(callback(this, &SerialConsole::onRx), RxIrq);
+#endif
+}
+
+// Drain the receive ring through the parser
+// A gap in the middle of a frame means the sender gave up - start over
+bool SerialConsole::readFrame(ConsoleFrame& frame) {
+    uint8_t byte;
+    bool gotByte = false;
+    uint64_t now = Kernel::get_ms_count();
+    while(_rx.pop(byte)) {
+        if(!gotByte && now - _lastRxMs > FRAME_GAP_MS) _parser.reset();
+        gotByte = true;
+        _lastRxMs = now;
+        if(_parser.feed(byte, frame)) return true;
+    }
+    return false;
+}
+
+// Encode on the stack, queue in one piece
+bool SerialConsole::sendFrame(uint8_t command, const uint8_t* payload, uint8_t length) {
+    uint8_t buf[CONSOLE_MAX_PAYLOAD + CONSOLE_OVERHEAD];
+    int size = encodeFrame(command, payload, length, buf);
+    return enqueue(buf, size);
+}
+
+// printf lands here - text that does not fit is dropped rather than waited for
+ssize_t SerialConsole::write(const void* buffer, size_t size) {
+    enqueue(static_cast<const uint8_t*>(buffer), size);
+    return size;
+}
+
+// stdin is not used; the receive ring belongs to the frame parser
+ssize_t SerialConsole::read(void* buffer, size_t size) {
+    return -EAGAIN;
+}
+
+// All or nothing, so a frame is never split by other output
+bool SerialConsole::enqueue(const uint8_t* data, uint32_t length) {
+    _txMutex.lock();
+    if(txSpace() < length) {
+        _txMutex.unlock();
+        core_util_atomic_incr_u32(&_dropped, length);
+        return false;
+    }
+    for(uint32_t i = 0; i < length; i++) {
+        _tx.push(data[i]);
+    }
+    _txMutex.unlock();
+    startTx();
+    return true;
+}
+
+// The interrupt only fires on a transition to empty, so the first bytes are
+// written here - inside a critical section, the ISR is the only other reader
+void SerialConsole::startTx() {
+    core_util_critical_section_enter();
+    if(!_txActive) {
+        onTx();
+    }
+    core_util_critical_section_exit();
+}
+
+// Fill the UART FIFO; detach once the ring is empty
+void SerialConsole::onTx() {
+    uint8_t byte;
+    while(SerialBase::writeable() && _tx.pop(byte)) {
+        _base_putc(byte);
+    }
+    bool more = !_tx.empty();
+    if(more != _txActive) {
+        _txActive = more;
+        SerialBase::attach(more ? callback(this, &SerialConsole::onTx) : Callback<void()>(), TxIrq);
+    }
+}
+
+// Move received bytes into the ring and wake the panel loop
+void SerialConsole::onRx() {
+    while(SerialBase::readable()) {
+        if(!_rx.push((uint8_t)_base_getc())) {
+            core_util_atomic_incr_u32(&_dropped, 1);
+        }
+    }
+    if(_notify) _notify();
+}
@@ -0,0 +1,78 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SpscQueue.h"     // Interrupt-fed byte rings
+#include "ConsoleProtocol.h"   // Frame format
+#include "platform/PlatformMutex.h"  // Real mutex in the RTOS profile, no-op on baremetal
+
+// Receive the command console (0 = debug output only, UART may deep sleep)
+#ifndef MBED_CONF_APP_SERIAL_CONSOLE
+#define MBED_CONF_APP_SERIAL_CONSOLE 1
+#endif
+
+// USB serial port shared by debug text and command frames
+// The console is also stdout: printf text and frames go through one
+// transmit ring, each write queued whole or not at all, so text never
+// lands inside a frame. The UART interrupt empties the ring in the
+// background - nothing here waits for the wire. When the ring is full,
+// text is dropped and frames are not sent; callers check txSpace() first
+// for anything they must not lose.
+// Received bytes are queued by the interrupt and decoded by readFrame() in
+// thread context.
+class SerialConsole : public FileHandle, private SerialBase {
+public:
+    static const int BAUD = 115200;             // USB serial speed
+    static const uint32_t TX_BUFFER = 1024;     // Transmit ring bytes
+    static const uint32_t RX_BUFFER = 256;      // Receive ring bytes
+    static const uint32_t FRAME_GAP_MS = 100;   // Silence that abandons a partial frame
+
+    // Returns: the console - constructed on first use, which may be the
+    //          first printf, before the panel itself exists
+    static SerialConsole& instance();
+
+    // Sets the handler for received data; called in interrupt context
+    void attach(Callback<void()> notify) { _notify = notify; }
+
+    // Decodes the next complete command frame from the received bytes
+    // Returns: true if frame holds a command
+    bool readFrame(ConsoleFrame& frame);
+
+    // Queues one frame
+    // Returns: false if it did not fit (nothing queued)
+    bool sendFrame(uint8_t command, const uint8_t* payload, uint8_t length);
+
+    // Returns: free transmit ring bytes
+    uint32_t txSpace() const { return TX_BUFFER - _tx.size(); }
+
+    // Returns: frames rejected for bad length or CRC
+    uint32_t badFrames() const { return _parser.badFrames(); }
+
+    // Returns: bytes dropped because a ring was full
+    uint32_t dropped() const { return _dropped; }
+
+    // FileHandle - stdout and stderr
+    ssize_t write(const void* buffer, size_t size) override;
+    ssize_t read(void* buffer, size_t size) override;
+    off_t seek(off_t offset, int whence = SEEK_SET) override { return -ESPIPE; }
+    int close() override { return 0; }
+    int isatty() override { return 1; }
+
+private:
+    SerialConsole();
+
+    SpscQueue<uint8_t, TX_BUFFER> _tx;  // Bytes waiting for the UART (ISR consumes)
+    SpscQueue<uint8_t, RX_BUFFER> _rx;  // Bytes received (ISR produces)
+    FrameParser _parser;                // Command frame decoder
+    uint64_t _lastRxMs;                 // When readFrame() last saw a byte
+    PlatformMutex _txMutex;             // One writer at a time - frames and printf from any thread
+    volatile bool _txActive;            // Transmit interrupt attached
+    volatile uint32_t _dropped;         // Overflow count
+    Callback<void()> _notify;           // Received data handler
+
+    bool enqueue(const uint8_t* data, uint32_t length);  // Queues all bytes or none
+    void startTx();                     // Primes the UART and enables its interrupt
+    void onTx();                        // Transmit holding register empty
+    void onRx();                        // Receive data available
+};
@@ -0,0 +1,53 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <atomic>          // Lock-free index updates
+#include <cstdint>         // Standard integer types
+
+// Fixed-capacity single-producer/single-consumer ring buffer
+// Storage is part of the object, so instances declared as members or
+// statics are allocated at link time. One context may push and one other
+// context may pop concurrently without locks.
+template<typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    // Adds an item
+    // Returns: false if the queue was full (item dropped)
+    bool push(const T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if(head - _tail.load(std::memory_order_acquire) >= N) return false;
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Removes the oldest item
+    // Returns: false if the queue was empty
+    bool pop(T& item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if(tail == _head.load(std::memory_order_acquire)) return false;
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns: number of items waiting (approximate while the other side runs)
+    uint32_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    // Returns: true if no items are waiting
+    bool empty() const { return size() == 0; }
+
+    // Returns: fixed capacity
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    T _items[N];                    // Item storage
+    std::atomic<uint32_t> _head;    // Next write position (producer owned)
+    std::atomic<uint32_t> _tail;    // Next read position (consumer owned)
+};
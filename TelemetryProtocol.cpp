@@ -0,0 +1,136 @@
+#include "TelemetryProtocol.h"
+#include <cstring>         // memset
+
+// Constructor - the first frame is a keyframe
+TelemetryEncoder::TelemetryEncoder() :
+    _seq(0),
+    _sinceKeyframe(0),
+    _keyframeDue(true)
+{
+    memset(&_sent, 0, sizeof(_sent));
+}
+
+// Keyframe when due, otherwise a delta of the fields that changed
+int TelemetryEncoder::encode(const TelemetrySnapshot& now, bool periodic, uint8_t* out) {
+    if(periodic && ++_sinceKeyframe >= TELEMETRY_KEYFRAME_EVERY) _keyframeDue = true;
+
+    uint8_t* p = out;
+    if(_keyframeDue) {
+        *p++ = TELEMETRY_KEYFRAME;
+        *p++ = _seq++;
+        p = putVarint(p, now.epoch);
+        p = putVarint(p, TLM_FIELD_COUNT);
+        for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+            p = putVarint(p, zigzag(now.field[i]));
+        }
+        _sent = now;
+        _keyframeDue = false;
+        _sinceKeyframe = 0;
+        return (int)(p - out);
+    }
+
+    uint32_t changed = 0;
+    for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if(now.field[i] != _sent.field[i]) changed |= 1u << i;
+    }
+    if(!periodic) {
+        changed &= TELEMETRY_EVENT_FIELDS;
+        if(!changed) return 0;
+    }
+
+    *p++ = TELEMETRY_DELTA;
+    *p++ = _seq++;
+    p = putVarint(p, now.epoch - _sent.epoch);
+    p = putVarint(p, changed);
+    for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if(changed & (1u << i)) {
+            p = putVarint(p, zigzag((int32_t)((uint32_t)now.field[i] - (uint32_t)_sent.field[i])));
+            _sent.field[i] = now.field[i];
+        }
+    }
+    _sent.epoch = now.epoch;
+    return (int)(p - out);
+}
+
+// Constructor - nothing known until a keyframe
+TelemetryDecoder::TelemetryDecoder() :
+    _seq(0),
+    _started(false),
+    _synced(false),
+    _lost(0)
+{
+    memset(&_snapshot, 0, sizeof(_snapshot));
+}
+
+// A gap in the sequence drops sync: the missed frame's deltas are unknown
+int32_t TelemetryDecoder::decode(const uint8_t* payload, int length) {
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + length;
+    if(length < 2) return -1;
+    uint8_t kind = *p++;
+    uint8_t seq = *p++;
+    if(kind != TELEMETRY_KEYFRAME && kind != TELEMETRY_DELTA) return -1;
+
+    if(_started && seq != (uint8_t)(_seq + 1)) {
+        _lost += (uint8_t)(seq - _seq - 1);
+        _synced = false;
+    }
+    _started = true;
+    _seq = seq;
+
+    uint32_t time;
+    uint32_t count;
+    if(!getVarint(p, end, time) || !getVarint(p, end, count)) return -1;
+
+    int32_t updated = 0;
+    if(kind == TELEMETRY_KEYFRAME) {
+        TelemetrySnapshot next = _snapshot;
+        next.epoch = time;
+        for(uint32_t i = 0; i < count; i++) {
+            uint32_t value;
+            if(!getVarint(p, end, value)) return -1;
+            if(i < TLM_FIELD_COUNT) next.field[i] = unzigzag(value);
+        }
+        _snapshot = next;
+        _synced = true;
+        return (int32_t)((1u << TLM_FIELD_COUNT) - 1);
+    }
+
+    // Delta: 'count' is the changed field mask
+    if(!_synced) return 0;
+    TelemetrySnapshot next = _snapshot;
+    next.epoch += time;
+    for(int i = 0; i < 32; i++) {
+        if(!(count & (1u << i))) continue;
+        uint32_t value;
+        if(!getVarint(p, end, value)) return -1;
+        if(i < TLM_FIELD_COUNT) {
+            next.field[i] = (int32_t)((uint32_t)next.field[i] + (uint32_t)unzigzag(value));
+            updated |= 1 << i;
+        }
+    }
+    _snapshot = next;
+    return updated;
+}
+
+// Seven bits at a time, high bit set on all but the last byte
+uint8_t* putVarint(uint8_t* p, uint32_t value) {
+    while(value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// At most five bytes for 32 bits
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for(int shift = 0; shift < 35; shift += 7) {
+        if(p >= end) return false;
+        uint8_t byte = *p++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
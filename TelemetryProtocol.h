@@ -0,0 +1,131 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+#include "ConsoleProtocol.h"   // Frame format and commands
+
+// Telemetry push frames, shared by the firmware and the host tools
+//
+// The panel pushes its state as a small table of integer fields, in frames
+// with CMD = TELEMETRY_PUSH and no result byte:
+//   KEYFRAME: kind, seq, epoch varint, field count varint, every field
+//             as a zigzag varint
+//   DELTA:    kind, seq, seconds since the previous frame varint, changed
+//             field mask varint, then each changed field's difference from
+//             its last sent value as a zigzag varint
+// Varints are 7 bits per byte, least significant group first. A receiver
+// that misses a sequence number ignores deltas until the next keyframe,
+// which comes every TELEMETRY_KEYFRAME_EVERY periodic frames or when
+// CMD_TELEMETRY asks for one. Unknown fields are skipped, so older hosts
+// keep working with newer firmware.
+
+static const uint8_t TELEMETRY_PUSH = CONSOLE_RESPONSE | CONSOLE_PUSH | CMD_TELEMETRY;   // CMD of pushed frames
+
+// Frame kinds
+static const uint8_t TELEMETRY_KEYFRAME = 1;        // All fields, absolute
+static const uint8_t TELEMETRY_DELTA = 2;           // Changed fields, relative
+
+static const uint8_t TELEMETRY_KEYFRAME_EVERY = 6;  // Periodic frames per keyframe
+
+// Fields - append only, the wire order is this order
+enum TelemetryField : uint8_t {
+    TLM_STATE,              // SystemState
+    TLM_MODE,               // PanelMode
+    TLM_ZONES,              // Bit per PanelZone: contact open / motion / object near
+    TLM_COUNTDOWN,          // Entry or exit delay seconds left, 0 = none
+    TLM_UPTIME_S,           // Seconds since boot
+    TLM_KEYS_DROPPED,       // Key events lost to a full key FIFO
+    TLM_EVENTS_DROPPED,     // Bus events lost to full consumer queues
+    TLM_BAD_FRAMES,         // Console frames rejected
+    TLM_TX_DROPPED,         // Console output bytes dropped
+    TLM_CLOCK_DRIFT_PPB,    // Kernel tick drift against the DS3231
+    TLM_CLOCK_ERROR_MS,     // Clock error bound
+    TLM_FIELD_COUNT
+};
+
+// Fields whose change is pushed at once; the rest wait for the period
+static const uint32_t TELEMETRY_EVENT_FIELDS =
+    (1u << TLM_STATE) | (1u << TLM_MODE) | (1u << TLM_ZONES) | (1u << TLM_COUNTDOWN);
+
+// Largest payload encode() produces: kind, seq, 5-byte epoch, count, fields
+static const uint8_t TELEMETRY_MAX_PAYLOAD = 3 + 5 + 5 * TLM_FIELD_COUNT;
+
+// Field values at one moment
+struct TelemetrySnapshot {
+    uint32_t epoch;                         // Unix seconds
+    int32_t field[TLM_FIELD_COUNT];         // Indexed by TelemetryField
+};
+
+// Panel side - turns snapshots into push payloads
+// Deltas are taken against the values last sent, so a field that changes
+// and changes back between frames costs nothing.
+class TelemetryEncoder {
+public:
+    TelemetryEncoder();
+
+    // Makes the next frame a keyframe
+    void requestKeyframe() { _keyframeDue = true; }
+
+    // Encodes the fields that need sending
+    // Parameters:
+    //   now:      Current values
+    //   periodic: true for the periodic frame (all changes, always sent);
+    //             false for a check between periods (event fields only)
+    //   out:      Destination, at least TELEMETRY_MAX_PAYLOAD bytes
+    // Returns: payload length, 0 if there is nothing to send
+    int encode(const TelemetrySnapshot& now, bool periodic, uint8_t* out);
+
+private:
+    TelemetrySnapshot _sent;        // Values the receiver holds
+    uint8_t _seq;                   // Next sequence number
+    uint8_t _sinceKeyframe;         // Periodic frames since the last keyframe
+    bool _keyframeDue;              // Next frame is a keyframe
+};
+
+// Host side - rebuilds the panel's snapshot from push payloads
+class TelemetryDecoder {
+public:
+    TelemetryDecoder();
+
+    // Applies one push payload
+    // Returns: mask of fields updated (0 for a delta while out of sync),
+    //          or -1 if the payload is malformed
+    int32_t decode(const uint8_t* payload, int length);
+
+    // Returns: true once a keyframe has been applied and no frame was missed since
+    bool synced() const { return _synced; }
+
+    // Returns: the last known values
+    const TelemetrySnapshot& snapshot() const { return _snapshot; }
+
+    // Returns: frames missed, counted from sequence gaps
+    uint32_t lost() const { return _lost; }
+
+private:
+    TelemetrySnapshot _snapshot;    // Current values
+    uint8_t _seq;                   // Sequence number of the last frame
+    bool _started;                  // Any frame seen
+    bool _synced;                   // Deltas can be applied
+    uint32_t _lost;                 // Missed frame count
+};
+
+// Unsigned LEB128 varint
+// Returns: position after the value
+uint8_t* putVarint(uint8_t* p, uint32_t value);
+
+// Reads a varint
+// Parameters:
+//   p:     Read position, advanced past the value
+//   end:   End of the data
+//   value: Receives the value
+// Returns: false if the data ends inside the value or it is too long
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value);
+
+// Signed values as varints: small magnitudes of either sign stay short
+inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
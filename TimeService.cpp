@@ -0,0 +1,228 @@
+#include "TimeService.h"
+#include "FastFormat.h"     // Timestamp writers
+
+static const uint32_t SECONDS_PER_DAY = 86400;
+static const uint32_t DAYS_PER_CYCLE = 4 * 365 + 1;     // Four years, first one leap (2000, 2004...)
+
+// Day of year each month starts on, [leap][month 0-12]
+static const uint16_t MONTH_START[2][13] = {
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
+};
+
+// Day of the four-year cycle each year starts on
+static const uint16_t YEAR_START[5] = { 0, 366, 731, 1096, 1461 };
+
+// Constructor - not synced yet
+TimeService::TimeService(DS3231& rtc) :
+    _rtc(rtc),
+    _lastSync(0),
+    _baseTick(0),
+    _baseMs(0),
+    _pendingMs(0),
+    _driftPpb(0),
+    _driftErrPpb(DRIFT_UNKNOWN_PPB),
+    _intervalS(SAMPLE_MIN_S),
+    _samples(0),
+    _lastOffsetMs(0)
+{
+}
+
+// Whole-second DS3231 read - starts the local clock, then only guards it
+bool TimeService::sync() {
+    RtcTime time;
+    if(!_rtc.readTime(time)) return false;
+    uint32_t epoch = toEpoch(time);
+    if(epoch == 0) return false;    // Oscillator stopped or never set
+    _lastSync = epoch;
+
+    // The chip counts the day of week on its own from whatever was last
+    // written; weekly Alarm 1 matches it, so keep it on 1 = Sunday
+    RtcTime derived;
+    toCalendar(epoch, derived);
+    if(time.day != derived.day) _rtc.writeDay(derived.day);
+
+    // The read lands somewhere inside the second; assume the middle
+    uint64_t tick = Kernel::get_ms_count();
+    int64_t offset = (int64_t)epoch * 1000 + 500 - (int64_t)localAt(tick);
+    if(_samples == 0 || offset > STEP_MS || offset < -STEP_MS) {
+        step(tick, (uint64_t)epoch * 1000 + 500);
+    }
+    return true;
+}
+
+// Set both clocks
+// Writing the seconds register restarts the DS3231's divider, so the new
+// second begins at the write
+bool TimeService::set(const RtcTime& time) {
+    uint32_t epoch = toEpoch(time);
+    if(epoch == 0) return false;
+    RtcTime stored = time;
+    toCalendar(epoch, stored);      // Derive a consistent day of week
+    if(!_rtc.writeTime(stored)) return false;
+    step(Kernel::get_ms_count(), (uint64_t)epoch * 1000);
+    _lastSync = epoch;
+    return true;
+}
+
+// One discipline step at a DS3231 second boundary
+// The measured offset is made of two parts: what the previous sample found
+// but had not finished slewing in, and what built up since from the error in
+// the drift estimate. Only the second part says anything about the drift.
+void TimeService::discipline(uint64_t edgeMs, uint32_t epoch) {
+    uint64_t refMs = (uint64_t)epoch * 1000;
+    _lastSync = epoch;
+
+    // First edge after a step - only the phase is known so far
+    if(_samples == 0) {
+        step(edgeMs, refMs);
+        _samples = 1;
+        return;
+    }
+
+    uint64_t elapsed = edgeMs - _baseTick;
+    uint64_t localMs = localAt(edgeMs);
+    int64_t offset = (int64_t)(refMs - localMs);
+    if(offset > STEP_MS || offset < -STEP_MS || elapsed == 0) {
+        step(edgeMs, refMs);        // Clock was reset or the edge is not the one expected
+        _samples = 1;
+        return;
+    }
+
+    int32_t unslewed = _pendingMs - slewedAt(_pendingMs, elapsed);
+    int64_t accrued = offset - unslewed;
+    int32_t correction = (int32_t)(accrued * 1000000000 / (int64_t)elapsed);
+
+    // First estimate is taken whole, later ones averaged in
+    int32_t drift = _driftPpb + (_samples == 1 ? correction : correction / 2);
+    if(drift > MAX_DRIFT_PPB) drift = MAX_DRIFT_PPB;
+    if(drift < -MAX_DRIFT_PPB) drift = -MAX_DRIFT_PPB;
+
+    // Rebase at the extrapolated time, not the reference, so nothing jumps
+    // The new drift only holds from the new base, so both change together
+    core_util_critical_section_enter();
+    _driftPpb = drift;
+    _driftErrPpb = correction < 0 ? -correction : correction;
+    _baseTick = edgeMs;
+    _baseMs = localMs;
+    _pendingMs = (int32_t)offset;
+    core_util_critical_section_exit();
+    _lastOffsetMs = (int32_t)offset;
+    _samples++;
+
+    // Stretch the spacing while samples agree, shorten it when they do not
+    int32_t size = offset < 0 ? -offset : offset;
+    if(size <= 2 && _intervalS < SAMPLE_MAX_S) {
+        _intervalS *= 2;
+    } else if(size > 5 && _intervalS > SAMPLE_MIN_S) {
+        _intervalS /= 2;
+    }
+}
+
+// Error bound - 1 ms for the tick resolution of the edge timestamp
+// Before the first edge only the whole-second read is known
+uint32_t TimeService::errorMs() const {
+    core_util_critical_section_enter();
+    uint32_t samples = _samples;
+    uint64_t baseTick = _baseTick;
+    int32_t pendingMs = _pendingMs;
+    uint32_t driftErrPpb = _driftErrPpb;
+    core_util_critical_section_exit();
+
+    if(samples == 0) return 500;
+    uint64_t elapsed = Kernel::get_ms_count() - baseTick;
+    int32_t unslewed = pendingMs - slewedAt(pendingMs, elapsed);
+    if(unslewed < 0) unslewed = -unslewed;
+    return 1 + unslewed + (uint32_t)(elapsed * driftErrPpb / 1000000000);
+}
+
+// "Clock drift 12345 ppb, error 3 ms, last offset -2 ms, next sample 960 s"
+void TimeService::report(char* buf, int size) const {
+    snprintf(buf, size, "Clock drift %ld ppb, error %lu ms, last offset %ld ms, next sample %lu s",
+             (long)_driftPpb, (unsigned long)errorMs(), (long)_lastOffsetMs,
+             (unsigned long)_intervalS);
+}
+
+// Tick count, corrected for drift, plus as much of the pending offset as
+// the slew limit allows since the rebase
+// The rebase fields are copied in one go; a 64-bit field read while the
+// discipline thread rewrites it could otherwise come out half old, half new
+uint64_t TimeService::localAt(uint64_t tick) const {
+    core_util_critical_section_enter();
+    uint64_t baseTick = _baseTick;
+    uint64_t baseMs = _baseMs;
+    int32_t pendingMs = _pendingMs;
+    int32_t driftPpb = _driftPpb;
+    core_util_critical_section_exit();
+
+    uint64_t elapsed = tick - baseTick;
+    int64_t drift = (int64_t)elapsed * driftPpb / 1000000000;
+    return baseMs + elapsed + drift + slewedAt(pendingMs, elapsed);
+}
+
+// Slew is linear in elapsed time and stops once the offset is used up
+int32_t TimeService::slewedAt(int32_t pendingMs, uint64_t elapsed) {
+    int64_t limit = (int64_t)elapsed * SLEW_PPM / 1000000;
+    if(pendingMs >= 0) return limit < pendingMs ? (int32_t)limit : pendingMs;
+    return -limit > pendingMs ? (int32_t)-limit : pendingMs;
+}
+
+// Hard restart - only at boot, when the time is set, or on a gross error
+void TimeService::step(uint64_t tick, uint64_t ms) {
+    core_util_critical_section_enter();
+    _baseTick = tick;
+    _baseMs = ms;
+    _pendingMs = 0;
+    _samples = 0;
+    core_util_critical_section_exit();
+    _intervalS = SAMPLE_MIN_S;
+}
+
+// Calendar fields to epoch - three table lookups, no loops
+uint32_t TimeService::toEpoch(const RtcTime& time) {
+    if(time.year > 99 || time.month < 1 || time.month > 12 || time.date < 1 || time.date > 31 ||
+       time.hour > 23 || time.min > 59 || time.sec > 59) {
+        return 0;
+    }
+    int leap = (time.year % 4) == 0;
+    uint32_t days = (time.year / 4) * DAYS_PER_CYCLE + YEAR_START[time.year % 4] +
+                    MONTH_START[leap][time.month - 1] + time.date - 1;
+    return EPOCH_2000 + days * SECONDS_PER_DAY + time.hour * 3600 + time.min * 60 + time.sec;
+}
+
+// Epoch to calendar fields
+// The month guess day/32 is never past the right month and at most one short
+void TimeService::toCalendar(uint32_t epoch, RtcTime& time) {
+    uint32_t seconds = epoch > EPOCH_2000 ? epoch - EPOCH_2000 : 0;
+    uint32_t days = seconds / SECONDS_PER_DAY;
+    uint32_t secondOfDay = seconds % SECONDS_PER_DAY;
+
+    uint32_t dayOfCycle = days % DAYS_PER_CYCLE;
+    int year = 0;
+    while(dayOfCycle >= YEAR_START[year + 1]) year++;      // At most three steps
+    int leap = (year == 0);
+    uint32_t dayOfYear = dayOfCycle - YEAR_START[year];
+
+    int month = dayOfYear >> 5;
+    if(dayOfYear >= MONTH_START[leap][month + 1]) month++;
+
+    time.year = (days / DAYS_PER_CYCLE) * 4 + year;
+    time.month = month + 1;
+    time.date = dayOfYear - MONTH_START[leap][month] + 1;
+    time.day = (days + 6) % 7 + 1;                          // 2000-01-01 was a Saturday
+    time.hour = secondOfDay / 3600;
+    time.min = (secondOfDay / 60) % 60;
+    time.sec = secondOfDay % 60;
+}
+
+// Full timestamp for log entries
+void TimeService::formatDateTime(uint32_t epoch, char* buf) {
+    RtcTime t;
+    toCalendar(epoch, t);
+    *fmtIsoDateTime(buf, t) = '\0';
+}
+
+// Time of day only
+void TimeService::formatTime(uint32_t epoch, char* buf) {
+    *fmtTimeOfDay(buf, epoch % SECONDS_PER_DAY) = '\0';
+}
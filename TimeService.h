@@ -0,0 +1,117 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "DS3231.h"        // Reference clock
+
+// Epoch-based panel time
+// Time is extrapolated from the kernel millisecond tick, so now() costs no
+// I2C traffic. The DS3231 is the reference: discipline() is given the tick
+// at which a DS3231 second boundary was seen (the Alarm 2 edge on INT/SQW)
+// and compares it with the extrapolated time. The offset is slewed in at
+// most SLEW_PPM rather than stepped, so the clock never jumps or runs
+// backwards, and the part of the offset that built up since the previous
+// sample corrects the estimated drift of the MCU crystal. Samples start a
+// minute apart and stretch to hours once the drift estimate settles.
+// Timestamps are kept as 32-bit Unix seconds and broken down into calendar
+// fields only when shown or logged, by table lookup rather than mktime/gmtime.
+// Valid for 2000-01-01 to 2099-12-31, the DS3231's range.
+// sync(), set() and discipline() belong to one thread; nowMs(), now() and
+// errorMs() may be called from any other, as the rebase fields they read are
+// written and copied inside a critical section.
+class TimeService {
+public:
+    static const uint32_t SYNC_INTERVAL_MS = 3600000;   // Coarse DS3231 cross-check interval (1 h)
+    static const uint32_t EPOCH_2000 = 946684800;       // 2000-01-01 00:00:00 UTC
+    static const uint32_t SAMPLE_MIN_S = 60;            // Discipline sample spacing while settling
+    static const uint32_t SAMPLE_MAX_S = 4 * 3600;      // Spacing once the drift estimate holds
+    static const int32_t SLEW_PPM = 500;                // Fastest phase correction, 0.5 ms per second
+    static const int32_t STEP_MS = 1000;                // Larger offsets are stepped, not slewed
+    static const int32_t MAX_DRIFT_PPB = 500000;        // Drift estimate limit (500 ppm)
+    static const uint32_t DRIFT_UNKNOWN_PPB = 100000;   // Assumed uncertainty before two edges (100 ppm)
+
+    // Constructor
+    // Parameters:
+    //   rtc: DS3231 holding the reference time
+    TimeService(DS3231& rtc);
+
+    // Reads the DS3231 and starts the local clock from it if not yet
+    // disciplined; afterwards only a disagreement over STEP_MS is acted on.
+    // A day of week register that disagrees with the date is rewritten.
+    // Returns: true if the DS3231 answered with a valid time
+    bool sync();
+
+    // Writes a new time to the DS3231 and restarts the local clock from it
+    // Returns: true if the DS3231 accepted it
+    bool set(const RtcTime& time);
+
+    // Feeds one DS3231 second boundary into the discipline loop
+    // Parameters:
+    //   edgeMs: Kernel tick (ms) when the boundary was seen
+    //   epoch:  Unix second that started at the boundary
+    void discipline(uint64_t edgeMs, uint32_t epoch);
+
+    // Returns: current time in Unix milliseconds
+    uint64_t nowMs() const { return localAt(Kernel::get_ms_count()); }
+
+    // Returns: current time in Unix seconds
+    uint32_t now() const { return (uint32_t)(nowMs() / 1000); }
+
+    // Returns: epoch of the last DS3231 read or sample, 0 if never synced
+    uint32_t lastSync() const { return _lastSync; }
+
+    // Returns: time until the next discipline sample is wanted (ms)
+    uint32_t sampleIntervalMs() const { return _intervalS * 1000; }
+
+    // Returns: estimated drift of the kernel tick against the DS3231,
+    //          parts per billion (positive = tick runs slow)
+    int32_t driftPpb() const { return _driftPpb; }
+
+    // Estimated error of nowMs() against the DS3231: the offset still being
+    // slewed in, plus the drift uncertainty integrated since the last sample
+    // Returns: error bound in ms
+    uint32_t errorMs() const;
+
+    // Formats drift, error bound and sample spacing for the debug serial port
+    // Parameters:
+    //   buf:  Output buffer
+    //   size: Buffer size
+    void report(char* buf, int size) const;
+
+    // Converts calendar fields to Unix seconds
+    // Returns: epoch, or 0 if a field is out of range
+    static uint32_t toEpoch(const RtcTime& time);
+
+    // Breaks Unix seconds into calendar fields
+    // The day of week is derived from the date: 1 = Sunday ... 7 = Saturday
+    static void toCalendar(uint32_t epoch, RtcTime& time);
+
+    // Formats "YYYY-MM-DD HH:MM:SS"
+    // Parameters:
+    //   epoch: Time to format
+    //   buf:   Output buffer, at least 20 bytes
+    static void formatDateTime(uint32_t epoch, char* buf);
+
+    // Formats "HH:MM:SS" - no calendar breakdown needed
+    // Parameters:
+    //   epoch: Time to format
+    //   buf:   Output buffer, at least 9 bytes
+    static void formatTime(uint32_t epoch, char* buf);
+
+private:
+    DS3231& _rtc;               // Reference clock
+    uint32_t _lastSync;         // Epoch of the last DS3231 read or sample
+    uint64_t _baseTick;         // Kernel tick the local clock was last rebased at
+    uint64_t _baseMs;           // Local Unix ms at _baseTick
+    int32_t _pendingMs;         // Offset being slewed in from _baseTick on
+    int32_t _driftPpb;          // Estimated tick rate error
+    uint32_t _driftErrPpb;      // Size of the last drift correction - its uncertainty
+    uint32_t _intervalS;        // Current sample spacing
+    uint32_t _samples;          // Edges seen since the last step, 0 = not locked
+    int32_t _lastOffsetMs;      // Offset measured at the last sample
+
+    uint64_t localAt(uint64_t tick) const;      // Extrapolated Unix ms at a kernel tick
+    static int32_t slewedAt(int32_t pendingMs, uint64_t elapsed);  // Part of an offset applied after elapsed ms
+    void step(uint64_t tick, uint64_t ms);      // Restart the local clock, discarding the offset
+};
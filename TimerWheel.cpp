@@ -0,0 +1,128 @@
+#include "TimerWheel.h"
+
+// Storage for constants passed by reference (chrono conversions)
+const uint32_t TimerWheel::TICK_MS;
+
+// Constructor - empty wheel
+TimerWheel::TimerWheel() :
+    _cursor(0),
+    _ticksDone(0)
+{
+    memset(_slots, 0, sizeof(_slots));
+}
+
+// Start the time base
+void TimerWheel::begin() {
+    _clock.reset();
+    _clock.start();
+}
+
+// Milliseconds on the time base
+uint64_t TimerWheel::elapsedMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(_clock.elapsed_time()).count();
+}
+
+// Schedule a timer
+void TimerWheel::start(WheelTimer& timer, uint32_t delayMs, mbed::Callback<void()> callback, bool periodic) {
+    _mutex.lock();
+    if(timer._active) unlink(timer);
+
+    uint32_t ticks = (delayMs + TICK_MS - 1) / TICK_MS;
+    if(ticks == 0) ticks = 1;    // Never fire within the current tick
+
+    timer._callback = callback;
+    timer._periodTicks = periodic ? ticks : 0;
+    insert(timer, ticks);
+    _mutex.unlock();
+}
+
+// Cancel a timer
+void TimerWheel::cancel(WheelTimer& timer) {
+    _mutex.lock();
+    if(timer._active) unlink(timer);
+    _mutex.unlock();
+}
+
+// Process every tick that elapsed since the last call
+// Expired timers are first moved to a separate list and only then fired, so a
+// callback may freely start or cancel any timer, including other expired ones
+void TimerWheel::service() {
+    _mutex.lock();
+    uint64_t now = elapsedMs() / TICK_MS;
+    uint32_t ticks = (uint32_t)(now - _ticksDone);
+    _ticksDone = now;
+
+    while(ticks--) {
+        _cursor = (_cursor + 1) & (SLOTS - 1);
+
+        // Age this slot's timers and collect the ones that are due
+        WheelTimer* t = _slots[_cursor];
+        while(t) {
+            WheelTimer* next = t->_next;
+            if(t->_rounds > 0) {
+                t->_rounds--;
+            } else {
+                unlink(*t);
+                link(*t, SLOTS);
+            }
+            t = next;
+        }
+
+        // Fire them
+        while(_slots[SLOTS]) {
+            WheelTimer& due = *_slots[SLOTS];
+            unlink(due);
+            if(due._periodTicks) insert(due, due._periodTicks);
+            if(due._callback) due._callback();
+        }
+    }
+    _mutex.unlock();
+}
+
+// Time until the earliest expiry
+// Slots are walked outward from the cursor; a timer found at distance d with
+// no rounds left is due in exactly d ticks and nothing further out can beat it
+uint32_t TimerWheel::msUntilNext() {
+    _mutex.lock();
+    uint64_t nowMs = elapsedMs();
+    uint32_t best = NONE_PENDING;
+    if(nowMs / TICK_MS > _ticksDone) best = 0;    // Service is behind
+
+    for(uint32_t d = 1; d <= SLOTS && best > d; d++) {
+        for(WheelTimer* t = _slots[(_cursor + d) & (SLOTS - 1)]; t; t = t->_next) {
+            uint32_t due = d + t->_rounds * SLOTS;
+            if(due < best) best = due;
+        }
+    }
+    _mutex.unlock();
+    if(best == 0 || best == NONE_PENDING) return best;
+
+    // Part of the current tick has already gone by
+    uint32_t intoTick = (uint32_t)(nowMs - _ticksDone * TICK_MS);
+    return best * TICK_MS - intoTick;
+}
+
+// Link a timer into the slot 'ticks' ahead of the cursor
+void TimerWheel::insert(WheelTimer& timer, uint32_t ticks) {
+    timer._rounds = (ticks - 1) / SLOTS;    // Slot is visited once per revolution
+    link(timer, (_cursor + ticks) & (SLOTS - 1));
+}
+
+// Push a timer onto the front of a list
+void TimerWheel::link(WheelTimer& timer, uint16_t slot) {
+    timer._slot = slot;
+    timer._prev = nullptr;
+    timer._next = _slots[slot];
+    if(timer._next) timer._next->_prev = &timer;
+    _slots[slot] = &timer;
+    timer._active = true;
+}
+
+// Unlink a timer from whichever list holds it
+void TimerWheel::unlink(WheelTimer& timer) {
+    if(timer._prev) timer._prev->_next = timer._next;
+    else _slots[timer._slot] = timer._next;
+    if(timer._next) timer._next->_prev = timer._prev;
+    timer._next = timer._prev = nullptr;
+    timer._active = false;
+}
@@ -0,0 +1,84 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include "platform/PlatformMutex.h"  // Real mutex in the RTOS profile, no-op on baremetal
+#include <cstdint>         // Standard integer types
+
+// One timer owned by the code that uses it (usually a class member)
+// Timers are intrusive list nodes, so the wheel never allocates
+class WheelTimer {
+public:
+    WheelTimer() : _next(nullptr), _prev(nullptr), _rounds(0), _periodTicks(0), _slot(0), _active(false) {}
+
+    // Returns: true if the timer is scheduled and has not yet fired
+    bool active() const { return _active; }
+
+private:
+    friend class TimerWheel;
+    WheelTimer* _next;              // Next timer in the same wheel slot
+    WheelTimer* _prev;              // Previous timer in the same wheel slot
+    uint32_t _rounds;               // Full wheel revolutions left before expiry
+    uint32_t _periodTicks;          // Reload interval for periodic timers, 0 = one-shot
+    uint16_t _slot;                 // List holding the timer (SLOTS = expired list)
+    bool _active;                   // Linked into the wheel
+    mbed::Callback<void()> _callback;   // Called from service() on expiry
+};
+
+// Hashed timer wheel driving every panel timeout from one time base
+// The wheel is tickless: there is no periodic interrupt. service() in the main
+// loop catches up on every tick that elapsed on a free-running clock and runs
+// expired callbacks in thread context; msUntilNext() tells the idle loop how
+// long it may sleep. The clock runs on the low power ticker where the target
+// has one, so it does not hold off deep sleep; otherwise it is a plain Timer,
+// which keeps the sleep manager out of deep sleep while the wheel runs.
+// start/cancel are O(1); expiry costs O(timers in the current slot).
+// Any thread may start or cancel timers; callbacks run in the thread calling
+// service() with the wheel locked, so they must stay short.
+class TimerWheel {
+public:
+    static const uint32_t TICK_MS = 10;     // Wheel resolution
+    static const int SLOTS = 256;           // Power of two - 2.56 s per revolution
+    static const uint32_t NONE_PENDING = 0xFFFFFFFF;  // msUntilNext() with no active timer
+
+    TimerWheel();
+
+    // Starts the time base
+    void begin();
+
+    // Schedules a timer, replacing any previous schedule of the same timer
+    // Parameters:
+    //   timer:    Timer to schedule
+    //   delayMs:  Time until first expiry (rounded up to whole ticks)
+    //   callback: Function called on expiry (none for a plain holdoff timer)
+    //   periodic: Re-arm with the same delay after every expiry
+    void start(WheelTimer& timer, uint32_t delayMs,
+               mbed::Callback<void()> callback = nullptr, bool periodic = false);
+
+    // Removes a timer from the wheel; harmless if it is not active
+    void cancel(WheelTimer& timer);
+
+    // Advances the wheel by all ticks elapsed since the last call and runs
+    // expired callbacks. Call from the main loop only.
+    void service();
+
+    // Returns: milliseconds until the earliest active timer expires
+    // (0 if ticks are waiting for service(), NONE_PENDING if nothing is scheduled)
+    uint32_t msUntilNext();
+
+private:
+    WheelTimer* _slots[SLOTS + 1];  // Head of each slot's timer list, plus the expired list
+    uint32_t _cursor;               // Slot of the current tick
+    uint64_t _ticksDone;            // Ticks processed since begin()
+#if DEVICE_LPTICKER
+    LowPowerTimer _clock;           // Free-running time base, runs through deep sleep
+#else
+    Timer _clock;                   // Free-running time base (holds the deep sleep lock)
+#endif
+    PlatformMutex _mutex;           // Serializes list changes between threads (recursive)
+
+    uint64_t elapsedMs();                               // Milliseconds since begin()
+    void insert(WheelTimer& timer, uint32_t ticks);     // Links a timer ticks ahead of the cursor
+    void link(WheelTimer& timer, uint16_t slot);        // Pushes a timer onto a list
+    void unlink(WheelTimer& timer);                     // Removes a timer from its list
+};
@@ -0,0 +1,281 @@
+#include "UserCodeStore.h"
+#include "Checksum.h"      // CRC-32 for the persisted image
+#include <cstddef>         // offsetof
+#include "hal/us_ticker_api.h"  // Free-running microsecond counter for salt entropy
+
+// Factory code - only used to provision the first master user when the
+// card holds no database at all. Change it with "panelctl user" after installation.
+static const char DEFAULT_MASTER_CODE[] = "2580";
+
+// File name of the database on the SD card
+static const char USERS_FILE[] = "users.dat";
+
+// SipHash-2-4 helpers
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIPROUND                                                        \
+    do {                                                                \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);   \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                        \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                        \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);   \
+    } while(0)
+
+// Load a little-endian 64-bit word
+static uint64_t load64(const uint8_t* p) {
+    uint64_t v = 0;
+    for(int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// SipHash-2-4 of a short message under a 128-bit key
+static uint64_t sipHash(const uint8_t key[16], const uint8_t* msg, int length) {
+    uint64_t k0 = load64(key);
+    uint64_t k1 = load64(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+    uint64_t b = ((uint64_t)length) << 56;
+
+    // Full 8-byte blocks
+    int i = 0;
+    for(; i + 8 <= length; i += 8) {
+        uint64_t m = load64(msg + i);
+        v3 ^= m;
+        SIPROUND; SIPROUND;
+        v0 ^= m;
+    }
+    // Remaining bytes
+    for(int j = 0; i < length; i++, j++) {
+        b |= ((uint64_t)msg[i]) << (8 * j);
+    }
+    v3 ^= b;
+    SIPROUND; SIPROUND;
+    v0 ^= b;
+
+    // Finalization
+    v2 ^= 0xFF;
+    SIPROUND; SIPROUND; SIPROUND; SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#undef SIPROUND
+#undef ROTL64
+
+// Compare two buffers in time independent of where they differ
+static bool constantTimeEqual(const uint8_t* a, const uint8_t* b, int length) {
+    uint8_t diff = 0;
+    for(int i = 0; i < length; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+// Constructor - start with an empty, unavailable database
+UserCodeStore::UserCodeStore() :
+    _available(false)
+{
+    memset(&_image, 0, sizeof(_image));
+    memset(_index, INDEX_EMPTY, sizeof(_index));
+}
+
+// Load the database from the SD card; provision a default only if the file is absent
+bool UserCodeStore::load(SDCard& sd) {
+    _available = false;
+    if(!sd.isMounted()) {
+        printf("User database unavailable (no SD card), codes refused\n");
+        return false;
+    }
+
+    int got = sd.readFile(USERS_FILE, &_image, sizeof(_image));
+    bool intact = got == (int)sizeof(_image) &&
+                  _image.header.magic == MAGIC &&
+                  _image.header.slots == MAX_USERS;
+    if(intact && _image.header.version == FORMAT && _image.header.crc == imageCrc()) {
+        rebuildIndex();
+        _available = true;
+        return true;
+    }
+    if(intact && _image.header.version == 1 &&
+       _image.header.crc == crc32(_image.records, sizeof(_image.records))) {
+        // Version 1 checked only the records - rewrite with the header covered too
+        rebuildIndex();
+        _available = true;
+        _image.header.version = FORMAT;
+        if(!save(sd)) printf("User database not upgraded\n");
+        return true;
+    }
+
+    if(got != SDCard::FILE_MISSING) {
+        // Damaged or unreadable - keep the file, never replace it with the factory code
+        if(got < 0) printf("User database unreadable, codes refused\n");
+        else printf("User database damaged (%d bytes), codes refused\n", got);
+        memset(&_image, 0, sizeof(_image));
+        rebuildIndex();
+        return false;
+    }
+
+    // The card confirms there is no file - first installation. createFile
+    // refuses to replace a file, so a database that shows up after all is kept
+    printf("No user database, provisioning default\n");
+    provisionDefault();
+    _image.header.crc = imageCrc();
+    if(!sd.createFile(USERS_FILE, &_image, sizeof(_image))) {
+        printf("User database not created, codes refused\n");
+        memset(&_image, 0, sizeof(_image));
+        rebuildIndex();
+        return false;
+    }
+    _available = true;
+    return true;
+}
+
+// Write the database to the SD card
+bool UserCodeStore::save(SDCard& sd) {
+    if(!_available) return false;
+    _image.header.crc = imageCrc();
+    return sd.writeFile(USERS_FILE, &_image, sizeof(_image));
+}
+
+// Checksum of the header up to the CRC field, then the records - a damaged
+// pepper would otherwise go unnoticed and silently reject every code
+uint32_t UserCodeStore::imageCrc() const {
+    uint32_t crc = crc32(&_image.header, offsetof(Header, crc));
+    return crc32(_image.records, sizeof(_image.records), crc);
+}
+
+// Find the slot owning a code
+// The index narrows the search to slots sharing the code's 16-bit tag;
+// only those candidates pay for the salted digest and constant-time compare
+int UserCodeStore::lookup(const char* code) const {
+    uint16_t tag = codeTag(code);
+    int match = NO_USER;
+
+    for(int probe = 0; probe < INDEX_SIZE; probe++) {
+        uint8_t slot = _index[(tag + probe) & (INDEX_SIZE - 1)];
+        if(slot == INDEX_EMPTY) break;
+
+        const UserRecord& rec = _image.records[slot];
+        if(rec.tag != tag) continue;
+
+        uint8_t digest[8];
+        codeDigest(rec.salt, code, digest);
+        if(constantTimeEqual(digest, rec.digest, sizeof(digest))) {
+            match = slot;
+        }
+    }
+    return match;
+}
+
+// Return permissions of a slot
+uint8_t UserCodeStore::permissions(int slot) const {
+    if(slot < 0 || slot >= MAX_USERS) return 0;
+    return _image.records[slot].perms;
+}
+
+// Create or replace a user
+bool UserCodeStore::setUser(int slot, const char* code, uint8_t perms) {
+    if(slot < 0 || slot >= MAX_USERS || perms == 0) return false;
+
+    // Codes must be unique across users
+    int owner = lookup(code);
+    if(owner != NO_USER && owner != slot) return false;
+
+    UserRecord& rec = _image.records[slot];
+    randomBytes(rec.salt, sizeof(rec.salt));
+    codeDigest(rec.salt, code, rec.digest);
+    rec.tag = codeTag(code);
+    rec.perms = perms;
+    rec.reserved = 0;
+
+    // Tag may have changed, so rebuild rather than patch in place
+    rebuildIndex();
+    return true;
+}
+
+// Clear a user slot
+bool UserCodeStore::removeUser(int slot) {
+    if(permissions(slot) == 0) return false;
+    memset(&_image.records[slot], 0, sizeof(UserRecord));
+    rebuildIndex();
+    return true;
+}
+
+// Count slots in use that hold every permission asked for
+int UserCodeStore::userCount(uint8_t perms) const {
+    int count = 0;
+    for(int i = 0; i < MAX_USERS; i++) {
+        uint8_t held = _image.records[i].perms;
+        if(held && (held & perms) == perms) count++;
+    }
+    return count;
+}
+
+// Keyed 16-bit tag of a code - keyed with the pepper so it is not a plain code hash
+uint16_t UserCodeStore::codeTag(const char* code) const {
+    uint8_t key[16];
+    memcpy(key, _image.header.pepper, 8);
+    memset(key + 8, 0xA5, 8);    // Domain separation from codeDigest
+    return (uint16_t)sipHash(key, (const uint8_t*)code, CODE_LENGTH);
+}
+
+// Salted digest of a code
+void UserCodeStore::codeDigest(const uint8_t salt[8], const char* code, uint8_t out[8]) const {
+    uint8_t key[16];
+    memcpy(key, salt, 8);
+    memcpy(key + 8, _image.header.pepper, 8);
+    uint64_t h = sipHash(key, (const uint8_t*)code, CODE_LENGTH);
+    for(int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(h >> (8 * i));
+    }
+}
+
+// Rebuild the open-addressed index from the records
+void UserCodeStore::rebuildIndex() {
+    memset(_index, INDEX_EMPTY, sizeof(_index));
+    for(int i = 0; i < MAX_USERS; i++) {
+        if(_image.records[i].perms) indexInsert(i);
+    }
+}
+
+// Insert one slot with linear probing
+void UserCodeStore::indexInsert(int slot) {
+    uint16_t tag = _image.records[slot].tag;
+    for(int probe = 0; probe < INDEX_SIZE; probe++) {
+        uint8_t& bucket = _index[(tag + probe) & (INDEX_SIZE - 1)];
+        if(bucket == INDEX_EMPTY) {
+            bucket = (uint8_t)slot;
+            return;
+        }
+    }
+}
+
+// Create a fresh database holding only the factory master user
+void UserCodeStore::provisionDefault() {
+    memset(&_image, 0, sizeof(_image));
+    _image.header.magic = MAGIC;
+    _image.header.version = FORMAT;
+    _image.header.slots = MAX_USERS;
+    randomBytes(_image.header.pepper, sizeof(_image.header.pepper));
+    rebuildIndex();
+    setUser(0, DEFAULT_MASTER_CODE, PERM_MASTER | PERM_ARM | PERM_DISARM);
+}
+
+// Gather salt bytes from microsecond timer jitter
+// Boot-time SD and I2C latency varies enough to make salts unique per panel;
+// this is not a cryptographic RNG and is only used for salts and the pepper
+void UserCodeStore::randomBytes(uint8_t* out, int length) {
+    static uint64_t counter = 0;
+    uint8_t key[16];
+    for(int i = 0; i < 16; i++) {
+        wait_us((us_ticker_read() & 0x07) + 1);
+        key[i] = (uint8_t)us_ticker_read();
+    }
+    for(int i = 0; i < length; i += 8) {
+        counter++;
+        uint64_t h = sipHash(key, (const uint8_t*)&counter, sizeof(counter));
+        for(int j = 0; j < 8 && i + j < length; j++) {
+            out[i + j] = (uint8_t)(h >> (8 * j));
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "SDCard.h"        // Persistence of the code database
+
+// User Permission Flags
+// A slot with no flags set is empty
+enum UserPermission : uint8_t {
+    PERM_ARM     = 0x01,    // May arm the system (A/B)
+    PERM_DISARM  = 0x02,    // May disarm the system (C, entry delay, alarm)
+    PERM_DURESS  = 0x04,    // Disarms normally but is logged as a duress code
+    PERM_MASTER  = 0x08     // Full access, may manage other users
+};
+
+// One user slot as stored on the SD card and in RAM
+// The code itself is never stored - only a salted SipHash-2-4 digest
+struct UserRecord {
+    uint8_t salt[8];        // Per-user random salt
+    uint8_t digest[8];      // SipHash-2-4(salt || pepper, code)
+    uint16_t tag;           // Short keyed hash of the code, used by the lookup index
+    uint8_t perms;          // UserPermission flags, 0 = empty slot
+    uint8_t reserved;       // Keeps the record 4-byte aligned
+};
+
+// Multi-user code database with hashed lookup and constant-time verification
+class UserCodeStore {
+public:
+    static const int MAX_USERS = 250;      // Number of user slots
+    static const int NO_USER = -1;         // Returned when no slot matches
+    static const int CODE_LENGTH = 4;      // Digits per user code
+
+    UserCodeStore();
+
+    // Loads the database from the SD card into RAM
+    // Fails closed: only when the mounted card confirms there is no users.dat
+    // is a master user with the factory code provisioned, and it is written
+    // only as a new file. With no card, a file that cannot be opened, or one
+    // that is short or damaged, the store stays unavailable and every code is
+    // refused; the file on the card is left as it is.
+    // Parameters:
+    //   sd: SD card (may be unmounted)
+    // Returns: true if the store is available
+    bool load(SDCard& sd);
+
+    // Writes the database back to the SD card (never while unavailable)
+    // Returns: true if successful
+    bool save(SDCard& sd);
+
+    // Returns: true if codes can be checked - the database was loaded or provisioned
+    bool available() const { return _available; }
+
+    // Finds the user owning a code
+    // Parameters:
+    //   code: CODE_LENGTH ASCII digits
+    // Returns: slot number, or NO_USER
+    int lookup(const char* code) const;
+
+    // Returns: UserPermission flags of a slot (0 if empty or out of range)
+    uint8_t permissions(int slot) const;
+
+    // Creates or replaces a user slot
+    // Parameters:
+    //   slot:  Slot number (0..MAX_USERS-1)
+    //   code:  CODE_LENGTH ASCII digits, must not belong to another slot
+    //   perms: UserPermission flags (non-zero)
+    // Returns: true if the slot was written
+    bool setUser(int slot, const char* code, uint8_t perms);
+
+    // Clears a user slot
+    // Returns: true if the slot was in use
+    bool removeUser(int slot);
+
+    // Parameters:
+    //   perms: UserPermission flags a slot must hold to be counted (0 = any)
+    // Returns: number of slots in use holding them
+    int userCount(uint8_t perms = 0) const;
+
+private:
+    static const uint32_t MAGIC = 0x31525355;  // "USR1"
+    static const uint16_t FORMAT = 2;          // CRC covers the header (1: records only)
+    static const int INDEX_SIZE = 512;         // Power of two, at least 2x MAX_USERS
+    static const uint8_t INDEX_EMPTY = 0xFF;   // Unused index bucket
+
+    // File header preceding the records on the card
+    struct Header {
+        uint32_t magic;         // MAGIC
+        uint16_t version;       // Format version
+        uint16_t slots;         // MAX_USERS at time of writing
+        uint8_t pepper[8];      // Site-wide secret mixed into every digest
+        uint32_t crc;           // CRC-32 of the header fields above and the records
+    };
+
+    // Persistent image - written to the card as one block
+    struct Image {
+        Header header;
+        UserRecord records[MAX_USERS];
+    };
+
+    Image _image;                   // RAM copy of the database
+    bool _available;                // Database loaded or provisioned; codes refused otherwise
+    uint8_t _index[INDEX_SIZE];     // Open-addressed tag -> slot index
+
+    uint16_t codeTag(const char* code) const;   // Keyed index hash of a code
+    void codeDigest(const uint8_t salt[8], const char* code, uint8_t out[8]) const;
+    void rebuildIndex();                         // Rebuilds _index from _image
+    void indexInsert(int slot);                  // Adds one slot to _index
+    void provisionDefault();                     // Creates the factory master user
+    uint32_t imageCrc() const;                   // CRC stored in the header
+    static void randomBytes(uint8_t* out, int length);  // Timing-jitter entropy
+};
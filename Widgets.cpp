@@ -0,0 +1,488 @@
+#include "Widgets.h"
+#include "TimeService.h"   // Clock text
+#include "FastFormat.h"    // Countdown text
+
+// Grow to cover other
+void Rect::unite(const Rect& other) {
+    if(other.empty()) return;
+    if(empty()) {
+        *this = other;
+        return;
+    }
+    if(other.x0 < x0) x0 = other.x0;
+    if(other.y0 < y0) y0 = other.y0;
+    if(other.x1 > x1) x1 = other.x1;
+    if(other.y1 > y1) y1 = other.y1;
+}
+
+// Constructor - a new widget is painted the first time its screen is shown
+Widget::Widget(int16_t x0, int16_t y0, int16_t x1, int16_t y1) :
+    _bounds(Rect{ x0, y0, x1, y1 }),
+    _damage(Rect{ x0, y0, x1, y1 })
+{
+}
+
+// Constructor - no widgets
+Screen::Screen() :
+    _count(0)
+{
+}
+
+// Extra widgets are ignored; MAX_WIDGETS covers every screen in the panel
+void Screen::add(Widget& widget) {
+    if(_count < MAX_WIDGETS) _widgets[_count++] = &widget;
+}
+
+// Constructor - nothing is known about the display yet
+LcdRenderer::LcdRenderer(uLCD_4DGL& lcd) :
+    _lcd(lcd),
+    _screen(nullptr),
+    _clearPending(false),
+    _color(-1),
+    _col(-1),
+    _row(-1),
+    _commands(0)
+{
+}
+
+// Switching screens costs one clear; showing the current one costs nothing
+void LcdRenderer::show(Screen& screen) {
+    if(&screen == _screen) return;
+    _screen = &screen;
+    _clearPending = true;
+}
+
+// A cleared screen is painted whole, otherwise only what was damaged since
+// the last pass - however many setters ran in between
+void LcdRenderer::render() {
+    if(!_screen) return;
+    bool cleared = _clearPending;
+    if(cleared) {
+        _lcd.cls();                 // Clear and font reset
+        _commands += 2;
+        _col = 0;                   // Cursor homes; the text colour is kept
+        _row = 0;
+        _clearPending = false;
+    }
+    for(int i = 0; i < _screen->_count; i++) {
+        Widget* widget = _screen->_widgets[i];
+        if(cleared || widget->damaged()) {
+            widget->paint(*this, cleared);
+            widget->_damage = Rect::none();
+        }
+    }
+}
+
+// PUTCHAR costs one command per character plus any cursor move and colour
+// change; a string costs four whatever its length (font, cursor, colour,
+// text) and leaves the cursor somewhere the library does not track
+void LcdRenderer::text(int col, int row, const char* text, int length, int color) {
+    if(length <= 0) return;
+    int charCost = length + (color != _color) + (col != _col || row != _row);
+
+    if(charCost <= STRING_COMMANDS) {
+        if(col != _col || row != _row) {
+            _lcd.locate(col, row);
+            _commands++;
+        }
+        if(color != _color) {
+            _lcd.color(color);
+            _commands++;
+        }
+        for(int i = 0; i < length; i++) _lcd.putc(text[i]);
+        _commands += length;
+        _col = _lcd.current_col;    // The library wraps at the right edge
+        _row = _lcd.current_row;
+        _color = color;
+        return;
+    }
+
+    char buffer[TEXT_MAX_CELLS + 1];    // LCD requires non-const char*
+    if(length > TEXT_MAX_CELLS) length = TEXT_MAX_CELLS;
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    _lcd.text_string(buffer, col, row, FONT_7X8, color);
+    _commands += STRING_COMMANDS;
+    _color = color;
+    _col = -1;
+}
+
+// Filled rectangle
+void LcdRenderer::fill(const Rect& area, int color) {
+    if(area.empty()) return;
+    _lcd.filled_rectangle(area.x0, area.y0, area.x1, area.y1, color);
+    _commands++;
+}
+
+// Rectangle outline
+void LcdRenderer::frame(const Rect& area, int color) {
+    if(area.empty()) return;
+    _lcd.rectangle(area.x0, area.y0, area.x1, area.y1, color);
+    _commands++;
+}
+
+// Filled circle
+void LcdRenderer::disc(int x, int y, int radius, int color) {
+    _lcd.filled_circle(x, y, radius, color);
+    _commands++;
+}
+
+// Image from the display's card - the text cursor and colour are untouched
+void LcdRenderer::image(int x, int y, uint32_t sector) {
+    _lcd.set_sector_address(sector >> 16, sector & 0xFFFF);
+    _lcd.display_image(x, y);
+    _commands += 2;
+}
+
+// Next text call re-sends the cursor and colour
+void LcdRenderer::forget() {
+    _color = -1;
+    _col = -1;
+}
+
+// Constructor - blank cells, all of them to be written
+TextCells::TextCells(uint8_t col, uint8_t row, uint8_t width) :
+    _col(col),
+    _row(row),
+    _width(width <= TEXT_MAX_CELLS ? width : TEXT_MAX_CELLS),
+    _dirtyFrom(0),
+    _dirtyTo(0)
+{
+    memset(_text, ' ', sizeof(_text));
+}
+
+// Only the span between the first and last changed cell is written later
+Rect TextCells::set(const char* text) {
+    int from = _width;
+    int to = 0;
+    bool ended = false;
+    for(int i = 0; i < _width; i++) {
+        char c = ' ';
+        if(!ended && text[i] != '\0') c = text[i];
+        else ended = true;
+        if(c != _text[i]) {
+            _text[i] = c;
+            if(i < from) from = i;
+            to = i + 1;
+        }
+    }
+    if(from >= to) return Rect::none();
+
+    if(_dirtyFrom >= _dirtyTo) {
+        _dirtyFrom = from;
+        _dirtyTo = to;
+    } else {
+        if(from < _dirtyFrom) _dirtyFrom = from;
+        if(to > _dirtyTo) _dirtyTo = to;
+    }
+    return cellArea(from, to);
+}
+
+// Every cell to be written
+void TextCells::touch() {
+    _dirtyFrom = 0;
+    _dirtyTo = _width;
+}
+
+// On a cleared screen blanks need no writing, so only the text between the
+// first and last visible character is sent
+void TextCells::paint(LcdRenderer& out, int color, bool cleared) {
+    int from = _dirtyFrom;
+    int to = _dirtyTo;
+    if(cleared) {
+        from = 0;
+        to = _width;
+        while(to > 0 && _text[to - 1] == ' ') to--;
+        while(from < to && _text[from] == ' ') from++;
+    }
+    out.text(_col + from, _row, _text + from, to - from, color);
+    _dirtyFrom = 0;
+    _dirtyTo = 0;
+}
+
+// All cells
+Rect TextCells::bounds() const {
+    return cellArea(0, _width);
+}
+
+// Pixels of cells [from, to)
+Rect TextCells::cellArea(int from, int to) const {
+    return Rect{ (int16_t)((_col + from) * TEXT_CELL_W), (int16_t)(_row * TEXT_CELL_H),
+                 (int16_t)((_col + to) * TEXT_CELL_W - 1), (int16_t)((_row + 1) * TEXT_CELL_H - 1) };
+}
+
+// Constructor - empty label
+Label::Label(uint8_t col, uint8_t row, uint8_t width, int color) :
+    Widget(col * TEXT_CELL_W, row * TEXT_CELL_H, (col + width) * TEXT_CELL_W - 1, (row + 1) * TEXT_CELL_H - 1),
+    _cells(col, row, width),
+    _color(color)
+{
+}
+
+// New text
+void Label::setText(const char* text) {
+    damage(_cells.set(text));
+}
+
+// New colour - every cell is rewritten in it
+void Label::setColor(int color) {
+    if(color == _color) return;
+    _color = color;
+    _cells.touch();
+    invalidate();
+}
+
+// Changed cells only
+void Label::paint(LcdRenderer& out, bool cleared) {
+    _cells.paint(out, _color, cleared);
+}
+
+// Constructor - "HH:MM:SS" is 8 cells
+Clock::Clock(uint8_t col, uint8_t row) :
+    Label(col, row, 8)
+{
+}
+
+// Seconds change every tick, the rest rarely
+void Clock::setTime(uint32_t epoch) {
+    char text[16];
+    TimeService::formatTime(epoch, text);
+    setText(text);
+}
+
+// Constructor - no digits entered
+CodeField::CodeField(uint8_t col, uint8_t row) :
+    Widget(col * TEXT_CELL_W, row * TEXT_CELL_H, (col + LENGTH) * TEXT_CELL_W - 1, (row + 1) * TEXT_CELL_H - 1),
+    _col(col),
+    _row(row),
+    _count(0),
+    _dirtyFrom(0),
+    _dirtyTo(0)
+{
+}
+
+// A digit typed or removed changes one cell
+void CodeField::setCount(int count) {
+    if(count < 0) count = 0;
+    if(count > LENGTH) count = LENGTH;
+    if(count == _count) return;
+
+    int from = count < _count ? count : _count;
+    int to = count < _count ? _count : count;
+    _count = (uint8_t)count;
+    if(_dirtyFrom >= _dirtyTo) {
+        _dirtyFrom = from;
+        _dirtyTo = to;
+    } else {
+        if(from < _dirtyFrom) _dirtyFrom = from;
+        if(to > _dirtyTo) _dirtyTo = to;
+    }
+    damage(Rect{ (int16_t)((_col + from) * TEXT_CELL_W), _bounds.y0,
+                 (int16_t)((_col + to) * TEXT_CELL_W - 1), _bounds.y1 });
+}
+
+// Changed cells, or all four after a clear
+void CodeField::paint(LcdRenderer& out, bool cleared) {
+    char mask[LENGTH];
+    for(int i = 0; i < LENGTH; i++) mask[i] = i < _count ? '*' : '_';
+    int from = cleared ? 0 : _dirtyFrom;
+    int to = cleared ? LENGTH : _dirtyTo;
+    out.text(_col + from, _row, mask + from, to - from, WHITE);
+    _dirtyFrom = 0;
+    _dirtyTo = 0;
+}
+
+// Constructor - bar empty, outline still to draw
+Countdown::Countdown(uint8_t col, uint8_t row, const Rect& bar, int urgentS) :
+    Widget(bar.x0, bar.y0, bar.x1, bar.y1),
+    _time(col, row, 9),
+    _bar(bar),
+    _urgentS(urgentS),
+    _width(0),
+    _drawnWidth(0),
+    _color(GREEN),
+    _drawnColor(GREEN),
+    _outline(true)
+{
+    _bounds.unite(_time.bounds());
+    _damage = _bounds;
+}
+
+// Elapsed share of the bar inside the outline, red near the end
+void Countdown::set(int remaining, int total) {
+    if(remaining < 0) remaining = 0;
+    char text[16];
+    char* p = fmtText(text, text + sizeof(text), "Time: ");
+    p = fmtUintPadded(p, remaining, 2);
+    p[0] = 's';
+    p[1] = '\0';
+    damage(_time.set(text));
+
+    int16_t width = 0;
+    if(total > 0 && remaining < total) {
+        width = (int16_t)((_bar.x1 - _bar.x0 - 2) * (total - remaining) / total);
+    }
+    int color = remaining <= _urgentS ? RED : GREEN;
+    if(width != _width || color != _color) {
+        _width = width;
+        _color = color;
+        damage(_bar);
+    }
+}
+
+// The time text, the outline once, then only the slice of the bar that
+// changed - the whole fill is redrawn only when its colour changes
+void Countdown::paint(LcdRenderer& out, bool cleared) {
+    if(cleared) {
+        _time.touch();
+        _drawnWidth = 0;
+        _outline = true;
+    }
+    _time.paint(out, WHITE, cleared);
+
+    if(_outline) {
+        out.frame(_bar, WHITE);
+        _outline = false;
+    }
+
+    int16_t left = _bar.x0 + 1;
+    int16_t top = _bar.y0 + 1;
+    int16_t bottom = _bar.y1 - 1;
+    if(_color != _drawnColor && _drawnWidth > 0 && _width > 0) {
+        out.fill(Rect{ left, top, (int16_t)(_bar.x0 + _width), bottom }, _color);
+    } else if(_width > _drawnWidth) {
+        out.fill(Rect{ (int16_t)(left + _drawnWidth), top, (int16_t)(_bar.x0 + _width), bottom }, _color);
+    }
+    if(_width < _drawnWidth) {
+        // A new countdown on the same screen starts from an empty bar
+        out.fill(Rect{ (int16_t)(left + _width), top, (int16_t)(_bar.x0 + _drawnWidth), bottom }, BLACK);
+    }
+    _drawnWidth = _width;
+    _drawnColor = _color;
+}
+
+// Constructor - unlit
+StatusIcon::StatusIcon(int16_t x, int16_t y, int16_t radius) :
+    Widget(x - radius, y - radius, x + radius, y + radius),
+    _x(x),
+    _y(y),
+    _radius(radius),
+    _color(BLACK)
+{
+}
+
+// New lamp colour
+void StatusIcon::setColor(int color) {
+    if(color == _color) return;
+    _color = color;
+    invalidate();
+}
+
+// One filled circle
+void StatusIcon::paint(LcdRenderer& out, bool cleared) {
+    if(cleared && _color == BLACK) return;
+    out.disc(_x, _y, _radius, _color);
+}
+
+// Constructor - unnamed quiet tiles, none drawn yet
+ZoneGrid::ZoneGrid(uint8_t col, uint8_t row, uint8_t columns, uint8_t count) :
+    Widget(col * TEXT_CELL_W, row * TEXT_CELL_H,
+           (col + columns * TILE_CELLS) * TEXT_CELL_W - 1,
+           (row + (count + columns - 1) / columns) * TEXT_CELL_H - 1),
+    _col(col),
+    _row(row),
+    _columns(columns),
+    _count(count <= MAX_TILES ? count : MAX_TILES),
+    _dirty(0)
+{
+    memset(_name, ' ', sizeof(_name));
+    memset(_state, TILE_QUIET, sizeof(_state));
+    memset(_drawnName, ' ', sizeof(_drawnName));
+    memset(_drawnState, NOT_DRAWN, sizeof(_drawnState));
+}
+
+// Damage covers just this tile
+void ZoneGrid::setTile(int index, char name, TileState state) {
+    if(index < 0 || index >= _count) return;
+    if(_name[index] == name && _state[index] == state) return;
+    _name[index] = name;
+    _state[index] = state;
+    _dirty |= 1u << index;
+    int col = _col + index % _columns * TILE_CELLS;
+    int row = _row + index / _columns;
+    damage(Rect{ (int16_t)(col * TEXT_CELL_W), (int16_t)(row * TEXT_CELL_H),
+                 (int16_t)((col + TILE_CELLS) * TEXT_CELL_W - 1), (int16_t)((row + 1) * TEXT_CELL_H - 1) });
+}
+
+// After a clear every tile is drawn; otherwise a set tile sends only what
+// differs from its last rendered letter and state
+void ZoneGrid::paint(LcdRenderer& out, bool cleared) {
+    if(cleared) {
+        memset(_drawnName, ' ', sizeof(_drawnName));
+        memset(_drawnState, NOT_DRAWN, sizeof(_drawnState));
+    }
+    for(int i = 0; i < _count; i++) {
+        if(!cleared && !(_dirty & (1u << i))) continue;
+        if(_name[i] != _drawnName[i]) {
+            out.text(_col + i % _columns * TILE_CELLS, _row + i / _columns, &_name[i], 1, WHITE);
+            _drawnName[i] = _name[i];
+        }
+        if(_state[i] != _drawnState[i]) {
+            out.fill(swatchArea(i), stateColor(_state[i]));
+            _drawnState[i] = _state[i];
+        }
+    }
+    _dirty = 0;
+}
+
+// Swatch: the two cells after the letter, inset so tiles stay apart
+Rect ZoneGrid::swatchArea(int index) const {
+    int col = _col + index % _columns * TILE_CELLS + 1;
+    int row = _row + index / _columns;
+    return Rect{ (int16_t)(col * TEXT_CELL_W + 1), (int16_t)(row * TEXT_CELL_H + 2),
+                 (int16_t)((col + TILE_CELLS - 1) * TEXT_CELL_W - 3), (int16_t)((row + 1) * TEXT_CELL_H - 3) };
+}
+
+// Swatch colour per TileState
+int ZoneGrid::stateColor(uint8_t state) {
+    switch(state) {
+        case TILE_ACTIVE:   return 0xFFFF00;    // Yellow
+        case TILE_BYPASSED: return DGREY;
+        case TILE_FAULT:    return RED;
+        default:            return GREEN;
+    }
+}
+
+// Constructor - visible
+ImageWidget::ImageWidget(int16_t x, int16_t y, const LcdAssetInfo& asset) :
+    Widget(x, y, x + asset.width - 1, y + asset.height - 1),
+    _sector(asset.sector),
+    _visible(true)
+{
+}
+
+// Show or hide the image
+void ImageWidget::setVisible(bool visible) {
+    if(visible == _visible) return;
+    _visible = visible;
+    invalidate();
+}
+
+// The image is drawn whole; hiding it clears its area unless the screen is blank
+void ImageWidget::paint(LcdRenderer& out, bool cleared) {
+    if(_visible) out.image(_bounds.x0, _bounds.y0, _sector);
+    else if(!cleared) out.fill(_bounds, BLACK);
+}
+
+// Constructor
+PaintWidget::PaintWidget(int16_t x0, int16_t y0, int16_t x1, int16_t y1, mbed::Callback<void(LcdRenderer&)> painter) :
+    Widget(x0, y0, x1, y1),
+    _painter(painter)
+{
+}
+
+// The callback may draw anything, so the renderer's text state is dropped
+void PaintWidget::paint(LcdRenderer& out, bool cleared) {
+    if(_painter) _painter(out);
+    out.forget();
+}
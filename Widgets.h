@@ -0,0 +1,347 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include "mbed.h"
+#include <cstdint>         // Standard integer types
+#include "uLCD_4DGL.h"     // Display driver
+#include "LcdAssetTable.h" // Images on the display's card
+
+// Retained-mode widgets for the uLCD-144
+// A screen is a list of widgets that remember what they show. Setters only
+// record the new state and mark the part of the widget it changes;
+// LcdRenderer::render() then repaints just those parts, once per display
+// pass however many updates arrived in it. Every 4DGL command waits for the
+// display's acknowledgement, so the renderer also drops cursor and colour
+// commands the display already has. Widgets are only touched from the
+// display consumer.
+
+static const int TEXT_CELL_W = 7;       // Text cell width in pixels (7x8 font, width 1)
+static const int TEXT_CELL_H = 16;      // Text cell height in pixels (height 2)
+static const int TEXT_MAX_CELLS = 18;   // Cells in a text row
+
+// Pixel rectangle, corners inclusive
+struct Rect {
+    int16_t x0, y0;         // Top left
+    int16_t x1, y1;         // Bottom right, x1 < x0 when empty
+
+    static Rect none() { return Rect{ 0, 0, -1, -1 }; }
+    bool empty() const { return x1 < x0; }
+    void unite(const Rect& other);          // Grows to cover other
+};
+
+class LcdRenderer;
+
+// Base of every widget: its bounds and the part that needs repainting
+class Widget {
+public:
+    Widget(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    virtual ~Widget() {}
+
+    // Returns: true if part of the widget needs repainting
+    bool damaged() const { return !_damage.empty(); }
+
+    // Returns: area covered by the widget
+    const Rect& bounds() const { return _bounds; }
+
+protected:
+    // Marks the whole widget for repainting; text widgets also mark their cells
+    void invalidate() { _damage = _bounds; }
+
+    // Marks part of the widget for repainting
+    void damage(const Rect& area) { _damage.unite(area); }
+
+    // Sends the commands for the damaged part
+    // Parameters:
+    //   out:     Renderer to draw with
+    //   cleared: The screen was just cleared - only non-background pixels need drawing
+    virtual void paint(LcdRenderer& out, bool cleared) = 0;
+
+    Rect _bounds;           // Widget area
+    Rect _damage;           // Area to repaint, empty when up to date
+
+    friend class LcdRenderer;
+};
+
+// Widgets shown together; one widget may be on several screens
+class Screen {
+public:
+    static const int MAX_WIDGETS = 8;       // Widgets per screen
+
+    Screen();
+
+    // Adds a widget, painted after those added before it
+    void add(Widget& widget);
+
+private:
+    Widget* _widgets[MAX_WIDGETS];  // Paint order
+    uint8_t _count;                 // Widgets in use
+
+    friend class LcdRenderer;
+};
+
+// Owns the LCD: draws the current screen and caches the display's text state
+class LcdRenderer {
+public:
+    // Parameters:
+    //   lcd: Display, already reset and set up for 7x16 text cells
+    LcdRenderer(uLCD_4DGL& lcd);
+
+    // Makes a screen current - the next render() clears the LCD and paints it
+    // (a no-op if it is current already)
+    void show(Screen& screen);
+
+    // Returns: the screen last passed to show(), nullptr before the first
+    const Screen* current() const { return _screen; }
+
+    // Forces a full repaint of the current screen, e.g. after the LCD was reset
+    void invalidateAll() { _clearPending = true; }
+
+    // Paints the damaged widgets of the current screen
+    void render();
+
+    // Drawing primitives for widgets ------------------------------------
+
+    // Text in cells, in the cheapest form: a few characters are written one
+    // by one from where the cursor already is, longer runs as one string
+    // Parameters:
+    //   col, row: First cell
+    //   text:     Characters (need not be terminated)
+    //   length:   Number of characters
+    //   color:    Text colour
+    void text(int col, int row, const char* text, int length, int color);
+
+    void fill(const Rect& area, int color);                 // Filled rectangle
+    void frame(const Rect& area, int color);                // Rectangle outline
+    void disc(int x, int y, int radius, int color);         // Filled circle
+
+    // Image from the display's own card (see MediaAssets): two commands
+    // however large the image is
+    // Parameters:
+    //   x, y:   Top left corner
+    //   sector: First sector of the raw image
+    void image(int x, int y, uint32_t sector);
+
+    // Raw access for widgets that draw something the primitives do not cover
+    // The cached text state is dropped afterwards (forget())
+    uLCD_4DGL& lcd() { return _lcd; }
+
+    // Drops the cached cursor and colour after raw drawing
+    void forget();
+
+    // Returns: 4DGL commands sent since construction
+    uint32_t commands() const { return _commands; }
+
+private:
+    static const int STRING_COMMANDS = 4;   // text_string(): font, cursor, colour, string
+
+    uLCD_4DGL& _lcd;                // Display
+    Screen* _screen;                // Current screen
+    bool _clearPending;             // Current screen not painted since show()
+    int _color;                     // Text colour the display has, -1 = unknown
+    int _col;                       // Text cursor column, -1 = unknown
+    int _row;                       // Text cursor row
+    uint32_t _commands;             // Command count
+};
+
+// A run of text cells that remembers what it shows and which cells changed
+class TextCells {
+public:
+    // Parameters:
+    //   col, row: First cell
+    //   width:    Cells, at most TEXT_MAX_CELLS - col
+    TextCells(uint8_t col, uint8_t row, uint8_t width);
+
+    // Sets the text (cut to width, padded with spaces)
+    // Returns: area of the cells that changed, empty if none
+    Rect set(const char* text);
+
+    // Marks every cell changed
+    void touch();
+
+    // Writes the changed cells
+    // Parameters:
+    //   cleared: Screen is blank - trailing spaces are skipped
+    void paint(LcdRenderer& out, int color, bool cleared);
+
+    // Returns: area of all cells
+    Rect bounds() const;
+
+private:
+    uint8_t _col;                       // First cell column
+    uint8_t _row;                       // Row
+    uint8_t _width;                     // Cells
+    uint8_t _dirtyFrom;                 // First changed cell
+    uint8_t _dirtyTo;                   // One past the last changed cell
+    char _text[TEXT_MAX_CELLS];         // Current text, space padded
+
+    Rect cellArea(int from, int to) const;  // Pixels of cells [from, to)
+};
+
+// Single line of text
+class Label : public Widget {
+public:
+    Label(uint8_t col, uint8_t row, uint8_t width, int color = WHITE);
+
+    void setText(const char* text);     // Repaints only the changed cells
+    void setColor(int color);           // Repaints the whole label
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+    TextCells _cells;       // Text
+    int _color;             // Text colour
+};
+
+// Time of day "HH:MM:SS" - one tick usually rewrites a single cell
+class Clock : public Label {
+public:
+    Clock(uint8_t col, uint8_t row);
+
+    // Parameters:
+    //   epoch: Unix seconds to show
+    void setTime(uint32_t epoch);
+};
+
+// Masked code entry: '*' per digit entered, '_' for the rest
+class CodeField : public Widget {
+public:
+    static const int LENGTH = 4;        // Code digits
+
+    CodeField(uint8_t col, uint8_t row);
+
+    void setCount(int count);           // Digits entered; repaints the cells that changed
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+private:
+    uint8_t _col;           // First cell
+    uint8_t _row;           // Row
+    uint8_t _count;         // Digits shown
+    uint8_t _dirtyFrom;     // First changed cell
+    uint8_t _dirtyTo;       // One past the last changed cell
+};
+
+// Delay countdown: "Time: NNs" and an elapsed-time bar
+// Each second rewrites one or two digits and fills only the new slice of
+// the bar; the whole bar is repainted only when it changes colour.
+class Countdown : public Widget {
+public:
+    // Parameters:
+    //   col, row: Cell of the "Time:" text
+    //   bar:      Bar outline
+    //   urgentS:  Seconds left from which the bar turns red
+    Countdown(uint8_t col, uint8_t row, const Rect& bar, int urgentS);
+
+    // Parameters:
+    //   remaining: Seconds left
+    //   total:     Length of the delay in seconds
+    void set(int remaining, int total);
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+private:
+    TextCells _time;        // "Time: NNs"
+    Rect _bar;              // Bar outline
+    int _urgentS;           // Red threshold
+    int16_t _width;         // Filled pixels wanted
+    int16_t _drawnWidth;    // Filled pixels on the display
+    int _color;             // Fill colour wanted
+    int _drawnColor;        // Fill colour on the display
+    bool _outline;          // Outline needs drawing
+};
+
+// Round status lamp mirroring the RGB LED
+class StatusIcon : public Widget {
+public:
+    StatusIcon(int16_t x, int16_t y, int16_t radius);
+
+    void setColor(int color);           // Repaints only on a change
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+private:
+    int16_t _x, _y, _radius;    // Centre and size
+    int _color;                 // Lamp colour
+};
+
+// One tile per zone: its letter, then a swatch coloured by the zone state
+// Tiles are TILE_CELLS text cells wide and one row high, so the letters
+// line up with the text grid. Each tile remembers what it last put on the
+// display: a zone changing state costs one filled rectangle, whatever the
+// number of tiles, and a state that flips back before the next render
+// costs nothing.
+class ZoneGrid : public Widget {
+public:
+    static const int MAX_TILES = 16;    // Tiles in a grid
+    static const int TILE_CELLS = 3;    // Text cells per tile: letter, swatch, swatch and gap
+
+    // Tile state, in increasing urgency
+    enum TileState : uint8_t {
+        TILE_QUIET,         // Closed / no motion
+        TILE_ACTIVE,        // Open / motion / object near
+        TILE_BYPASSED,      // Not armed in the current mode
+        TILE_FAULT          // Tripped the alarm
+    };
+
+    // Parameters:
+    //   col, row: Cell of the first tile
+    //   columns:  Tiles per row
+    //   count:    Number of tiles
+    ZoneGrid(uint8_t col, uint8_t row, uint8_t columns, uint8_t count);
+
+    // Sets a tile; only that tile is repainted, and only if it changed
+    void setTile(int index, char name, TileState state);
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+    Rect swatchArea(int index) const;   // Swatch pixels of a tile
+    static int stateColor(uint8_t state);   // Swatch colour per TileState
+
+    static const uint8_t NOT_DRAWN = 0xFF;  // _drawnState of a tile not on the display
+
+    uint8_t _col, _row;                 // First tile cell
+    uint8_t _columns;                   // Tiles per row
+    uint8_t _count;                     // Tiles
+    uint16_t _dirty;                    // Tiles set since the last paint, bit per tile
+    char _name[MAX_TILES];              // Tile letters
+    uint8_t _state[MAX_TILES];          // TileState per tile
+    char _drawnName[MAX_TILES];         // Letter on the display
+    uint8_t _drawnState[MAX_TILES];     // TileState on the display, NOT_DRAWN if none
+};
+
+// Prerendered image from the display's card, which can be hidden to flash it
+// Showing it costs one image command; hiding it one black rectangle. Only
+// put it on a screen once MediaAssets::available() says the image is there.
+class ImageWidget : public Widget {
+public:
+    // Parameters:
+    //   x, y:  Top left corner
+    //   asset: Image, from LCD_ASSETS
+    ImageWidget(int16_t x, int16_t y, const LcdAssetInfo& asset);
+
+    void setVisible(bool visible);      // Repaints only on a change
+    bool visible() const { return _visible; }
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+private:
+    uint32_t _sector;       // First sector of the raw image
+    bool _visible;          // Image shown, background otherwise
+};
+
+// Widget drawn by a callback, repainted whole whenever invalidated
+class PaintWidget : public Widget {
+public:
+    PaintWidget(int16_t x0, int16_t y0, int16_t x1, int16_t y1, mbed::Callback<void(LcdRenderer&)> painter);
+
+protected:
+    void paint(LcdRenderer& out, bool cleared) override;
+
+private:
+    mbed::Callback<void(LcdRenderer&)> _painter;   // Draws the widget
+};
@@ -1,7 +1,7 @@
 #include "SecuritySystem.h"
 
 int main() {
-    SecuritySystem system;
+    static SecuritySystem system;   // Too large for the main stack (user database, thread stacks)
     system.initialize();
     system.run();
 }
\ No newline at end of file
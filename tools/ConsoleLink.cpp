@@ -0,0 +1,69 @@
+#include "ConsoleLink.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Constructor
+ConsoleLink::ConsoleLink(int fd) :
+    _fd(fd),
+    _head(0),
+    _count(0)
+{
+}
+
+// Destructor
+ConsoleLink::~ConsoleLink() {
+    if(_fd >= 0) close(_fd);
+}
+
+// 115200 8N1, raw
+int ConsoleLink::openDevice(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if(fd < 0) return -1;
+    if(!makeRaw(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Binary frames must pass through untouched
+bool ConsoleLink::makeRaw(int fd) {
+    struct termios tio;
+    if(tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+// Encode and write the whole frame
+bool ConsoleLink::send(uint8_t command, const uint8_t* payload, uint8_t length) {
+    uint8_t buf[CONSOLE_MAX_PAYLOAD + CONSOLE_OVERHEAD];
+    int size = encodeFrame(command, payload, length, buf);
+    int sent = 0;
+    while(sent < size) {
+        ssize_t n = write(_fd, buf + sent, size - sent);
+        if(n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Parse buffered bytes first, then read more until a frame completes
+bool ConsoleLink::receive(ConsoleFrame& frame, int timeoutMs) {
+    while(true) {
+        while(_head < _count) {
+            if(_parser.feed(_buf[_head++], frame)) return true;
+        }
+        struct pollfd pfd = { _fd, POLLIN, 0 };
+        if(poll(&pfd, 1, timeoutMs) <= 0) return false;
+        ssize_t n = read(_fd, _buf, sizeof(_buf));
+        if(n <= 0) return false;
+        _head = 0;
+        _count = (int)n;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+#include "ConsoleProtocol.h"   // Frame format shared with the firmware
+
+// Host end of the serial console: a raw file descriptor - the panel's USB
+// serial device or a pseudo-terminal - with frame encode/decode on top
+class ConsoleLink {
+public:
+    // Wraps an open descriptor; the link closes it
+    explicit ConsoleLink(int fd);
+    ~ConsoleLink();
+
+    // Opens a serial device in raw mode at the console baud rate
+    // Parameters:
+    //   path: e.g. /dev/ttyACM0 or a pty slave
+    // Returns: descriptor, or -1 (errno set)
+    static int openDevice(const char* path);
+
+    // Puts a descriptor into raw mode (no echo, no line editing)
+    static bool makeRaw(int fd);
+
+    // Writes one frame
+    // Returns: false on a write error
+    bool send(uint8_t command, const uint8_t* payload, uint8_t length);
+
+    // Waits for the next complete frame; other bytes are skipped
+    // Parameters:
+    //   frame:     Receives the frame
+    //   timeoutMs: Longest wait for more bytes
+    // Returns: false on timeout or end of file
+    bool receive(ConsoleFrame& frame, int timeoutMs);
+
+    // Returns: frames rejected by the parser
+    uint32_t badFrames() const { return _parser.badFrames(); }
+
+    // Returns: the descriptor, for waiting on several links at once
+    int fd() const { return _fd; }
+
+private:
+    int _fd;                    // Device or pty
+    FrameParser _parser;        // Incoming frame decoder
+    uint8_t _buf[256];          // Bytes read but not yet parsed
+    int _head;                  // Next byte of _buf to parse
+    int _count;                 // Bytes in _buf
+};
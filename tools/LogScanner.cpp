@@ -0,0 +1,409 @@
+#include "LogScanner.h"
+#include <cstring>         // memcmp, memcpy, memset
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>     // x86 vector compares
+#elif defined(__aarch64__)
+#include <arm_neon.h>      // NEON vector compares
+#endif
+
+// Newline bitmask of 64 bytes, bit i set if p[i] == '\n'
+static inline uint64_t newlineMask(const char* p) {
+#if defined(__AVX2__)
+    const __m256i nl = _mm256_set1_epi8('\n');
+    __m256i a = _mm256_loadu_si256((const __m256i*)p);
+    __m256i b = _mm256_loadu_si256((const __m256i*)(p + 32));
+    uint64_t lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, nl));
+    uint64_t hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl));
+    return lo | (hi << 32);
+#elif defined(__SSE2__)
+    const __m128i nl = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for(int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)) << (16 * i);
+    }
+    return mask;
+#elif defined(__aarch64__)
+    // No movemask on NEON: weight each matching lane by its bit and add
+    // pairs of lanes together until each 16-byte block is two bytes
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t w = vld1q_u8(weights);
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    uint8x16_t m0 = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)p), nl), w);
+    uint8x16_t m1 = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)p + 16), nl), w);
+    uint8x16_t m2 = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)p + 32), nl), w);
+    uint8x16_t m3 = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)p + 48), nl), w);
+    uint8x16_t s = vpaddq_u8(vpaddq_u8(m0, m1), vpaddq_u8(m2, m3));
+    s = vpaddq_u8(s, s);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(s), 0);
+#else
+    // Eight bytes at a time: a zero byte in x ^ '\n'*8 marks a newline
+    uint64_t mask = 0;
+    for(int i = 0; i < 64; i += 8) {
+        uint64_t x;
+        memcpy(&x, p + i, 8);
+        x ^= 0x0A0A0A0A0A0A0A0AULL;
+        uint64_t zero = ~(((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x | 0x7F7F7F7F7F7F7F7FULL);
+        for(int b = 0; b < 8; b++) {
+            if(zero & (0x80ULL << (8 * b))) mask |= 1ULL << (i + b);
+        }
+    }
+    return mask;
+#endif
+}
+
+// Constructor - first block ready
+LineScanner::LineScanner(const char* begin, const char* end) :
+    _block(begin),
+    _end(end),
+    _line(begin),
+    _mask(0)
+{
+    if(begin < end) load();
+}
+
+// Whole blocks use the vector compare; the last partial block is read
+// byte by byte so nothing past the end of the mapping is touched
+void LineScanner::load() {
+    if(_end - _block >= 64) {
+        _mask = newlineMask(_block);
+        return;
+    }
+    _mask = 0;
+    for(int i = 0; i < (int)(_end - _block); i++) {
+        if(_block[i] == '\n') _mask |= 1ULL << i;
+    }
+}
+
+// Walks the set bits, then moves on a block
+bool LineScanner::next(const char*& line, size_t& length) {
+    while(true) {
+        if(_mask) {
+            const char* nl = _block + __builtin_ctzll(_mask);
+            _mask &= _mask - 1;
+            line = _line;
+            length = (size_t)(nl - _line);
+            _line = nl + 1;
+            return true;
+        }
+        if(_end - _block <= 64) break;
+        _block += 64;
+        load();
+    }
+
+    // Text after the last newline
+    if(_line < _end) {
+        line = _line;
+        length = (size_t)(_end - _line);
+        _line = _end;
+        return true;
+    }
+    return false;
+}
+
+// Two decimal digits, or -1
+static inline int twoDigits(const char* p) {
+    unsigned a = (unsigned)(p[0] - '0');
+    unsigned b = (unsigned)(p[1] - '0');
+    if(a > 9 || b > 9) return -1;
+    return (int)(a * 10 + b);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static uint32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (uint32_t)(era * 146097 + doe - 719468);
+}
+
+// "YYYY-MM-DD" to a day number
+// Returns: false if the date is not valid
+static bool parseDate(const char* p, uint32_t& days) {
+    int century = twoDigits(p);
+    int year = twoDigits(p + 2);
+    int month = twoDigits(p + 5);
+    int day = twoDigits(p + 8);
+    if(century < 0 || year < 0 || month < 1 || month > 12 || day < 1 || day > 31) return false;
+    year += century * 100;
+    if(year < 1970) return false;
+    days = daysFromCivil(year, month, day);
+    return true;
+}
+
+// The separators sit at fixed columns, so a line is checked in place
+// without searching for the " - " delimiter
+bool parseLine(const char* text, size_t length, DateCache& cache, LogLine& out) {
+    static const size_t PREFIX = 22;    // "YYYY-MM-DD HH:MM:SS - "
+    if(length < PREFIX) return false;
+    if(text[4] != '-' || text[7] != '-' || text[10] != ' ' || text[13] != ':' || text[16] != ':' ||
+       text[19] != ' ' || text[20] != '-' || text[21] != ' ') return false;
+
+    if(!cache.valid || memcmp(cache.date, text, sizeof(cache.date)) != 0) {
+        uint32_t days;
+        if(!parseDate(text, days)) return false;
+        memcpy(cache.date, text, sizeof(cache.date));
+        cache.days = days;
+        cache.valid = true;
+    }
+
+    int hour = twoDigits(text + 11);
+    int min = twoDigits(text + 14);
+    int sec = twoDigits(text + 17);
+    if(hour < 0 || hour > 23 || min < 0 || min > 59 || sec < 0 || sec > 59) return false;
+
+    out.epoch = cache.days * 86400u + (uint32_t)(hour * 3600 + min * 60 + sec);
+    out.hour = (uint8_t)hour;
+    classifyMessage(text + PREFIX, length - PREFIX, out);
+    return true;
+}
+
+// Message texts the firmware logs
+struct MessageRule {
+    const char* text;       // Message, or its start if prefix
+    LogKind kind;           // Category
+    LogSource source;       // Command origin (KIND_COMMAND only)
+    bool arm;               // Command arms (KIND_COMMAND only)
+    bool prefix;            // Match the start only
+};
+
+static const MessageRule RULES[] = {
+    { "ALARM TRIGGERED",                KIND_ALARM,        SOURCE_KEYPAD,   false, false },
+    { "Alarm Resumed After Restart",    KIND_RESTART,      SOURCE_KEYPAD,   false, false },
+    { "Motion Detected!",               KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "Outside Motion!",                KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "Door Opened!",                   KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "Window Breach!",                 KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "Panic Button Pressed",           KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "Entry Delay Expired",            KIND_ALARM_CAUSE,  SOURCE_KEYPAD,   false, false },
+    { "System Armed - Home Mode",       KIND_ARM_HOME,     SOURCE_KEYPAD,   false, false },
+    { "System Armed - Away Mode",       KIND_ARM_AWAY,     SOURCE_KEYPAD,   false, false },
+    { "Exit Delay Started",             KIND_EXIT_DELAY,   SOURCE_KEYPAD,   false, false },
+    { "System Disarmed",                KIND_DISARM,       SOURCE_KEYPAD,   false, false },
+    { "Exit Delay Cancelled",           KIND_DISARM,       SOURCE_KEYPAD,   false, false },
+    { "Entry Delay Disarmed",           KIND_DISARM,       SOURCE_KEYPAD,   false, false },
+    { "Alarm Disarmed",                 KIND_DISARM,       SOURCE_KEYPAD,   false, false },
+    { "Wrong Code Entry During Alarm",  KIND_WRONG_CODE,   SOURCE_KEYPAD,   false, false },
+    { "Keypad Locked Out",              KIND_LOCKOUT,      SOURCE_KEYPAD,   false, false },
+    { "Serial Console Locked Out",      KIND_LOCKOUT,      SOURCE_REMOTE,   false, false },
+    { "Duress Code Used",               KIND_DURESS,       SOURCE_KEYPAD,   false, false },
+    { "Door Opened",                    KIND_DOOR,         SOURCE_KEYPAD,   false, false },
+    { "Entry Started",                  KIND_DOOR,         SOURCE_KEYPAD,   false, false },
+    { "Proximity Alert",                KIND_PROXIMITY,    SOURCE_KEYPAD,   false, false },
+    { "Scheduled Arm - Home",           KIND_COMMAND,      SOURCE_SCHEDULE, true,  false },
+    { "Scheduled Arm - Away",           KIND_COMMAND,      SOURCE_SCHEDULE, true,  false },
+    { "Scheduled Disarm",               KIND_COMMAND,      SOURCE_SCHEDULE, false, false },
+    { "Serial Arm - Home",              KIND_COMMAND,      SOURCE_REMOTE,   true,  false },
+    { "Serial Arm - Away",              KIND_COMMAND,      SOURCE_REMOTE,   true,  false },
+    { "Serial Disarm",                  KIND_COMMAND,      SOURCE_REMOTE,   false, false },
+    { "System Started",                 KIND_RESTART,      SOURCE_KEYPAD,   false, false },
+    { "Warm Restart",                   KIND_RESTART,      SOURCE_KEYPAD,   false, true  },
+    { "Cold Restart",                   KIND_RESTART,      SOURCE_KEYPAD,   false, true  },
+    { "Boot: ",                         KIND_RESTART,      SOURCE_KEYPAD,   false, true  },
+};
+
+static const int RULE_COUNT = sizeof(RULES) / sizeof(RULES[0]);
+
+// Rules grouped by first character, so a message is compared against the
+// two or three texts that can match rather than the whole table
+struct RuleIndex {
+    uint8_t length[RULE_COUNT];             // strlen of each rule
+    uint8_t first[128];                     // First rule for a character
+    uint8_t count[128];                     // Rules for that character
+    uint8_t order[RULE_COUNT];              // Rule numbers grouped by character
+
+    RuleIndex() {
+        memset(first, 0, sizeof(first));
+        memset(count, 0, sizeof(count));
+        for(int i = 0; i < RULE_COUNT; i++) {
+            length[i] = (uint8_t)strlen(RULES[i].text);
+            count[(uint8_t)RULES[i].text[0]]++;
+        }
+        int n = 0;
+        for(int c = 0; c < 128; c++) {
+            first[c] = (uint8_t)n;
+            for(int i = 0; i < RULE_COUNT; i++) {
+                if(RULES[i].text[0] == c) order[n++] = (uint8_t)i;
+            }
+        }
+    }
+};
+
+static const RuleIndex ruleIndex;
+
+// Exact texts first; restart records carry details after a fixed start
+void classifyMessage(const char* text, size_t length, LogLine& out) {
+    out.kind = KIND_OTHER;
+    out.source = SOURCE_KEYPAD;
+    out.arm = false;
+    if(length == 0 || (uint8_t)text[0] >= 128) return;
+
+    uint8_t c = (uint8_t)text[0];
+    for(int n = ruleIndex.first[c]; n < ruleIndex.first[c] + ruleIndex.count[c]; n++) {
+        const MessageRule& rule = RULES[ruleIndex.order[n]];
+        size_t ruleLength = ruleIndex.length[ruleIndex.order[n]];
+        if(rule.prefix ? length < ruleLength : length != ruleLength) continue;
+        if(memcmp(text, rule.text, ruleLength) != 0) continue;
+        out.kind = rule.kind;
+        out.source = rule.source;
+        out.arm = rule.arm;
+        return;
+    }
+}
+
+// The current run is lead until the first accepted code, trail after it
+void StreakSummary::wrong() {
+    uint32_t& run = broken ? trail : lead;
+    run++;
+    if(run > longest) longest = run;
+}
+
+// Only runs closed on both sides are final; lead may still grow from the
+// previous span and trail from the next
+void StreakSummary::accepted() {
+    if(broken && trail >= MIN_RUN) runs++;
+    broken = true;
+    trail = 0;
+}
+
+// The run at the seam is this trail (or all of this span) plus next's lead
+void StreakSummary::append(const StreakSummary& next) {
+    uint32_t& seam = broken ? trail : lead;
+    seam += next.lead;
+    if(seam > longest) longest = seam;
+    if(next.longest > longest) longest = next.longest;
+    if(!next.broken) return;
+
+    if(broken && trail >= MIN_RUN) runs++;
+    runs += next.runs;
+    trail = next.trail;
+    broken = true;
+}
+
+// The file's first and last runs end at its ends
+uint32_t StreakSummary::totalRuns() const {
+    uint32_t total = runs + (lead >= MIN_RUN ? 1 : 0);
+    if(broken && trail >= MIN_RUN) total++;
+    return total;
+}
+
+// Zeroes everything
+void LogSummary::clear() {
+    memset(this, 0, sizeof(*this));
+}
+
+// A disarm within the window of the alarm it ends marks a false-alarm
+// candidate; a disarm before any alarm is kept for the previous chunk
+void LogSummary::add(const LogLine& line, uint32_t falseWindowS) {
+    lines++;
+    kinds[line.kind]++;
+    if(firstEpoch == 0 || line.epoch < firstEpoch) firstEpoch = line.epoch;
+    if(line.epoch > lastEpoch) lastEpoch = line.epoch;
+
+    switch(line.kind) {
+        case KIND_ALARM:
+            alarmsByHour[line.hour]++;
+            openAlarm = line.epoch;
+            sawAlarm = true;
+            break;
+
+        case KIND_ARM_HOME:
+        case KIND_ARM_AWAY:
+            armsByHour[line.hour]++;
+            streak.accepted();
+            break;
+
+        case KIND_EXIT_DELAY:
+            streak.accepted();
+            break;
+
+        case KIND_DISARM:
+            disarmsByHour[line.hour]++;
+            streak.accepted();
+            if(openAlarm) {
+                if(line.epoch - openAlarm <= falseWindowS) falseAlarms++;
+                openAlarm = 0;
+            } else if(!sawAlarm && !sawDisarm) {
+                firstDisarm = line.epoch;
+            }
+            sawDisarm = true;
+            break;
+
+        case KIND_WRONG_CODE:
+        case KIND_LOCKOUT:
+            streak.wrong();
+            break;
+
+        case KIND_COMMAND:
+            if(line.arm) {
+                armCommands[line.source]++;
+            } else {
+                disarmCommands[line.source]++;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Same result as scanning both chunks in one pass
+void LogSummary::append(const LogSummary& next, uint32_t falseWindowS) {
+    if(openAlarm && next.firstDisarm && next.firstDisarm - openAlarm <= falseWindowS) falseAlarms++;
+    if(next.sawAlarm) {
+        openAlarm = next.openAlarm;
+    } else if(next.sawDisarm) {
+        openAlarm = 0;
+    }
+    if(!sawAlarm && !sawDisarm) firstDisarm = next.firstDisarm;
+    sawAlarm |= next.sawAlarm;
+    sawDisarm |= next.sawDisarm;
+
+    streak.append(next.streak);
+    accumulate(next);
+}
+
+// Plain sums; the streak and pairing state stay with each panel
+void LogSummary::accumulate(const LogSummary& other) {
+    lines += other.lines;
+    malformed += other.malformed;
+    bytes += other.bytes;
+    for(int i = 0; i < KIND_COUNT; i++) kinds[i] += other.kinds[i];
+    for(int h = 0; h < 24; h++) {
+        alarmsByHour[h] += other.alarmsByHour[h];
+        armsByHour[h] += other.armsByHour[h];
+        disarmsByHour[h] += other.disarmsByHour[h];
+    }
+    for(int s = 0; s < SOURCE_COUNT; s++) {
+        armCommands[s] += other.armCommands[s];
+        disarmCommands[s] += other.disarmCommands[s];
+    }
+    if(other.firstEpoch && (firstEpoch == 0 || other.firstEpoch < firstEpoch)) firstEpoch = other.firstEpoch;
+    if(other.lastEpoch > lastEpoch) lastEpoch = other.lastEpoch;
+    falseAlarms += other.falseAlarms;
+}
+
+// Blank lines (a torn write's leftovers) are skipped, not counted
+void scanLog(const char* begin, const char* end, uint32_t falseWindowS, LogSummary& out) {
+    out.clear();
+    out.bytes = (uint64_t)(end - begin);
+
+    DateCache cache;
+    cache.valid = false;
+    LineScanner scanner(begin, end);
+    const char* text;
+    size_t length;
+    while(scanner.next(text, length)) {
+        if(length && text[length - 1] == '\r') length--;
+        if(length == 0) continue;
+        LogLine line;
+        if(parseLine(text, length, cache, line)) {
+            out.add(line, falseWindowS);
+        } else {
+            out.malformed++;
+        }
+    }
+}
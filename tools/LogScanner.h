@@ -0,0 +1,154 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstddef>         // size_t
+#include <cstdint>         // Standard integer types
+
+// Event log analysis for loganalyze - parses the lines logEvent() writes,
+//   YYYY-MM-DD HH:MM:SS - message\n
+// straight out of a mapped file. Nothing here allocates: lines are
+// (pointer, length) views and every result is a fixed-size counter table.
+
+// Message categories, from the texts the firmware logs
+enum LogKind : uint8_t {
+    KIND_OTHER,             // Anything not listed below
+    KIND_RESTART,           // Boot and restart records
+    KIND_ALARM,             // Alarm started
+    KIND_ALARM_CAUSE,       // What started it (sensor, panic, entry delay expiry)
+    KIND_ARM_HOME,          // Armed home
+    KIND_ARM_AWAY,          // Armed away
+    KIND_EXIT_DELAY,        // Exit delay started
+    KIND_DISARM,            // Disarmed, from any state
+    KIND_WRONG_CODE,        // Wrong code during an alarm
+    KIND_LOCKOUT,           // Keypad or console locked out
+    KIND_DURESS,            // Duress code used
+    KIND_DOOR,              // Door opened (not an alarm)
+    KIND_PROXIMITY,         // Proximity chime in home mode
+    KIND_COMMAND,           // Schedule or console command about to run (see LogSource)
+    KIND_COUNT
+};
+
+// Who armed or disarmed - schedule and console commands log a line of
+// their own before the arm/disarm line, keypad commands do not
+enum LogSource : uint8_t {
+    SOURCE_KEYPAD,          // Code at the panel
+    SOURCE_SCHEDULE,        // Weekly schedule
+    SOURCE_REMOTE,          // Serial console
+    SOURCE_COUNT
+};
+
+// One parsed line
+struct LogLine {
+    uint32_t epoch;         // Unix seconds
+    uint8_t hour;           // 0-23
+    LogKind kind;           // Category
+    LogSource source;       // Origin of a KIND_COMMAND
+    bool arm;               // KIND_COMMAND arms (else disarms)
+};
+
+// Finds line ends 64 bytes at a time
+// Each block is turned into a bitmask of newline positions with the widest
+// vector compare the build allows (AVX2, SSE2 or NEON, scalar otherwise);
+// next() then walks the set bits, so the per-line cost is a bit scan.
+class LineScanner {
+public:
+    // Parameters:
+    //   begin, end: Text to split, usually a whole mapped file or a chunk of one
+    LineScanner(const char* begin, const char* end);
+
+    // Returns the next line without its '\n' (the last may have none)
+    // Returns: false once the text is exhausted
+    bool next(const char*& line, size_t& length);
+
+private:
+    const char* _block;     // Start of the 64-byte block _mask describes
+    const char* _end;       // End of the text
+    const char* _line;      // Start of the next line
+    uint64_t _mask;         // Newlines in _block not yet returned
+
+    void load();            // Builds _mask for _block
+};
+
+// Caches the day number of the last date seen - log lines come in date
+// order, so the calendar arithmetic runs about once a day of log
+struct DateCache {
+    char date[10];          // "YYYY-MM-DD" of the cached day
+    uint32_t days;          // Its day number since 1970-01-01
+    bool valid;             // Anything cached yet
+};
+
+// Parses one line
+// Parameters:
+//   text, length: The line without '\n'
+//   cache:        Per-thread date cache
+//   out:          Receives the timestamp and category
+// Returns: false if the line is not in logEvent() format
+bool parseLine(const char* text, size_t length, DateCache& cache, LogLine& out);
+
+// Categorises a message
+// Parameters:
+//   text, length: Message after " - "
+//   out:          Receives kind, source and arm
+void classifyMessage(const char* text, size_t length, LogLine& out);
+
+// Runs of wrong codes and lockouts not broken by an accepted code
+// (an arm or disarm). Composable: a chunk's summary can be appended to
+// the previous chunk's, so files split across threads give the same
+// result as one sequential pass.
+struct StreakSummary {
+    static const uint32_t MIN_RUN = 3;  // Shortest run reported as a streak
+
+    bool broken;            // An accepted code occurred in this span
+    uint32_t lead;          // Run before the first accepted code (all, if none)
+    uint32_t trail;         // Run after the last accepted code
+    uint32_t runs;          // Completed runs of MIN_RUN or more between accepted codes
+    uint32_t longest;       // Longest run seen, completed or not
+
+    void wrong();           // One more wrong code
+    void accepted();        // Run broken
+    void append(const StreakSummary& next);  // This span followed by next
+    uint32_t totalRuns() const;             // Runs, counting both ends of the file
+};
+
+// Counters for one chunk of one panel's log
+struct LogSummary {
+    static const uint32_t FALSE_ALARM_WINDOW_S = 120;  // Default disarm delay that marks a false-alarm candidate
+
+    uint64_t lines;                     // Lines parsed
+    uint64_t malformed;                 // Lines not in logEvent() format
+    uint64_t bytes;                     // Text scanned
+    uint64_t kinds[KIND_COUNT];         // Lines per category
+    uint32_t alarmsByHour[24];          // Alarms per hour of day
+    uint32_t armsByHour[24];            // Arms (home or away) per hour of day
+    uint32_t disarmsByHour[24];         // Disarms per hour of day
+    uint32_t armCommands[SOURCE_COUNT];      // Schedule and console arm commands (keypad = the rest)
+    uint32_t disarmCommands[SOURCE_COUNT];   // Schedule and console disarm commands
+    uint32_t firstEpoch;                // Earliest timestamp, 0 = none
+    uint32_t lastEpoch;                 // Latest timestamp
+    uint32_t falseAlarms;               // Alarms disarmed within the window
+    StreakSummary streak;               // Wrong-code runs
+
+    // Alarm/disarm pairing across chunk boundaries
+    uint32_t openAlarm;                 // Last alarm not yet disarmed, 0 = none
+    uint32_t firstDisarm;               // First disarm before any alarm in the chunk, 0 = none
+    bool sawAlarm;                      // Chunk contains an alarm
+    bool sawDisarm;                     // Chunk contains a disarm
+
+    void clear();
+
+    // Accounts one line
+    void add(const LogLine& line, uint32_t falseWindowS);
+
+    // This chunk followed by the next chunk of the same log
+    void append(const LogSummary& next, uint32_t falseWindowS);
+
+    // Adds another panel's totals (order does not matter)
+    void accumulate(const LogSummary& other);
+};
+
+// Scans text into a summary
+// Parameters:
+//   begin, end:   Whole lines of one log
+//   falseWindowS: Alarm-to-disarm time that marks a false-alarm candidate
+//   out:          Receives the counters (cleared first)
+void scanLog(const char* begin, const char* end, uint32_t falseWindowS, LogSummary& out);
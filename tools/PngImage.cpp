@@ -0,0 +1,518 @@
+#include "PngImage.h"
+#include <cstring>
+#include "Checksum.h"      // Chunk CRC-32
+
+// Deflate bits come least significant first
+struct BitReader {
+    const uint8_t* data;    // Stream
+    size_t size;            // Bytes in the stream
+    size_t pos;             // Next byte to load
+    uint32_t buffer;        // Loaded bits not yet used
+    int count;              // Bits in buffer (always < 8 between calls)
+    bool overrun;           // Ran past the end
+
+    int bits(int n) {
+        while(count < n) {
+            if(pos >= size) {
+                overrun = true;
+                return 0;
+            }
+            buffer |= (uint32_t)data[pos++] << count;
+            count += 8;
+        }
+        int value = (int)(buffer & ((1u << n) - 1));
+        buffer >>= n;
+        count -= n;
+        return value;
+    }
+
+    // Drops the rest of the current byte
+    void align() {
+        buffer = 0;
+        count = 0;
+    }
+};
+
+static const int MAX_BITS = 15;         // Longest deflate code
+static const int MAX_LENGTH_CODES = 286;
+static const int MAX_DIST_CODES = 30;
+static const int FIXED_LENGTH_CODES = 288;
+
+// Canonical Huffman code: number of codes per length, then symbols in code order
+struct Huffman {
+    uint16_t count[MAX_BITS + 1];
+    uint16_t symbol[FIXED_LENGTH_CODES];
+};
+
+// Returns: 0 for a complete code, > 0 if incomplete, < 0 if over-subscribed
+static int buildHuffman(Huffman& h, const uint8_t* lengths, int n) {
+    memset(h.count, 0, sizeof(h.count));
+    for(int s = 0; s < n; s++) h.count[lengths[s]]++;
+    if(h.count[0] == n) return 0;       // No codes - only valid for an unused distance table
+
+    int left = 1;
+    for(int len = 1; len <= MAX_BITS; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if(left < 0) return left;
+    }
+
+    uint16_t offset[MAX_BITS + 1];
+    offset[1] = 0;
+    for(int len = 1; len < MAX_BITS; len++) offset[len + 1] = offset[len] + h.count[len];
+    for(int s = 0; s < n; s++) {
+        if(lengths[s]) h.symbol[offset[lengths[s]]++] = (uint16_t)s;
+    }
+    return left;
+}
+
+// One symbol, reading the code a bit at a time
+// Returns: symbol, or -1 for an invalid code or the end of the stream
+static int decodeSymbol(BitReader& in, const Huffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for(int len = 1; len <= MAX_BITS; len++) {
+        code |= in.bits(1);
+        if(in.overrun) return -1;
+        int count = h.count[len];
+        if(code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Literals and matches until the end-of-block code
+static bool inflateCodes(BitReader& in, const Huffman& lengths, const Huffman& distances,
+                         std::vector<uint8_t>& out, size_t start, std::string& error) {
+    while(true) {
+        int symbol = decodeSymbol(in, lengths);
+        if(symbol < 0) {
+            error = "bad literal/length code";
+            return false;
+        }
+        if(symbol < 256) {
+            out.push_back((uint8_t)symbol);
+            continue;
+        }
+        if(symbol == 256) return true;
+
+        symbol -= 257;
+        if(symbol >= 29) {
+            error = "bad length symbol";
+            return false;
+        }
+        size_t length = LENGTH_BASE[symbol] + in.bits(LENGTH_EXTRA[symbol]);
+        int dsym = decodeSymbol(in, distances);
+        if(dsym < 0 || dsym >= MAX_DIST_CODES) {
+            error = "bad distance code";
+            return false;
+        }
+        size_t distance = DIST_BASE[dsym] + in.bits(DIST_EXTRA[dsym]);
+        if(in.overrun) {
+            error = "stream truncated";
+            return false;
+        }
+        if(distance > out.size() - start) {
+            error = "distance before start of stream";
+            return false;
+        }
+        size_t from = out.size() - distance;
+        for(size_t i = 0; i < length; i++) out.push_back(out[from + i]);    // May overlap itself
+    }
+}
+
+// Block type 0 - bytes copied as they are
+static bool inflateStored(BitReader& in, std::vector<uint8_t>& out, std::string& error) {
+    in.align();
+    if(in.size - in.pos < 4) {
+        error = "stream truncated";
+        return false;
+    }
+    const uint8_t* p = in.data + in.pos;
+    unsigned length = p[0] | (p[1] << 8);
+    unsigned inverse = p[2] | (p[3] << 8);
+    if(length != (~inverse & 0xFFFF)) {
+        error = "stored block length mismatch";
+        return false;
+    }
+    in.pos += 4;
+    if(in.size - in.pos < length) {
+        error = "stream truncated";
+        return false;
+    }
+    out.insert(out.end(), in.data + in.pos, in.data + in.pos + length);
+    in.pos += length;
+    return true;
+}
+
+// Block type 1 - the codes fixed by RFC 1951
+static bool inflateFixed(BitReader& in, std::vector<uint8_t>& out, size_t start, std::string& error) {
+    static Huffman lengths;
+    static Huffman distances;
+    static bool built = false;
+    if(!built) {
+        uint8_t bits[FIXED_LENGTH_CODES];
+        int s = 0;
+        for(; s < 144; s++) bits[s] = 8;
+        for(; s < 256; s++) bits[s] = 9;
+        for(; s < 280; s++) bits[s] = 7;
+        for(; s < FIXED_LENGTH_CODES; s++) bits[s] = 8;
+        buildHuffman(lengths, bits, FIXED_LENGTH_CODES);
+        for(s = 0; s < MAX_DIST_CODES; s++) bits[s] = 5;
+        buildHuffman(distances, bits, MAX_DIST_CODES);
+        built = true;
+    }
+    return inflateCodes(in, lengths, distances, out, start, error);
+}
+
+// Block type 2 - code lengths sent, themselves Huffman coded
+static bool inflateDynamic(BitReader& in, std::vector<uint8_t>& out, size_t start, std::string& error) {
+    static const uint8_t ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    int nlen = in.bits(5) + 257;
+    int ndist = in.bits(5) + 1;
+    int ncode = in.bits(4) + 4;
+    if(nlen > MAX_LENGTH_CODES || ndist > MAX_DIST_CODES) {
+        error = "bad code counts";
+        return false;
+    }
+
+    uint8_t bits[MAX_LENGTH_CODES + MAX_DIST_CODES];
+    memset(bits, 0, sizeof(bits));
+    for(int i = 0; i < ncode; i++) bits[ORDER[i]] = (uint8_t)in.bits(3);
+    Huffman lengthCode;
+    if(buildHuffman(lengthCode, bits, 19) != 0) {
+        error = "incomplete code length code";
+        return false;
+    }
+
+    int index = 0;
+    while(index < nlen + ndist) {
+        int symbol = decodeSymbol(in, lengthCode);
+        if(symbol < 0) {
+            error = "bad code length code";
+            return false;
+        }
+        if(symbol < 16) {
+            bits[index++] = (uint8_t)symbol;
+            continue;
+        }
+        uint8_t value = 0;
+        int repeat;
+        if(symbol == 16) {
+            if(index == 0) {
+                error = "repeat with no previous length";
+                return false;
+            }
+            value = bits[index - 1];
+            repeat = 3 + in.bits(2);
+        } else if(symbol == 17) {
+            repeat = 3 + in.bits(3);
+        } else {
+            repeat = 11 + in.bits(7);
+        }
+        if(index + repeat > nlen + ndist) {
+            error = "too many code lengths";
+            return false;
+        }
+        while(repeat--) bits[index++] = value;
+    }
+    if(bits[256] == 0) {
+        error = "no end-of-block code";
+        return false;
+    }
+
+    Huffman lengths;
+    Huffman distances;
+    int err = buildHuffman(lengths, bits, nlen);
+    if(err < 0 || (err > 0 && nlen - lengths.count[0] != 1)) {
+        error = "bad literal/length lengths";
+        return false;
+    }
+    err = buildHuffman(distances, bits + nlen, ndist);
+    if(err < 0 || (err > 0 && ndist - distances.count[0] != 1)) {
+        error = "bad distance lengths";
+        return false;
+    }
+    return inflateCodes(in, lengths, distances, out, start, error);
+}
+
+static uint32_t readBe32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Paeth predictor from the PNG specification
+static uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    if(pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+// zlib wrapper around deflate blocks, then the Adler-32 of the output
+bool inflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string& error) {
+    if(size < 6) {
+        error = "zlib stream too short";
+        return false;
+    }
+    if((data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+        error = "not a plain zlib stream";
+        return false;
+    }
+
+    BitReader in = { data, size, 2, 0, 0, false };
+    size_t start = out.size();
+    int last;
+    do {
+        last = in.bits(1);
+        int type = in.bits(2);
+        bool ok;
+        if(type == 0) ok = inflateStored(in, out, error);
+        else if(type == 1) ok = inflateFixed(in, out, start, error);
+        else if(type == 2) ok = inflateDynamic(in, out, start, error);
+        else {
+            error = "bad block type";
+            ok = false;
+        }
+        if(ok && in.overrun) {
+            error = "stream truncated";
+            ok = false;
+        }
+        if(!ok) return false;
+    } while(!last);
+
+    in.align();
+    if(in.size - in.pos < 4) {
+        error = "missing Adler-32";
+        return false;
+    }
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for(size_t i = start; i < out.size(); i++) {
+        a = (a + out[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    if(((b << 16) | a) != readBe32(in.data + in.pos)) {
+        error = "Adler-32 mismatch";
+        return false;
+    }
+    return true;
+}
+
+// Chunks are checked and collected, then the joined IDAT data is inflated,
+// unfiltered row by row and expanded to RGBA
+bool decodePng(const uint8_t* data, size_t size, PngImage& image, std::string& error) {
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if(size < 8 || memcmp(data, SIGNATURE, 8) != 0) {
+        error = "not a PNG file";
+        return false;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int depth = 0;
+    int colorType = -1;
+    uint8_t palette[256][4];
+    int paletteSize = 0;
+    bool keyed = false;             // tRNS colour key for greyscale/RGB
+    uint16_t key[3] = { 0, 0, 0 };
+    std::vector<uint8_t> compressed;
+    bool ended = false;
+
+    size_t pos = 8;
+    while(!ended) {
+        if(size - pos < 12) {
+            error = "file truncated";
+            return false;
+        }
+        uint32_t length = readBe32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if(length > size - pos - 12) {
+            error = "file truncated";
+            return false;
+        }
+        if(crc32(type, length + 4) != readBe32(body + length)) {
+            error = std::string("CRC mismatch in ") + std::string((const char*)type, 4) + " chunk";
+            return false;
+        }
+
+        if(memcmp(type, "IHDR", 4) == 0) {
+            if(length != 13) {
+                error = "bad IHDR";
+                return false;
+            }
+            width = readBe32(body);
+            height = readBe32(body + 4);
+            depth = body[8];
+            colorType = body[9];
+            if(body[10] != 0 || body[11] != 0) {
+                error = "unknown compression or filter method";
+                return false;
+            }
+            if(body[12] != 0) {
+                error = "interlaced images are not supported";
+                return false;
+            }
+        } else if(memcmp(type, "PLTE", 4) == 0) {
+            paletteSize = (int)(length / 3);
+            if(paletteSize > 256 || length % 3) {
+                error = "bad palette";
+                return false;
+            }
+            for(int i = 0; i < paletteSize; i++) {
+                palette[i][0] = body[i * 3];
+                palette[i][1] = body[i * 3 + 1];
+                palette[i][2] = body[i * 3 + 2];
+                palette[i][3] = 255;
+            }
+        } else if(memcmp(type, "tRNS", 4) == 0) {
+            if(colorType == 3) {
+                for(uint32_t i = 0; i < length && i < (uint32_t)paletteSize; i++) palette[i][3] = body[i];
+            } else if(colorType == 0 && length >= 2) {
+                keyed = true;
+                key[0] = (uint16_t)((body[0] << 8) | body[1]);
+            } else if(colorType == 2 && length >= 6) {
+                keyed = true;
+                for(int c = 0; c < 3; c++) key[c] = (uint16_t)((body[c * 2] << 8) | body[c * 2 + 1]);
+            }
+        } else if(memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), body, body + length);
+        } else if(memcmp(type, "IEND", 4) == 0) {
+            ended = true;
+        } else if(!(type[0] & 0x20)) {
+            error = std::string("unknown critical chunk ") + std::string((const char*)type, 4);
+            return false;
+        }
+        pos += 12 + length;
+    }
+
+    int channels;
+    switch(colorType) {
+        case 0: channels = 1; break;    // Greyscale
+        case 2: channels = 3; break;    // RGB
+        case 3: channels = 1; break;    // Palette index
+        case 4: channels = 2; break;    // Greyscale and alpha
+        case 6: channels = 4; break;    // RGBA
+        default:
+            error = "missing IHDR or bad colour type";
+            return false;
+    }
+    bool depthOk = depth == 8 || depth == 16 || ((colorType == 0 || colorType == 3) && depth < 8 &&
+                                                 (depth == 1 || depth == 2 || depth == 4));
+    if(!depthOk || (colorType == 3 && depth == 16)) {
+        error = "bad bit depth";
+        return false;
+    }
+    if(colorType == 3 && paletteSize == 0) {
+        error = "missing palette";
+        return false;
+    }
+    if(width == 0 || height == 0 || width > 16384 || height > 16384) {
+        error = "bad image size";
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+    if(!inflateZlib(compressed.data(), compressed.size(), raw, error)) return false;
+
+    size_t pixelBits = (size_t)channels * depth;
+    size_t stride = (width * pixelBits + 7) / 8;
+    size_t step = pixelBits >= 8 ? pixelBits / 8 : 1;      // Filter distance in bytes
+    if(raw.size() < height * (stride + 1)) {
+        error = "image data too short";
+        return false;
+    }
+
+    // Undo the filters in place; row y's filtered bytes follow its type byte
+    std::vector<uint8_t> prior(stride, 0);
+    std::vector<uint8_t> rows(height * stride);
+    for(uint32_t y = 0; y < height; y++) {
+        const uint8_t* in = &raw[y * (stride + 1)];
+        uint8_t filter = in[0];
+        in++;
+        uint8_t* row = &rows[y * stride];
+        const uint8_t* up = y ? &rows[(y - 1) * stride] : prior.data();
+        for(size_t i = 0; i < stride; i++) {
+            int a = i >= step ? row[i - step] : 0;
+            int b = up[i];
+            int c = i >= step ? up[i - step] : 0;
+            switch(filter) {
+                case 0: row[i] = in[i]; break;
+                case 1: row[i] = (uint8_t)(in[i] + a); break;
+                case 2: row[i] = (uint8_t)(in[i] + b); break;
+                case 3: row[i] = (uint8_t)(in[i] + ((a + b) >> 1)); break;
+                case 4: row[i] = (uint8_t)(in[i] + paeth(a, b, c)); break;
+                default:
+                    error = "bad filter type";
+                    return false;
+            }
+        }
+    }
+
+    // Samples to 8-bit RGBA
+    image.width = width;
+    image.height = height;
+    image.rgba.assign((size_t)width * height * 4, 0);
+    int maxSample = (1 << depth) - 1;
+    for(uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = &rows[y * stride];
+        for(uint32_t x = 0; x < width; x++) {
+            uint16_t sample[4];         // Full-precision samples of this pixel
+            for(int c = 0; c < channels; c++) {
+                size_t bit = ((size_t)x * channels + c) * depth;
+                if(depth == 16) sample[c] = (uint16_t)((row[bit / 8] << 8) | row[bit / 8 + 1]);
+                else if(depth == 8) sample[c] = row[bit / 8];
+                else sample[c] = (uint16_t)((row[bit / 8] >> (8 - depth - bit % 8)) & maxSample);
+            }
+            uint8_t* out = &image.rgba[((size_t)y * width + x) * 4];
+            auto to8 = [&](uint16_t s) -> uint8_t {
+                return (uint8_t)(depth == 16 ? s >> 8 : depth == 8 ? s : s * 255 / maxSample);
+            };
+            switch(colorType) {
+                case 0:
+                    out[0] = out[1] = out[2] = to8(sample[0]);
+                    out[3] = keyed && sample[0] == key[0] ? 0 : 255;
+                    break;
+                case 2:
+                    for(int c = 0; c < 3; c++) out[c] = to8(sample[c]);
+                    out[3] = keyed && sample[0] == key[0] && sample[1] == key[1] && sample[2] == key[2] ? 0 : 255;
+                    break;
+                case 3:
+                    if(sample[0] >= paletteSize) {
+                        error = "palette index out of range";
+                        return false;
+                    }
+                    memcpy(out, palette[sample[0]], 4);
+                    break;
+                case 4:
+                    out[0] = out[1] = out[2] = to8(sample[0]);
+                    out[3] = to8(sample[1]);
+                    break;
+                default:
+                    for(int c = 0; c < 4; c++) out[c] = to8(sample[c]);
+                    break;
+            }
+        }
+    }
+    return true;
+}
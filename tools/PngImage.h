@@ -0,0 +1,36 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstddef>         // size_t
+#include <cstdint>         // Standard integer types
+#include <string>          // Error text
+#include <vector>          // Pixel and stream buffers
+
+// Minimal PNG reader for mkassets
+// Handles every non-interlaced PNG: greyscale, RGB, palette, with or
+// without alpha, 1 to 16 bits per sample. Ancillary chunks are skipped.
+// The zlib stream is decoded by a small inflate of its own, so the tool
+// needs nothing beyond the standard library.
+
+// Decoded image, 8-bit RGBA rows top to bottom
+struct PngImage {
+    uint32_t width;                 // Pixels
+    uint32_t height;                // Pixels
+    std::vector<uint8_t> rgba;      // width * height * 4 bytes
+};
+
+// Decodes a zlib stream (RFC 1950/1951) and checks its Adler-32
+// Parameters:
+//   data, size: Compressed stream
+//   out:        Receives the decompressed bytes (appended)
+//   error:      Reason on failure
+// Returns: true if the stream was complete and intact
+bool inflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out, std::string& error);
+
+// Decodes a PNG file held in memory
+// Parameters:
+//   data, size: File contents
+//   image:      Receives the pixels
+//   error:      Reason on failure
+// Returns: true if successful
+bool decodePng(const uint8_t* data, size_t size, PngImage& image, std::string& error);
@@ -0,0 +1,79 @@
+#include "TelemetryReceiver.h"
+#include <poll.h>
+
+// Constructor - no panels yet
+TelemetryReceiver::TelemetryReceiver(Handler handler) :
+    _handler(handler)
+{
+}
+
+// Open in raw mode; nothing is sent until request()
+int TelemetryReceiver::add(const char* device) {
+    int fd = ConsoleLink::openDevice(device);
+    if(fd < 0) return -1;
+    Panel panel;
+    panel.device = device;
+    panel.link.reset(new ConsoleLink(fd));
+    panel.stats = PanelStats();
+    panel.stats.open = true;
+    _panels.push_back(std::move(panel));
+    return (int)_panels.size() - 1;
+}
+
+// CMD_TELEMETRY to every open panel; replies are skipped by poll()
+void TelemetryReceiver::request(int periodS) {
+    uint8_t payload[2];
+    putU16(payload, (uint16_t)(periodS < 0 ? 0 : periodS));
+    for(Panel& panel : _panels) {
+        if(panel.stats.open) panel.link->send(CMD_TELEMETRY, payload, periodS < 0 ? 0 : sizeof(payload));
+    }
+}
+
+// One poll() over every open panel
+int TelemetryReceiver::poll(int timeoutMs) {
+    std::vector<struct pollfd> fds;
+    std::vector<int> indices;
+    for(size_t i = 0; i < _panels.size(); i++) {
+        if(!_panels[i].stats.open) continue;
+        fds.push_back({ _panels[i].link->fd(), POLLIN, 0 });
+        indices.push_back((int)i);
+    }
+    if(fds.empty()) return -1;
+    if(::poll(fds.data(), fds.size(), timeoutMs) < 0) return -1;
+
+    int handled = 0;
+    for(size_t i = 0; i < fds.size(); i++) {
+        if(fds[i].revents & POLLIN) handled += drain(indices[i]);
+        if(fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) _panels[indices[i]].stats.open = false;
+    }
+    return handled;
+}
+
+// Everything already received, without blocking; replies and debug text
+// on the same port are skipped. A frame cut off by the end of a read stays
+// in the link's parser until the next drain.
+int TelemetryReceiver::drain(int index) {
+    Panel& panel = _panels[index];
+    ConsoleFrame frame;
+    int handled = 0;
+    while(panel.link->receive(frame, 0)) {
+        if(frame.command != TELEMETRY_PUSH) continue;
+        panel.stats.frames++;
+        panel.stats.bytes += frame.length + CONSOLE_OVERHEAD;
+        int32_t changed = panel.decoder.decode(frame.payload, frame.length);
+        if(changed < 0) {
+            panel.stats.malformed++;
+        } else if(changed > 0) {
+            _handler(index, panel.decoder.snapshot(), (uint32_t)changed);
+            handled++;
+        }
+    }
+    return handled;
+}
+
+// Loss comes from the decoder's sequence tracking
+TelemetryReceiver::PanelStats TelemetryReceiver::stats(int panel) const {
+    PanelStats stats = _panels[panel].stats;
+    stats.lost = _panels[panel].decoder.lost();
+    return stats;
+}
@@ -0,0 +1,79 @@
+#pragma once    // Prevent multiple inclusions of this header file
+
+// Include required libraries
+#include <cstdint>         // Standard integer types
+#include <functional>      // Frame handler
+#include <memory>          // Owned links
+#include <string>          // Device names
+#include <vector>          // Panel list
+#include "ConsoleLink.h"   // Serial device and frame decoding
+#include "TelemetryProtocol.h"  // Push payload decoding
+
+// Monitoring station end of the telemetry stream
+// Listens to any number of panels - USB serial devices or ptys - from one
+// thread: poll() waits on all of them and decodes every complete frame.
+// Each panel keeps its own decoder, so a lost frame on one only affects
+// that panel until its next keyframe.
+class TelemetryReceiver {
+public:
+    // Called for every frame that changed a panel's snapshot
+    // Parameters:
+    //   panel:    Index returned by add()
+    //   snapshot: The panel's values after the frame
+    //   changed:  Mask of TelemetryField bits the frame updated
+    typedef std::function<void(int panel, const TelemetrySnapshot& snapshot, uint32_t changed)> Handler;
+
+    // Per-panel counters
+    struct PanelStats {
+        uint32_t frames;        // Push frames received
+        uint32_t bytes;         // Their size on the wire
+        uint32_t lost;          // Frames missed (sequence gaps)
+        uint32_t malformed;     // Payloads that did not decode
+        bool open;              // Device still connected
+    };
+
+    explicit TelemetryReceiver(Handler handler);
+
+    // Starts listening to a panel
+    // Parameters:
+    //   device: Serial device or pty path
+    // Returns: panel index, or -1 (errno set)
+    int add(const char* device);
+
+    // Sets every panel's push period and asks for a keyframe
+    // Parameters:
+    //   periodS: Seconds between periodic frames, -1 = leave unchanged
+    void request(int periodS = -1);
+
+    // Waits for data and handles every frame received
+    // Parameters:
+    //   timeoutMs: Longest wait, -1 = until a panel sends something
+    // Returns: frames handled, or -1 once no panel is connected
+    int poll(int timeoutMs);
+
+    // Returns: number of panels added
+    int count() const { return (int)_panels.size(); }
+
+    // Returns: device path of a panel
+    const std::string& device(int panel) const { return _panels[panel].device; }
+
+    // Returns: a panel's last known values
+    const TelemetrySnapshot& snapshot(int panel) const { return _panels[panel].decoder.snapshot(); }
+
+    // Returns: a panel's counters
+    PanelStats stats(int panel) const;
+
+private:
+    // One connected panel
+    struct Panel {
+        std::string device;                 // Path it was opened with
+        std::unique_ptr<ConsoleLink> link;  // Device and frame parser
+        TelemetryDecoder decoder;           // Snapshot rebuilt from pushes
+        PanelStats stats;                   // Counters
+    };
+
+    std::vector<Panel> _panels;     // Indexed by panel number
+    Handler _handler;               // Frame callback
+
+    int drain(int index);           // Handles the frames buffered for one panel
+};
@@ -0,0 +1,86 @@
+// lockout_test - host checks of the wrong-code lockout policy
+//
+//   ctest --test-dir build-tools
+//
+// Exit status is 0 when every check passed.
+
+#include <cstdio>
+#include "LockoutPolicy.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if(!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while(0)
+
+static const uint64_t DAY_MS = 24ull * 3600 * 1000;
+
+// Records wrong codes until one starts a lockout
+static void lockOut(LockoutPolicy& policy, LockoutSource source, uint64_t now) {
+    for(int i = 0; i < LockoutPolicy::MAX_FAILURES; i++) policy.recordFailure(source, now);
+}
+
+// No failures at all - never locked, however long the panel has been up
+static void testLongUptime() {
+    LockoutPolicy policy;
+    const uint64_t times[] = { 0, 1, 0x7FFFFFFFull, 0x80000000ull, 0x80000001ull,
+                               25 * DAY_MS, 0xFFFFFFFFull, 0x100000000ull, 60 * DAY_MS, 400 * DAY_MS };
+    for(uint64_t now : times) {
+        CHECK(policy.remaining(SOURCE_KEYPAD, now) == 0);
+        CHECK(policy.remaining(SOURCE_SERIAL, now) == 0);
+    }
+}
+
+// A lockout ends when its window passes and stays ended
+static void testLockoutExpires() {
+    LockoutPolicy policy;
+    uint64_t start = 1000;
+    lockOut(policy, SOURCE_KEYPAD, start);
+    CHECK(policy.remaining(SOURCE_KEYPAD, start) == LockoutPolicy::BASE_LOCKOUT_MS);
+    CHECK(policy.remaining(SOURCE_SERIAL, start) == 0);     // Sources are separate
+
+    uint64_t end = start + LockoutPolicy::BASE_LOCKOUT_MS;
+    CHECK(policy.remaining(SOURCE_KEYPAD, end - 1) == 1);
+    CHECK(policy.remaining(SOURCE_KEYPAD, end) == 0);
+    CHECK(policy.remaining(SOURCE_KEYPAD, end + 0x80000000ull) == 0);
+    CHECK(policy.remaining(SOURCE_KEYPAD, end + 0x100000000ull) == 0);
+    CHECK(policy.remaining(SOURCE_KEYPAD, end + 100 * DAY_MS) == 0);
+}
+
+// Windows double up to the cap and are forgiven after a quiet hour
+static void testBackoff() {
+    LockoutPolicy policy;
+    uint64_t now = 30 * DAY_MS;         // Past the 32-bit sign boundary
+    uint32_t window = LockoutPolicy::BASE_LOCKOUT_MS;
+    for(int i = 0; i < 8; i++) {
+        lockOut(policy, SOURCE_SERIAL, now);
+        CHECK(policy.remaining(SOURCE_SERIAL, now) == window);
+        CHECK(!policy.recordFailure(SOURCE_SERIAL, now + 1));      // Not counted while locked
+        now += window;
+        window = window * 2 < LockoutPolicy::MAX_LOCKOUT_MS ? window * 2 : LockoutPolicy::MAX_LOCKOUT_MS;
+    }
+    CHECK(policy.nextWindow(SOURCE_SERIAL) == LockoutPolicy::MAX_LOCKOUT_MS);
+
+    now += LockoutPolicy::FORGET_MS;
+    lockOut(policy, SOURCE_SERIAL, now);
+    CHECK(policy.remaining(SOURCE_SERIAL, now) == LockoutPolicy::BASE_LOCKOUT_MS);
+
+    policy.recordSuccess(SOURCE_SERIAL);
+    CHECK(policy.nextWindow(SOURCE_SERIAL) == LockoutPolicy::BASE_LOCKOUT_MS);
+}
+
+int main() {
+    testLongUptime();
+    testLockoutExpires();
+    testBackoff();
+    if(failures) {
+        fprintf(stderr, "lockout_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("lockout_test: ok\n");
+    return 0;
+}
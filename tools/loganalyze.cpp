@@ -0,0 +1,286 @@
+// loganalyze - statistics over archived event logs
+//
+//   loganalyze [-j threads] [-w seconds] <file or directory> [...]
+//
+// Every file given, and every *.txt under a directory given, is one panel's
+// events.txt (as saved by "panelctl log"). A file named events.txt is
+// reported under its directory's name. Prints one row per panel, then the
+// fleet totals with alarms, arms and disarms by hour of day.
+//
+// -j sets the worker threads (default: all cores). -w sets how soon after
+// an alarm a disarm marks it as a false-alarm candidate (default 120 s).
+// Throughput goes to stderr.
+//
+// Files are memory-mapped and cut into chunks at line boundaries; workers
+// take chunks from a shared counter and scan them independently, and each
+// panel's chunks are then joined in file order.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "LogScanner.h"
+
+static const size_t CHUNK_BYTES = 16u << 20;    // Work unit: large enough to amortise, small enough to balance
+
+// One mapped log
+struct Panel {
+    std::string path;           // File
+    std::string name;           // Reported name
+    const char* text;           // Mapping, nullptr if empty
+    size_t size;                // Bytes
+    size_t firstChunk;          // Index of its first chunk
+    size_t chunks;              // Chunk count
+};
+
+// One unit of work
+struct Chunk {
+    const char* begin;          // First byte (start of a line)
+    const char* end;            // One past the last byte (after a newline, or end of file)
+};
+
+// Adds path, or the logs under it if it is a directory
+static bool collect(const std::string& path, bool fromDirectory, std::vector<Panel>& panels) {
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "loganalyze: %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    if(S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if(!dir) {
+            fprintf(stderr, "loganalyze: %s: %s\n", path.c_str(), strerror(errno));
+            return false;
+        }
+        std::vector<std::string> entries;
+        while(struct dirent* entry = readdir(dir)) {
+            if(entry->d_name[0] != '.') entries.push_back(entry->d_name);
+        }
+        closedir(dir);
+        std::sort(entries.begin(), entries.end());
+        bool ok = true;
+        for(const std::string& entry : entries) ok &= collect(path + "/" + entry, true, panels);
+        return ok;
+    }
+
+    size_t length = path.size();
+    if(fromDirectory && (length < 4 || path.compare(length - 4, 4, ".txt") != 0)) return true;
+
+    Panel panel;
+    panel.path = path;
+    size_t slash = path.rfind('/');
+    std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    if(base == "events.txt" && slash != std::string::npos && slash > 0) {
+        std::string dir = path.substr(0, slash);
+        size_t up = dir.rfind('/');
+        panel.name = up == std::string::npos ? dir : dir.substr(up + 1);
+    } else {
+        panel.name = path;
+    }
+    panel.text = nullptr;
+    panel.size = (size_t)st.st_size;
+    panel.firstChunk = 0;
+    panel.chunks = 0;
+    panels.push_back(panel);
+    return true;
+}
+
+// Maps a log read-only; the kernel reads ahead as the workers go
+static bool mapPanel(Panel& panel) {
+    if(panel.size == 0) return true;
+    int fd = open(panel.path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        fprintf(stderr, "loganalyze: %s: %s\n", panel.path.c_str(), strerror(errno));
+        return false;
+    }
+    void* map = mmap(nullptr, panel.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) {
+        fprintf(stderr, "loganalyze: %s: %s\n", panel.path.c_str(), strerror(errno));
+        return false;
+    }
+    madvise(map, panel.size, MADV_SEQUENTIAL);
+    panel.text = (const char*)map;
+    return true;
+}
+
+// Cuts a panel into chunks ending just after a newline
+static void splitPanel(Panel& panel, std::vector<Chunk>& chunks) {
+    panel.firstChunk = chunks.size();
+    const char* p = panel.text;
+    const char* end = panel.text + panel.size;
+    while(p < end) {
+        const char* cut = end;
+        if((size_t)(end - p) > CHUNK_BYTES) {
+            const char* nl = (const char*)memchr(p + CHUNK_BYTES, '\n', (size_t)(end - p - CHUNK_BYTES));
+            if(nl) cut = nl + 1;
+        }
+        chunks.push_back(Chunk{ p, cut });
+        p = cut;
+    }
+    panel.chunks = chunks.size() - panel.firstChunk;
+}
+
+// "2026-01-31", or "-" for none
+static void formatDate(uint32_t epoch, char* out, size_t size) {
+    if(epoch == 0) {
+        snprintf(out, size, "-");
+        return;
+    }
+    time_t t = (time_t)epoch;
+    struct tm fields;
+    strftime(out, size, "%Y-%m-%d", gmtime_r(&t, &fields));
+}
+
+// Arms with no command line before them were made at the keypad
+static uint32_t keypadCount(uint64_t total, const uint32_t* commands) {
+    uint64_t remote = (uint64_t)commands[SOURCE_SCHEDULE] + commands[SOURCE_REMOTE];
+    return total > remote ? (uint32_t)(total - remote) : 0;
+}
+
+static void printPanelHeader() {
+    printf("%-20s %10s %-10s %-10s %7s %6s %6s %20s %8s %7s %7s %7s %8s\n",
+           "panel", "lines", "from", "to", "alarms", "false", "arms", "arms k/s/c", "disarms",
+           "wrong", "lockout", "streaks", "longest");
+}
+
+static void printPanelRow(const char* name, const LogSummary& s, uint32_t streaks, uint32_t longest) {
+    char from[16];
+    char to[16];
+    char sources[24];
+    formatDate(s.firstEpoch, from, sizeof(from));
+    formatDate(s.lastEpoch, to, sizeof(to));
+    uint64_t arms = s.kinds[KIND_ARM_HOME] + s.kinds[KIND_ARM_AWAY];
+    snprintf(sources, sizeof(sources), "%u/%u/%u", keypadCount(arms, s.armCommands),
+             s.armCommands[SOURCE_SCHEDULE], s.armCommands[SOURCE_REMOTE]);
+    printf("%-20s %10llu %-10s %-10s %7llu %6u %6llu %20s %8llu %7llu %7llu %7u %8u\n",
+           name, (unsigned long long)s.lines, from, to, (unsigned long long)s.kinds[KIND_ALARM],
+           s.falseAlarms, (unsigned long long)arms, sources, (unsigned long long)s.kinds[KIND_DISARM],
+           (unsigned long long)s.kinds[KIND_WRONG_CODE], (unsigned long long)s.kinds[KIND_LOCKOUT],
+           streaks, longest);
+}
+
+// Hour-of-day table with a bar scaled to the busiest hour of the first column
+static void printHours(const LogSummary& fleet) {
+    uint32_t peak = 1;
+    for(int h = 0; h < 24; h++) {
+        if(fleet.alarmsByHour[h] > peak) peak = fleet.alarmsByHour[h];
+    }
+    printf("\n%-5s %8s %8s %8s\n", "hour", "alarms", "arms", "disarms");
+    for(int h = 0; h < 24; h++) {
+        char bar[41];
+        int width = (int)((uint64_t)fleet.alarmsByHour[h] * 40 / peak);
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("%02d    %8u %8u %8u  %s\n", h, fleet.alarmsByHour[h], fleet.armsByHour[h],
+               fleet.disarmsByHour[h], bar);
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t window = LogSummary::FALSE_ALARM_WINDOW_S;
+    int arg = 1;
+    while(arg + 1 < argc && argv[arg][0] == '-') {
+        if(strcmp(argv[arg], "-j") == 0) {
+            threads = (unsigned)atoi(argv[arg + 1]);
+        } else if(strcmp(argv[arg], "-w") == 0) {
+            window = (uint32_t)atoi(argv[arg + 1]);
+        } else {
+            break;
+        }
+        arg += 2;
+    }
+    if(arg >= argc || argv[arg][0] == '-') {
+        fprintf(stderr, "usage: loganalyze [-j threads] [-w seconds] <file or directory> [...]\n");
+        return 2;
+    }
+    if(threads == 0) threads = 1;
+
+    std::vector<Panel> panels;
+    bool ok = true;
+    for(; arg < argc; arg++) ok &= collect(argv[arg], false, panels);
+    if(panels.empty()) {
+        fprintf(stderr, "loganalyze: no logs found\n");
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    std::vector<Chunk> chunks;
+    for(Panel& panel : panels) {
+        if(mapPanel(panel)) {
+            splitPanel(panel, chunks);
+        } else {
+            ok = false;
+        }
+    }
+
+    // Workers write to their own slots, so no locking beyond the counter
+    std::vector<LogSummary> results(chunks.size());
+    std::atomic<size_t> nextChunk(0);
+    auto work = [&]() {
+        for(size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+            scanLog(chunks[i].begin, chunks[i].end, window, results[i]);
+        }
+    };
+    if(threads > chunks.size()) threads = chunks.empty() ? 1 : (unsigned)chunks.size();
+    std::vector<std::thread> workers;
+    for(unsigned t = 1; t < threads; t++) workers.emplace_back(work);
+    work();
+    for(std::thread& worker : workers) worker.join();
+
+    auto scanned = std::chrono::steady_clock::now();
+
+    LogSummary fleet;
+    fleet.clear();
+    uint64_t fleetStreaks = 0;
+    uint32_t fleetLongest = 0;
+    printPanelHeader();
+    for(Panel& panel : panels) {
+        LogSummary total;
+        total.clear();
+        for(size_t c = 0; c < panel.chunks; c++) total.append(results[panel.firstChunk + c], window);
+        uint32_t streaks = total.streak.totalRuns();
+        printPanelRow(panel.name.c_str(), total, streaks, total.streak.longest);
+        fleet.accumulate(total);
+        fleetStreaks += streaks;
+        if(total.streak.longest > fleetLongest) fleetLongest = total.streak.longest;
+        if(panel.text) munmap((void*)panel.text, panel.size);
+    }
+    if(panels.size() > 1) printPanelRow("fleet", fleet, (uint32_t)fleetStreaks, fleetLongest);
+
+    uint64_t disarms = fleet.kinds[KIND_DISARM];
+    printf("\n%zu panels, %llu lines, %llu malformed\n", panels.size(),
+           (unsigned long long)fleet.lines, (unsigned long long)fleet.malformed);
+    printf("alarm causes %llu, duress %llu, restarts %llu, door %llu, proximity %llu\n",
+           (unsigned long long)fleet.kinds[KIND_ALARM_CAUSE], (unsigned long long)fleet.kinds[KIND_DURESS],
+           (unsigned long long)fleet.kinds[KIND_RESTART], (unsigned long long)fleet.kinds[KIND_DOOR],
+           (unsigned long long)fleet.kinds[KIND_PROXIMITY]);
+    printf("arms home %llu, away %llu (exit delays %llu); disarms keypad %u, schedule %u, console %u\n",
+           (unsigned long long)fleet.kinds[KIND_ARM_HOME], (unsigned long long)fleet.kinds[KIND_ARM_AWAY],
+           (unsigned long long)fleet.kinds[KIND_EXIT_DELAY], keypadCount(disarms, fleet.disarmCommands),
+           fleet.disarmCommands[SOURCE_SCHEDULE], fleet.disarmCommands[SOURCE_REMOTE]);
+    printf("false-alarm candidates (disarmed within %us): %u of %llu alarms\n",
+           window, fleet.falseAlarms, (unsigned long long)fleet.kinds[KIND_ALARM]);
+    printHours(fleet);
+
+    double seconds = std::chrono::duration<double>(scanned - started).count();
+    fprintf(stderr, "%.1f MB in %.3f s, %.2f GB/s, %u threads, %zu chunks\n",
+            fleet.bytes / 1e6, seconds, seconds > 0 ? fleet.bytes / seconds / 1e9 : 0.0,
+            threads, chunks.size());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// mkassets - converts PNG screens into a media image for the uLCD's own card
+//
+//   mkassets [-o assets.img] [-H LcdAssetTable.h] [-s first-sector] logo.png alarm_banner.png ...
+//
+// Each PNG becomes one 4DGL raw image (16-bit colour) starting on a sector
+// boundary, in the order given. The image file is written to the display's
+// microSD card as a raw device, not as a file:
+//
+//   dd if=assets.img of=/dev/sdX bs=512 seek=<first-sector>
+//
+// The header lists each asset's sector and size for the firmware; asset
+// names come from the file names (alarm_banner.png -> ASSET_ALARM_BANNER).
+// Transparent pixels are composited over black, the screen background.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "PngImage.h"
+
+static const uint32_t SECTOR_SIZE = 512;        // Media sector bytes
+static const uint32_t MAX_SIZE = 128;           // Display width and height
+static const uint8_t COLOUR_MODE_16 = 0x10;     // Raw image header: 16-bit colour
+
+// One converted image
+struct Asset {
+    std::string file;               // Source PNG
+    std::string name;               // Enum suffix
+    uint32_t sector;                // First sector on the card
+    uint32_t sectors;               // Sectors used
+    uint16_t width, height;         // Pixels
+};
+
+// Reads a whole file
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+    uint8_t buffer[4096];
+    size_t got;
+    while((got = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + got);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+// Enum suffix from a path: base name without extension, upper case, [A-Z0-9_]
+static std::string assetName(const char* path) {
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    const char* dot = strrchr(base, '.');
+    size_t length = dot ? (size_t)(dot - base) : strlen(base);
+
+    std::string name;
+    for(size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)base[i];
+        name += isalnum(c) ? (char)toupper(c) : '_';
+    }
+    if(name.empty() || isdigit((unsigned char)name[0])) name.insert(0, "IMG_");
+    return name;
+}
+
+// Appends a 4DGL raw image: width and height big-endian, colour mode, then
+// RGB565 pixels big-endian row by row, padded to a whole sector
+static void appendRaw(const PngImage& image, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.push_back((uint8_t)(image.width >> 8));
+    out.push_back((uint8_t)image.width);
+    out.push_back((uint8_t)(image.height >> 8));
+    out.push_back((uint8_t)image.height);
+    out.push_back(COLOUR_MODE_16);
+    out.push_back(0);
+
+    const uint8_t* pixel = image.rgba.data();
+    for(size_t i = 0; i < (size_t)image.width * image.height; i++, pixel += 4) {
+        unsigned alpha = pixel[3];
+        unsigned r = (pixel[0] * alpha + 127) / 255;
+        unsigned g = (pixel[1] * alpha + 127) / 255;
+        unsigned b = (pixel[2] * alpha + 127) / 255;
+        uint16_t rgb565 = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+        out.push_back((uint8_t)(rgb565 >> 8));
+        out.push_back((uint8_t)rgb565);
+    }
+
+    size_t used = out.size() - start;
+    out.resize(start + (used + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE, 0);
+}
+
+// Writes the firmware's asset table
+static bool writeHeader(const char* path, const std::vector<Asset>& assets) {
+    FILE* file = fopen(path, "w");
+    if(!file) return false;
+
+    fprintf(file, "#pragma once    // Prevent multiple inclusions of this header file\n\n");
+    fprintf(file, "// Generated by tools/mkassets from");
+    for(const Asset& asset : assets) fprintf(file, " %s", asset.file.c_str());
+    fprintf(file, " - do not edit\n");
+    fprintf(file, "// Sectors are on the uLCD's own microSD card, written there with dd.\n\n");
+    fprintf(file, "// Include required libraries\n");
+    fprintf(file, "#include <cstdint>         // Standard integer types\n\n");
+
+    fprintf(file, "// Images on the display's card\n");
+    fprintf(file, "enum LcdAsset {\n");
+    for(const Asset& asset : assets) fprintf(file, "    ASSET_%s,\n", asset.name.c_str());
+    fprintf(file, "    ASSET_COUNT\n};\n\n");
+
+    fprintf(file, "// Where an image is and how large it is\n");
+    fprintf(file, "struct LcdAssetInfo {\n");
+    fprintf(file, "    uint32_t sector;        // First sector, holding the raw image header\n");
+    fprintf(file, "    uint16_t width;         // Pixels\n");
+    fprintf(file, "    uint16_t height;        // Pixels\n");
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "constexpr LcdAssetInfo LCD_ASSETS[ASSET_COUNT] = {\n");
+    for(const Asset& asset : assets) {
+        fprintf(file, "    { %lu, %u, %u },    // %s, %lu sectors\n", (unsigned long)asset.sector,
+                asset.width, asset.height, asset.file.c_str(), (unsigned long)asset.sectors);
+    }
+    fprintf(file, "};\n");
+
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+int main(int argc, char** argv) {
+    const char* imagePath = "assets.img";
+    const char* headerPath = "LcdAssetTable.h";
+    uint32_t firstSector = 0;
+    int arg = 1;
+    while(arg + 1 < argc && argv[arg][0] == '-') {
+        if(strcmp(argv[arg], "-o") == 0) {
+            imagePath = argv[arg + 1];
+        } else if(strcmp(argv[arg], "-H") == 0) {
+            headerPath = argv[arg + 1];
+        } else if(strcmp(argv[arg], "-s") == 0) {
+            firstSector = (uint32_t)strtoul(argv[arg + 1], nullptr, 0);
+        } else {
+            break;
+        }
+        arg += 2;
+    }
+    if(arg >= argc || argv[arg][0] == '-') {
+        fprintf(stderr, "usage: mkassets [-o assets.img] [-H LcdAssetTable.h] [-s first-sector] <image.png> [...]\n");
+        return 2;
+    }
+
+    std::vector<uint8_t> media;
+    std::vector<Asset> assets;
+    for(; arg < argc; arg++) {
+        const char* path = argv[arg];
+        std::vector<uint8_t> data;
+        if(!readFile(path, data)) {
+            fprintf(stderr, "mkassets: cannot read %s\n", path);
+            return 1;
+        }
+        PngImage image;
+        std::string error;
+        if(!decodePng(data.data(), data.size(), image, error)) {
+            fprintf(stderr, "mkassets: %s: %s\n", path, error.c_str());
+            return 1;
+        }
+        if(image.width > MAX_SIZE || image.height > MAX_SIZE) {
+            fprintf(stderr, "mkassets: %s: %lux%lu is larger than the %lux%lu display\n", path,
+                    (unsigned long)image.width, (unsigned long)image.height,
+                    (unsigned long)MAX_SIZE, (unsigned long)MAX_SIZE);
+            return 1;
+        }
+
+        Asset asset;
+        const char* base = strrchr(path, '/');
+        asset.file = base ? base + 1 : path;
+        asset.name = assetName(path);
+        for(const Asset& other : assets) {
+            if(other.name == asset.name) {
+                fprintf(stderr, "mkassets: %s: name ASSET_%s used twice\n", path, asset.name.c_str());
+                return 1;
+            }
+        }
+        asset.sector = firstSector + (uint32_t)(media.size() / SECTOR_SIZE);
+        asset.width = (uint16_t)image.width;
+        asset.height = (uint16_t)image.height;
+        appendRaw(image, media);
+        asset.sectors = firstSector + (uint32_t)(media.size() / SECTOR_SIZE) - asset.sector;
+        assets.push_back(asset);
+
+        printf("ASSET_%-16s %3ux%-3u sector %lu, %lu sectors\n", asset.name.c_str(), asset.width,
+               asset.height, (unsigned long)asset.sector, (unsigned long)asset.sectors);
+    }
+
+    FILE* file = fopen(imagePath, "wb");
+    if(!file || fwrite(media.data(), 1, media.size(), file) != media.size() || fclose(file) != 0) {
+        fprintf(stderr, "mkassets: cannot write %s\n", imagePath);
+        return 1;
+    }
+    if(!writeHeader(headerPath, assets)) {
+        fprintf(stderr, "mkassets: cannot write %s\n", headerPath);
+        return 1;
+    }
+    printf("%s: %lu sectors from sector %lu\n", imagePath,
+           (unsigned long)(media.size() / SECTOR_SIZE), (unsigned long)firstSector);
+    return 0;
+}
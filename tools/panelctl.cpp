@@ -0,0 +1,267 @@
+// panelctl - command-line client for the panel's serial console
+//
+//   panelctl <device> status
+//   panelctl <device> stats
+//   panelctl <device> arm-home <code>
+//   panelctl <device> arm-away <code>
+//   panelctl <device> disarm <code>
+//   panelctl <device> user <master-code> <slot> <perms> [code]
+//   panelctl <device> log [-z] [offset] > events.txt
+//   panelctl <device> log [-z] <from-epoch> <to-epoch> > range.txt
+//
+// -z asks for LZSS-compressed blocks. "log" with an offset appends to a
+// partial copy: panelctl dev log $(stat -c %s events.txt) >> events.txt
+//
+// "user" sets slot 0-249 to a new code with perms made of a (arm),
+// d (disarm), u (duress) and m (master), or removes it with perms "-".
+//
+// Exit status is 0 when the panel answered RESULT_OK.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include "ConsoleLink.h"
+#include "Lzss.h"           // Export block decoding
+
+static const int REPLY_TIMEOUT_MS = 2000;   // Panel loop plus a full transmit ring
+static const int RETRIES = 3;               // Resends of a request that got no reply
+
+static const char* const RESULT_NAMES[] = {
+    "ok", "bad code", "locked out", "refused", "bad request", "unknown command", "no SD card"
+};
+
+static const char* const STATE_NAMES[] = { "DISARMED", "ARMED_HOME", "ARMED_AWAY", "ALARM" };
+
+static const char* const MODE_NAMES[] = {
+    "disarmed", "armed home", "armed away", "entry delay", "exit delay", "alarm", "alarm code entry"
+};
+
+static const char* const STAT_NAMES[STAT_COUNT] = {
+    "uptime_s", "keys_dropped", "events_dropped", "bad_frames", "tx_dropped",
+    "clock_drift_ppb", "clock_error_ms"
+};
+
+// User permission letters, in UserPermission bit order (UserCodeStore.h)
+static const char PERM_LETTERS[] = "adum";
+
+// Permission letters to flags, -1 if invalid; "-" is 0 (remove)
+static int parsePerms(const char* text) {
+    if(strcmp(text, "-") == 0) return 0;
+    int perms = 0;
+    for(; *text; text++) {
+        const char* letter = strchr(PERM_LETTERS, *text);
+        if(!letter) return -1;
+        perms |= 1 << (letter - PERM_LETTERS);
+    }
+    return perms ? perms : -1;
+}
+
+// Name lookup that tolerates values from a newer firmware
+static const char* nameOf(const char* const* names, size_t count, unsigned value) {
+    return value < count ? names[value] : "?";
+}
+
+#define NAME(table, value) nameOf(table, sizeof(table) / sizeof(table[0]), value)
+
+// Sends a request and waits for its reply, resending on silence
+// Arm and disarm are sent once: a lost reply does not mean a lost command
+static bool transact(ConsoleLink& link, uint8_t command, const uint8_t* payload, uint8_t length,
+                     ConsoleFrame& reply) {
+    int attempts = (command == CMD_STATUS || command == CMD_STATS) ? RETRIES : 1;
+    for(int attempt = 0; attempt < attempts; attempt++) {
+        if(!link.send(command, payload, length)) return false;
+        while(link.receive(reply, REPLY_TIMEOUT_MS)) {
+            if(reply.command == (command | CONSOLE_RESPONSE) && reply.length >= 1) return true;
+        }
+    }
+    return false;
+}
+
+// Export request payload
+static void buildExport(uint8_t* request, uint8_t flags, uint32_t from, uint32_t to) {
+    request[0] = EXPORT_FILE_EVENTS;
+    request[1] = flags;
+    putU32(request + 2, from);
+    putU32(request + 6, to);
+}
+
+// Streams the log (or a time range of it) to stdout
+// Blocks are written only once complete and verified. If the panel goes
+// quiet, the export is asked for again as a byte range starting at the
+// first block not yet written, so nothing is fetched twice.
+static int exportLog(ConsoleLink& link, uint8_t flags, uint32_t from, uint32_t to) {
+    uint8_t request[EXPORT_REQUEST_LENGTH];
+    buildExport(request, flags, from, to);
+    if(!link.send(CMD_EXPORT, request, sizeof(request))) return 1;
+
+    bool started = false;
+    uint32_t first = 0;             // Start of the range
+    uint32_t offset = 0;            // Next block expected
+    uint32_t end = EXPORT_OPEN_END; // Resolved end of the range
+    uint8_t block[lzssMaxOutput(EXPORT_BLOCK) + EXPORT_CHUNK];  // Encoded parts so far
+    uint32_t blockLength = 0;
+    uint8_t raw[EXPORT_BLOCK];
+    uint32_t received = 0;          // Bytes on the wire, for the summary
+    int retries = 0;
+
+    ConsoleFrame reply;
+    while(true) {
+        if(!link.receive(reply, REPLY_TIMEOUT_MS)) {
+            if(++retries > RETRIES) {
+                fprintf(stderr, "panelctl: export stalled at byte %u\n", offset);
+                return 1;
+            }
+            // Resume - the time range is already resolved to bytes
+            if(started) buildExport(request, flags & EXPORT_LZSS, offset, end == EXPORT_OPEN_END ? 0 : end);
+            blockLength = 0;
+            if(!link.send(CMD_EXPORT, request, sizeof(request))) return 1;
+            continue;
+        }
+        if(reply.command != (CMD_EXPORT | CONSOLE_RESPONSE) || reply.length < 1) continue;
+        const uint8_t* p = reply.payload;
+        if(p[0] != RESULT_OK) {
+            fprintf(stderr, "panelctl: %s\n", NAME(RESULT_NAMES, p[0]));
+            return 1;
+        }
+        if(reply.length < EXPORT_HEADER) continue;
+        uint8_t kind = p[1];
+        uint32_t at = getU32(p + 2);
+        received += reply.length + CONSOLE_OVERHEAD;
+
+        if(kind & EXPORT_START) {
+            if(reply.length < EXPORT_HEADER + 4 || (started && at != offset)) continue;
+            if(!started) first = at;
+            started = true;
+            offset = at;
+            end = getU32(p + EXPORT_HEADER);
+            blockLength = 0;
+        } else if(kind & EXPORT_END) {
+            if(started && at == offset) break;
+        } else if((kind & EXPORT_DATA) && started && at == offset) {
+            uint32_t part = reply.length - EXPORT_HEADER;
+            if(blockLength + part > sizeof(block)) {
+                blockLength = 0;
+                continue;
+            }
+            memcpy(block + blockLength, p + EXPORT_HEADER, part);
+            blockLength += part;
+            if(!(kind & EXPORT_PART_LAST)) continue;
+
+            // Complete block - a missing part shows up as a length mismatch
+            uint16_t size = getU16(p + 6);
+            const uint8_t* data = block;
+            int length = (int)blockLength;
+            if(kind & EXPORT_PART_LZSS) {
+                length = lzssDecompress(block, (int)blockLength, raw, sizeof(raw));
+                data = raw;
+            }
+            blockLength = 0;
+            if(length != size) continue;    // Stays at this offset; the stall resumes it
+            fwrite(data, 1, size, stdout);
+            offset += size;
+        } else {
+            continue;
+        }
+        retries = 0;
+    }
+    fflush(stdout);
+    fprintf(stderr, "panelctl: bytes %u-%u exported, %u on the wire\n", first, offset, received);
+    return 0;
+}
+
+// Prints a decoded reply for the simple commands
+static void printReply(uint8_t command, const ConsoleFrame& reply) {
+    const uint8_t* p = reply.payload;
+    if(command == CMD_STATUS && reply.length >= STATUS_LENGTH) {
+        printf("state     %s\n", NAME(STATE_NAMES, p[1]));
+        printf("mode      %s\n", NAME(MODE_NAMES, p[2]));
+        printf("countdown %u s\n", p[3]);
+        printf("time      %u\n", getU32(p + 4));
+        printf("sd card   %s\n", (p[8] & STATUS_FLAG_SD) ? "mounted" : "missing");
+    } else if(command == CMD_STATS && reply.length >= 1 + 4 * STAT_COUNT) {
+        for(int i = 0; i < STAT_COUNT; i++) {
+            uint32_t value = getU32(p + 1 + 4 * i);
+            if(i == STAT_CLOCK_DRIFT_PPB) {
+                printf("%-16s %d\n", STAT_NAMES[i], (int32_t)value);
+            } else {
+                printf("%-16s %u\n", STAT_NAMES[i], value);
+            }
+        }
+    } else {
+        printf("%s\n", NAME(RESULT_NAMES, p[0]));
+    }
+}
+
+static int usage() {
+    fprintf(stderr, "usage: panelctl <device> status|stats|arm-home <code>|arm-away <code>|disarm <code>\n"
+                    "       panelctl <device> log [-z] [offset | <from-epoch> <to-epoch>]\n"
+                    "       panelctl <device> user <master-code> <slot> <adum | -> [code]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) return usage();
+
+    int fd = ConsoleLink::openDevice(argv[1]);
+    if(fd < 0) {
+        fprintf(stderr, "panelctl: %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    ConsoleLink link(fd);
+
+    const char* verb = argv[2];
+    if(strcmp(verb, "log") == 0) {
+        int arg = 3;
+        uint8_t flags = 0;
+        if(arg < argc && strcmp(argv[arg], "-z") == 0) {
+            flags |= EXPORT_LZSS;
+            arg++;
+        }
+        if(argc - arg > 2) return usage();
+        if(argc - arg == 2) flags |= EXPORT_BY_TIME;
+        uint32_t from = arg < argc ? (uint32_t)strtoul(argv[arg], nullptr, 0) : 0;
+        uint32_t to = arg + 1 < argc ? (uint32_t)strtoul(argv[arg + 1], nullptr, 0) : 0;
+        return exportLog(link, flags, from, to);
+    }
+
+    uint8_t command;
+    const uint8_t* payload = nullptr;
+    uint8_t length = 0;
+    uint8_t request[USER_REQUEST_LENGTH];
+    if(strcmp(verb, "user") == 0) {
+        if(argc < 6 || strlen(argv[3]) != CONSOLE_CODE_LENGTH) return usage();
+        int perms = parsePerms(argv[5]);
+        if(perms < 0 || (perms != 0) != (argc == 7)) return usage();
+        if(perms && strlen(argv[6]) != CONSOLE_CODE_LENGTH) return usage();
+        unsigned long slot = strtoul(argv[4], nullptr, 10);
+        if(slot > 255) return usage();
+        memset(request, 0, sizeof(request));
+        memcpy(request, argv[3], CONSOLE_CODE_LENGTH);
+        request[CONSOLE_CODE_LENGTH] = (uint8_t)slot;
+        request[CONSOLE_CODE_LENGTH + 1] = (uint8_t)perms;
+        if(perms) memcpy(request + CONSOLE_CODE_LENGTH + 2, argv[6], CONSOLE_CODE_LENGTH);
+        command = CMD_SET_USER;
+        payload = request;
+        length = sizeof(request);
+    } else if(strcmp(verb, "status") == 0) {
+        command = CMD_STATUS;
+    } else if(strcmp(verb, "stats") == 0) {
+        command = CMD_STATS;
+    } else {
+        command = strcmp(verb, "arm-home") == 0 ? CMD_ARM_HOME :
+                  strcmp(verb, "arm-away") == 0 ? CMD_ARM_AWAY :
+                  strcmp(verb, "disarm") == 0 ? CMD_DISARM : 0;
+        if(command == 0 || argc < 4 || strlen(argv[3]) != CONSOLE_CODE_LENGTH) return usage();
+        payload = (const uint8_t*)argv[3];
+        length = CONSOLE_CODE_LENGTH;
+    }
+
+    ConsoleFrame reply;
+    if(!transact(link, command, payload, length, reply)) {
+        fprintf(stderr, "panelctl: no reply\n");
+        return 1;
+    }
+    printReply(command, reply);
+    return reply.payload[0] == RESULT_OK ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+// panelsim - stands in for the panel on a pseudo-terminal
+//
+//   panelsim [-s blocks] [-t seconds] [events.txt]
+//
+// Prints the pty slave path, then answers console frames the way the
+// firmware does: code 1234 arms and disarms, an export streams the given
+// file. -s stops the first export after that many blocks, so the client
+// has to resume it. -t pushes telemetry at that period (CMD_TELEMETRY can
+// change it), with the door zone opening and closing now and then. Debug text is written between replies, as the real panel's
+// printf output is, so clients are exercised skipping it.
+//
+//   ./panelsim events.txt &
+//   ./panelctl /dev/pts/N status
+
+#define _XOPEN_SOURCE 600
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ConsoleLink.h"
+#include "Lzss.h"           // Export block encoding
+#include "TelemetryProtocol.h"  // Telemetry push encoding
+
+static const char SIM_CODE[] = "1234";     // The only valid code
+static const int MAX_FAILURES = 3;         // Wrong codes before the simulated lockout
+
+// Simulated panel state - only what the console reports
+struct SimPanel {
+    uint8_t state;          // SystemState numbering
+    uint8_t mode;           // PanelMode numbering
+    int failures;           // Wrong codes in a row
+    FILE* log;              // Event log to stream, nullptr = no SD card
+    int zones;              // TLM_ZONES bits
+    int period;             // Telemetry period in seconds, 0 = off
+    time_t started;         // For the uptime field
+    time_t nextPush;        // When the periodic frame is due
+    TelemetryEncoder telemetry;  // Push state
+};
+
+// Sends a telemetry frame if one is due or the state changed
+static void pushTelemetry(ConsoleLink& link, SimPanel& panel, bool periodic, uint32_t badFrames) {
+    if(!panel.period) return;
+    TelemetrySnapshot now = {};
+    now.epoch = (uint32_t)time(nullptr);
+    now.field[TLM_STATE] = panel.state;
+    now.field[TLM_MODE] = panel.mode;
+    now.field[TLM_ZONES] = panel.zones;
+    now.field[TLM_UPTIME_S] = (int32_t)(now.epoch - panel.started);
+    now.field[TLM_BAD_FRAMES] = (int32_t)badFrames;
+    now.field[TLM_CLOCK_DRIFT_PPB] = -37000 + rand() % 40;
+    now.field[TLM_CLOCK_ERROR_MS] = 1 + rand() % 3;
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    int length = panel.telemetry.encode(now, periodic, payload);
+    if(length) link.send(TELEMETRY_PUSH, payload, (uint8_t)length);
+}
+
+// Arm/disarm with the same outcomes the firmware reports
+static uint8_t remoteCommand(SimPanel& panel, uint8_t command, const ConsoleFrame& frame) {
+    if(frame.length != CONSOLE_CODE_LENGTH) return RESULT_BAD_REQUEST;
+    if(panel.failures >= MAX_FAILURES) return RESULT_LOCKED_OUT;
+    if(memcmp(frame.payload, SIM_CODE, CONSOLE_CODE_LENGTH) != 0) {
+        panel.failures++;
+        return RESULT_BAD_CODE;
+    }
+    panel.failures = 0;
+    if(command == CMD_DISARM) {
+        if(panel.state == 0) return RESULT_REFUSED;
+        panel.state = 0;
+        panel.mode = 0;
+    } else {
+        panel.state = command == CMD_ARM_HOME ? 1 : 2;
+        panel.mode = panel.state;
+    }
+    return RESULT_OK;
+}
+
+// Export reply with the firmware's header
+static void sendExport(ConsoleLink& link, uint8_t kind, uint32_t offset, uint16_t size,
+                       const uint8_t* data, uint8_t length) {
+    uint8_t reply[CONSOLE_MAX_PAYLOAD];
+    reply[0] = RESULT_OK;
+    reply[1] = kind;
+    putU32(reply + 2, offset);
+    putU16(reply + 6, size);
+    if(length) memcpy(reply + EXPORT_HEADER, data, length);
+    link.send(CMD_EXPORT | CONSOLE_RESPONSE, reply, (uint8_t)(EXPORT_HEADER + length));
+}
+
+// First line whose timestamp is at or after epoch - a linear scan, the
+// simulator's logs are small
+static uint32_t findLine(FILE* log, uint32_t epoch) {
+    char line[600];
+    fseek(log, 0, SEEK_SET);
+    long start = 0;
+    while(fgets(line, sizeof(line), log)) {
+        struct tm fields = {};
+        if(strptime(line, "%Y-%m-%d %H:%M:%S", &fields) && (uint32_t)timegm(&fields) >= epoch) break;
+        start = ftell(log);
+    }
+    return (uint32_t)start;
+}
+
+// Same blocks and frames as the firmware's LogExporter, sent in one go
+// A nonzero stopAfter ends the stream early, once, to exercise resume
+static void exportLog(ConsoleLink& link, SimPanel& panel, const ConsoleFrame& frame, int& stopAfter) {
+    uint8_t result = RESULT_OK;
+    const uint8_t* p = frame.payload;
+    if(frame.length != EXPORT_REQUEST_LENGTH || p[0] != EXPORT_FILE_EVENTS) result = RESULT_BAD_REQUEST;
+    else if(!panel.log) result = RESULT_NO_CARD;
+    if(result != RESULT_OK) {
+        link.send(CMD_EXPORT | CONSOLE_RESPONSE, &result, 1);
+        return;
+    }
+
+    uint8_t flags = p[1];
+    uint32_t from = getU32(p + 2);
+    uint32_t to = getU32(p + 6);
+    uint32_t start = from;
+    uint32_t end = to ? to : EXPORT_OPEN_END;
+    if(flags & EXPORT_BY_TIME) {
+        start = findLine(panel.log, from);
+        end = to ? findLine(panel.log, to + 1) : EXPORT_OPEN_END;
+    }
+    uint8_t endField[4];
+    putU32(endField, end);
+    sendExport(link, EXPORT_START, start, 0, endField, sizeof(endField));
+
+    LzssEncoder encoder;
+    uint8_t block[EXPORT_BLOCK];
+    uint8_t packed[lzssMaxOutput(EXPORT_BLOCK)];
+    uint32_t offset = start;
+    int blocks = 0;
+    while(end == EXPORT_OPEN_END || offset < end) {
+        uint32_t length = EXPORT_BLOCK - offset % EXPORT_BLOCK;
+        if(end != EXPORT_OPEN_END && end - offset < length) length = end - offset;
+        fseek(panel.log, offset, SEEK_SET);
+        int got = (int)fread(block, 1, length, panel.log);
+        if(got <= 0) break;
+        if(stopAfter && ++blocks > stopAfter) {
+            stopAfter = 0;
+            return;
+        }
+
+        const uint8_t* data = block;
+        int size = got;
+        uint8_t kind = EXPORT_DATA;
+        if(flags & EXPORT_LZSS) {
+            int n = encoder.compress(block, got, packed);
+            if(n < got) {
+                data = packed;
+                size = n;
+                kind |= EXPORT_PART_LZSS;
+            }
+        }
+        for(int sent = 0; sent < size; sent += EXPORT_CHUNK) {
+            int part = size - sent < EXPORT_CHUNK ? size - sent : EXPORT_CHUNK;
+            uint8_t partKind = kind | (sent + part == size ? EXPORT_PART_LAST : 0);
+            sendExport(link, partKind, offset, (uint16_t)got, data + sent, (uint8_t)part);
+        }
+        offset += got;
+    }
+    sendExport(link, EXPORT_END, offset, 0, nullptr, 0);
+}
+
+int main(int argc, char** argv) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if(fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || !ConsoleLink::makeRaw(fd)) {
+        perror("panelsim: pty");
+        return 1;
+    }
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+
+    SimPanel panel;
+    panel.state = 0;
+    panel.mode = 0;
+    panel.failures = 0;
+    panel.log = nullptr;
+    panel.zones = 0;
+    panel.period = 0;
+    panel.started = time(nullptr);
+    panel.nextPush = panel.started;
+
+    int arg = 1;
+    int stopAfter = 0;
+    while(arg + 1 < argc && argv[arg][0] == '-') {
+        if(strcmp(argv[arg], "-s") == 0) stopAfter = atoi(argv[arg + 1]);
+        if(strcmp(argv[arg], "-t") == 0) panel.period = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if(arg < argc) {
+        panel.log = fopen(argv[arg], "rb");
+        if(!panel.log) perror(argv[arg]);
+    }
+
+    ConsoleLink link(fd);
+    ConsoleFrame frame;
+    while(true) {
+        // Wake for the next telemetry frame; a zone may change meanwhile
+        time_t now = time(nullptr);
+        if(panel.period && now >= panel.nextPush) {
+            if(rand() % 3 == 0) panel.zones ^= 1 << 0;
+            pushTelemetry(link, panel, true, link.badFrames());
+            panel.nextPush = now + panel.period;
+        }
+        int timeoutMs = panel.period ? (int)(panel.nextPush - now) * 1000 : 60000;
+        if(!link.receive(frame, timeoutMs)) continue;
+        if(frame.command & CONSOLE_RESPONSE) continue;
+
+        // Debug text the real panel would interleave
+        const char text[] = "Idle 97.5%, wakes T10 S0 K0 R0 C1\n";
+        if(write(fd, text, sizeof(text) - 1) < 0) return 1;
+
+        uint8_t reply[CONSOLE_MAX_PAYLOAD];
+        uint8_t length = 1;
+        reply[0] = RESULT_OK;
+        switch(frame.command) {
+            case CMD_STATUS:
+                reply[1] = panel.state;
+                reply[2] = panel.mode;
+                reply[3] = 0;
+                putU32(reply + 4, (uint32_t)time(nullptr));
+                reply[8] = panel.log ? STATUS_FLAG_SD : 0;
+                length = STATUS_LENGTH;
+                break;
+
+            case CMD_ARM_HOME:
+            case CMD_ARM_AWAY:
+            case CMD_DISARM:
+                reply[0] = remoteCommand(panel, frame.command, frame);
+                break;
+
+            case CMD_EXPORT:
+                exportLog(link, panel, frame, stopAfter);
+                continue;
+
+            case CMD_STATS: {
+                uint8_t* p = reply + 1;
+                for(int i = 0; i < STAT_COUNT; i++) {
+                    p = putU32(p, i == STAT_BAD_FRAMES ? link.badFrames() : 0);
+                }
+                length = (uint8_t)(p - reply);
+                break;
+            }
+
+            case CMD_TELEMETRY:
+                if(frame.length == 2) {
+                    panel.period = getU16(frame.payload);
+                    panel.nextPush = time(nullptr) + panel.period;
+                } else if(frame.length != 0) {
+                    reply[0] = RESULT_BAD_REQUEST;
+                    break;
+                }
+                panel.telemetry.requestKeyframe();
+                break;
+
+            default:
+                reply[0] = RESULT_UNKNOWN_COMMAND;
+                break;
+        }
+        link.send(frame.command | CONSOLE_RESPONSE, reply, length);
+        pushTelemetry(link, panel, false, link.badFrames());
+    }
+}
@@ -0,0 +1,100 @@
+// protocol_test - host checks of the console frame format
+//
+//   ctest --test-dir build-tools
+//
+// Exit status is 0 when every check passed.
+
+#include <cstdio>
+#include <cstring>
+#include "ConsoleProtocol.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if(!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while(0)
+
+// Feeds bytes with a fresh, garbage-filled destination, as a caller that
+// declares its frame per pass does
+static bool feedFresh(FrameParser& parser, const uint8_t* bytes, int count, ConsoleFrame& out) {
+    for(int i = 0; i < count; i++) {
+        ConsoleFrame frame;
+        memset(&frame, 0xFF, sizeof(frame));
+        if(parser.feed(bytes[i], frame)) {
+            out = frame;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A frame split at every position still decodes, whatever the destination
+static void testSplitFrame() {
+    uint8_t payload[CONSOLE_MAX_PAYLOAD];
+    for(int i = 0; i < CONSOLE_MAX_PAYLOAD; i++) payload[i] = (uint8_t)(i * 7);
+    uint8_t wire[CONSOLE_MAX_PAYLOAD + CONSOLE_OVERHEAD];
+    int size = encodeFrame(CMD_STATUS | CONSOLE_RESPONSE, payload, CONSOLE_MAX_PAYLOAD, wire);
+
+    for(int split = 1; split < size; split++) {
+        FrameParser parser;
+        ConsoleFrame frame;
+        CHECK(!feedFresh(parser, wire, split, frame));
+        CHECK(feedFresh(parser, wire + split, size - split, frame));
+        CHECK(frame.command == (CMD_STATUS | CONSOLE_RESPONSE));
+        CHECK(frame.length == CONSOLE_MAX_PAYLOAD);
+        CHECK(memcmp(frame.payload, payload, CONSOLE_MAX_PAYLOAD) == 0);
+        CHECK(parser.badFrames() == 0);
+    }
+}
+
+// Debug text before a frame is skipped; an empty payload decodes
+static void testTextAndEmptyPayload() {
+    uint8_t wire[64];
+    int size = snprintf((char*)wire, sizeof(wire), "Boot: armable 12ms\n");
+    size += encodeFrame(CMD_STATS, nullptr, 0, wire + size);
+
+    FrameParser parser;
+    ConsoleFrame frame;
+    CHECK(feedFresh(parser, wire, size, frame));
+    CHECK(frame.command == CMD_STATS);
+    CHECK(frame.length == 0);
+}
+
+// A damaged frame is counted and leaves the destination alone; the next decodes
+static void testBadCrc() {
+    uint8_t code[CONSOLE_CODE_LENGTH] = { '1', '2', '3', '4' };
+    uint8_t wire[2 * (CONSOLE_CODE_LENGTH + CONSOLE_OVERHEAD)];
+    int size = encodeFrame(CMD_DISARM, code, sizeof(code), wire);
+    wire[4] ^= 0x01;
+    size += encodeFrame(CMD_ARM_HOME, code, sizeof(code), wire + size);
+
+    FrameParser parser;
+    ConsoleFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    int first = CONSOLE_CODE_LENGTH + CONSOLE_OVERHEAD;
+    for(int i = 0; i < first; i++) CHECK(!parser.feed(wire[i], frame));
+    CHECK(frame.command == 0 && frame.length == 0);
+    CHECK(parser.badFrames() == 1);
+
+    bool done = false;
+    for(int i = first; i < size; i++) done = parser.feed(wire[i], frame);
+    CHECK(done);
+    CHECK(frame.command == CMD_ARM_HOME);
+    CHECK(memcmp(frame.payload, code, sizeof(code)) == 0);
+}
+
+int main() {
+    testSplitFrame();
+    testTextAndEmptyPayload();
+    testBadCrc();
+    if(failures) {
+        fprintf(stderr, "protocol_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("protocol_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+// telemon - monitoring station console for panel telemetry
+//
+//   telemon [-p seconds] <device> [<device> ...]
+//
+// Listens to every panel given, asks each for a keyframe (and sets its push
+// period with -p), then prints one line per change: state, mode, zones and
+// countdown as they happen, health counters with each periodic frame.
+// Per-panel traffic is summarised when a panel disconnects or on exit.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include "TelemetryReceiver.h"
+
+static const char* const STATE_NAMES[] = { "DISARMED", "ARMED_HOME", "ARMED_AWAY", "ALARM" };
+
+static const char* const MODE_NAMES[] = {
+    "disarmed", "armed home", "armed away", "entry delay", "exit delay", "alarm", "alarm code entry"
+};
+
+static const char* const ZONE_NAMES[] = { "door", "outside", "inside", "window" };
+
+static const char* const FIELD_NAMES[TLM_FIELD_COUNT] = {
+    "state", "mode", "zones", "countdown", "uptime_s", "keys_dropped", "events_dropped",
+    "bad_frames", "tx_dropped", "drift_ppb", "error_ms"
+};
+
+static volatile sig_atomic_t stopping = 0;    // Set by Ctrl-C
+
+static void onSignal(int) {
+    stopping = 1;
+}
+
+// Name lookup that tolerates values from a newer firmware
+static const char* nameOf(const char* const* names, size_t count, int32_t value) {
+    return value >= 0 && (size_t)value < count ? names[value] : "?";
+}
+
+#define NAME(table, value) nameOf(table, sizeof(table) / sizeof(table[0]), value)
+
+// "door+window", or "-" when all zones are quiet
+static void zoneList(int32_t zones, char* out, size_t size) {
+    out[0] = '\0';
+    for(size_t z = 0; z < sizeof(ZONE_NAMES) / sizeof(ZONE_NAMES[0]); z++) {
+        if(!(zones & (1 << z))) continue;
+        if(out[0]) strncat(out, "+", size - strlen(out) - 1);
+        strncat(out, ZONE_NAMES[z], size - strlen(out) - 1);
+    }
+    if(!out[0]) snprintf(out, size, "-");
+}
+
+// One line per frame with the fields it changed
+static void printChange(const TelemetryReceiver& receiver, int panel, const TelemetrySnapshot& s, uint32_t changed) {
+    char stamp[32];
+    time_t t = (time_t)s.epoch;
+    struct tm fields;
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", gmtime_r(&t, &fields));
+    printf("%s %s", stamp, receiver.device(panel).c_str());
+    for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if(!(changed & (1u << i))) continue;
+        int32_t v = s.field[i];
+        if(i == TLM_STATE) {
+            printf(" state=%s", NAME(STATE_NAMES, v));
+        } else if(i == TLM_MODE) {
+            printf(" mode=\"%s\"", NAME(MODE_NAMES, v));
+        } else if(i == TLM_ZONES) {
+            char zones[48];
+            zoneList(v, zones, sizeof(zones));
+            printf(" zones=%s", zones);
+        } else {
+            printf(" %s=%d", FIELD_NAMES[i], v);
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+// Traffic per panel
+static void printSummary(const TelemetryReceiver& receiver, int panel, time_t since) {
+    TelemetryReceiver::PanelStats stats = receiver.stats(panel);
+    double seconds = difftime(time(nullptr), since);
+    fprintf(stderr, "%s: %u frames, %u bytes (%.1f B/s), %u lost, %u malformed\n",
+            receiver.device(panel).c_str(), stats.frames, stats.bytes,
+            seconds > 0 ? stats.bytes / seconds : 0.0, stats.lost, stats.malformed);
+}
+
+int main(int argc, char** argv) {
+    int arg = 1;
+    int period = -1;
+    if(arg + 1 < argc && strcmp(argv[arg], "-p") == 0) {
+        period = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if(arg >= argc) {
+        fprintf(stderr, "usage: telemon [-p seconds] <device> [<device> ...]\n");
+        return 2;
+    }
+
+    // The handler only runs from poll(), after construction
+    TelemetryReceiver receiver([&receiver](int panel, const TelemetrySnapshot& s, uint32_t changed) {
+        printChange(receiver, panel, s, changed);
+    });
+    for(; arg < argc; arg++) {
+        if(receiver.add(argv[arg]) < 0) {
+            fprintf(stderr, "telemon: %s: %s\n", argv[arg], strerror(errno));
+            return 1;
+        }
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    receiver.request(period);
+
+    time_t started = time(nullptr);
+    std::vector<bool> reported(receiver.count(), false);
+    while(!stopping) {
+        if(receiver.poll(1000) < 0) break;
+        for(int i = 0; i < receiver.count(); i++) {
+            if(!receiver.stats(i).open && !reported[i]) {
+                fprintf(stderr, "%s: disconnected\n", receiver.device(i).c_str());
+                printSummary(receiver, i, started);
+                reported[i] = true;
+            }
+        }
+    }
+    for(int i = 0; i < receiver.count(); i++) {
+        if(!reported[i]) printSummary(receiver, i, started);
+    }
+    return 0;
+}